@@ -5,6 +5,7 @@
 #include <qubus/IR/qir.hpp>
 
 #include <iterator>
+#include <memory>
 #include <string>
 
 void simple_expression_tree_setup()
@@ -104,6 +105,60 @@ void complex_expression_tree_compare_early_mismatch()
     *expr == *expr2;
 }
 
+std::unique_ptr<qubus::expression>
+build_complex_expression_tree(const qubus::variable_declaration& var1,
+                              const qubus::variable_declaration& var2,
+                              const qubus::variable_declaration& i,
+                              const qubus::variable_declaration& j,
+                              qubus::util::index_t inner_extent)
+{
+    using namespace qubus;
+
+    std::vector<std::unique_ptr<expression>> indices;
+    indices.push_back(var(i));
+    indices.push_back(var(j));
+
+    auto body =
+            subscription(var(var1), clone(indices)) + subscription(var(var2), clone(indices));
+
+    return for_(i, integer_literal(0), integer_literal(10),
+                for_(j, integer_literal(0), integer_literal(inner_extent), std::move(body)));
+}
+
+// Compilation passes compare the same trees over and over again. Once the structural hashes
+// of both trees are known, mismatches are detected without traversing the trees.
+void complex_expression_tree_repeated_compare_match(nonius::chronometer meter)
+{
+    using namespace qubus;
+
+    variable_declaration var1(types::array(types::double_{}, 2));
+    variable_declaration var2(types::array(types::double_{}, 2));
+
+    variable_declaration i(types::integer{});
+    variable_declaration j(types::integer{});
+
+    auto expr = build_complex_expression_tree(var1, var2, i, j, 10);
+    auto expr2 = build_complex_expression_tree(var1, var2, i, j, 10);
+
+    meter.measure([&] { return *expr == *expr2; });
+}
+
+void complex_expression_tree_repeated_compare_late_mismatch(nonius::chronometer meter)
+{
+    using namespace qubus;
+
+    variable_declaration var1(types::array(types::double_{}, 2));
+    variable_declaration var2(types::array(types::double_{}, 2));
+
+    variable_declaration i(types::integer{});
+    variable_declaration j(types::integer{});
+
+    auto expr = build_complex_expression_tree(var1, var2, i, j, 10);
+    auto expr2 = build_complex_expression_tree(var1, var2, i, j, 11);
+
+    meter.measure([&] { return *expr == *expr2; });
+}
+
 int main()
 {
     nonius::configuration cfg;
@@ -116,9 +171,14 @@ int main()
         nonius::benchmark("Simple expression tree compare (mismatch)",
                           simple_expression_tree_compare_mismatch),
         nonius::benchmark("Complex expression tree setup", complex_expression_tree_setup),
-        nonius::benchmark("Complex expression tree compare (match)", complex_expression_tree_setup),
+        nonius::benchmark("Complex expression tree compare (match)",
+                          complex_expression_tree_compare_match),
         nonius::benchmark("Complex expression tree compare (early mismatch)",
-                          complex_expression_tree_setup)};
+                          complex_expression_tree_compare_early_mismatch),
+        nonius::benchmark("Complex expression tree repeated compare (match)",
+                          complex_expression_tree_repeated_compare_match),
+        nonius::benchmark("Complex expression tree repeated compare (late mismatch)",
+                          complex_expression_tree_repeated_compare_late_mismatch)};
 
     nonius::go(cfg, std::begin(benchmarks), std::end(benchmarks), nonius::html_reporter());
 
@@ -0,0 +1,165 @@
+#include <hpx/config.hpp>
+
+#include <qubus/qubus.hpp>
+
+#include <qubus/IR/parsing.hpp>
+#include <qubus/index_narrowing.hpp>
+
+#include <hpx/hpx_init.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <random>
+
+// for tests
+#include <chrono>
+
+template <typename F, typename OnStop>
+double run_benchmark(F f, OnStop on_stop)
+{
+    long int min_samples = 10;
+
+    double min_time = 1.0;
+
+    double duration = 0.0;
+    long int samples = 0;
+
+    do
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        for (long int i = 0; i < min_samples; ++i)
+        {
+            f();
+        }
+
+        on_stop();
+
+        auto end = std::chrono::high_resolution_clock::now();
+
+        duration += std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        samples += min_samples;
+    } while (duration < min_time * 1000.0);
+
+    auto avg_time = duration / (1000.0 * static_cast<double>(samples));
+
+    return avg_time;
+}
+
+using namespace qubus;
+
+// A sparse matrix-vector product in the ELLPACK format. The inner loop is vectorized and gathers
+// the elements of x through the column indices.
+std::string make_spmv_code(const std::string& module_name)
+{
+    return "module " + module_name + R"(
+
+function spmv(val :: Array{Double, 1}, col :: Array{Int, 1}, x :: Array{Double, 1}) -> y :: Array{Double, 1}
+    let N :: Int = extent(y, 0)
+    let W :: Int = extent(col, 0) / N
+
+    for j :: Int in 0:W
+        unordered for i :: Int in 0:N
+            y[i] += val[j * N + i] * x[col[j * N + i]]
+        end
+    end
+end
+)";
+}
+
+void add_spmv_module(const std::string& module_name, bool narrow_indices)
+{
+    auto mod = parse_qir(make_spmv_code(module_name));
+
+    if (!narrow_indices)
+    {
+        mod->set_pragma(narrow_indices_pragma, "false");
+    }
+
+    get_runtime().get_module_library().add(std::move(mod)).get();
+}
+
+int hpx_main(int argc, char** argv)
+{
+    qubus::init(argc, argv);
+
+    constexpr util::index_t W = 16;
+
+    add_spmv_module("spmv_narrow", true);
+    add_spmv_module("spmv_wide", false);
+
+    auto runtime = get_runtime();
+
+    auto obj_factory = runtime.get_object_factory();
+
+    std::ofstream bench_data("gather_bench_data.dat");
+
+    std::mt19937_64 engine(42);
+
+    for (util::index_t N = 1 << 14; N <= 1 << 22; N *= 4)
+    {
+        std::uniform_int_distribution<util::index_t> column_dist(0, N - 1);
+
+        auto val = obj_factory.create_array(types::double_{}, {N * W});
+        auto col = obj_factory.create_array(types::integer{}, {N * W});
+        auto x = obj_factory.create_array(types::double_{}, {N});
+        auto y = obj_factory.create_array(types::double_{}, {N});
+
+        {
+            auto val_view = get_view<array<double, 1>>(val, writable, arch::host).get();
+            auto col_view = get_view<array<util::index_t, 1>>(col, writable, arch::host).get();
+
+            for (util::index_t i = 0; i < N * W; ++i)
+            {
+                val_view(i) = 1.0;
+                col_view(i) = column_dist(engine);
+            }
+
+            auto x_view = get_view<array<double, 1>>(x, writable, arch::host).get();
+            auto y_view = get_view<array<double, 1>>(y, writable, arch::host).get();
+
+            for (util::index_t i = 0; i < N; ++i)
+            {
+                x_view(i) = 1.0;
+                y_view(i) = 0.0;
+            }
+        }
+
+        kernel_arguments args;
+
+        args.push_back_arg(val);
+        args.push_back_arg(col);
+        args.push_back_arg(x);
+        args.push_back_result(y);
+
+        bench_data << N << "   ";
+        std::cout << "N = " << N;
+
+        for (const char* module_name : {"spmv_narrow", "spmv_wide"})
+        {
+            symbol_id kernel(std::string(module_name) + ".spmv");
+
+            // Trigger the compilation of the kernel outside of the measurement.
+            runtime.execute(kernel, args).get();
+
+            auto result = run_benchmark([&] { runtime.execute(kernel, args).get(); }, [] {});
+
+            bench_data << result << "   ";
+            std::cout << "   " << module_name << ": " << result << " s";
+        }
+
+        bench_data << std::endl;
+        std::cout << std::endl;
+    }
+
+    return hpx::finalize();
+}
+
+int main(int argc, char** argv)
+{
+    return hpx::init(argc, argv, qubus::get_hpx_config());
+}
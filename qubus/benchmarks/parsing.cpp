@@ -0,0 +1,108 @@
+#include <hpx/config.hpp>
+
+#include <nonius/nonius.h++>
+
+#include <qubus/IR/module.hpp>
+#include <qubus/IR/parsing.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <string>
+
+// Generates a module consisting of copies of a kernel with loops, branches, long operator
+// chains and nested parentheses until the code has at least the requested size.
+std::string generate_module(std::size_t size)
+{
+    std::string code = "module generated\n\n";
+
+    for (long int i = 0; code.size() < size; ++i)
+    {
+        auto id = std::to_string(i);
+
+        code += "function kernel_" + id +
+                "(A :: Array{Double, 2}, x :: Array{Double, 1}, alpha :: Double) -> y :: "
+                "Array{Double, 1}\n";
+        code += "    let N :: Int = extent(A, 0)\n\n";
+        code += "    for i :: Int in 0:N\n";
+        code += "        parallel for j :: Int in 0:2:N\n";
+        code += "            y[i] += alpha * (A[i, j] * x[j] - (x[i] + 1.0) / 2.0) + ((((x[j] - "
+                "x[i]) * 0.5) + 1.0) * alpha)\n";
+        code += "            if (x[j] < 0.0 and x[i] >= 1.0)\n";
+        code += "                y[i] = y[i] - x[j] - x[i] - 1.0 - alpha - " + id + ".0\n";
+        code += "            end\n";
+        code += "        end\n";
+        code += "    end\n";
+        code += "end\n\n";
+    }
+
+    return code;
+}
+
+// Deeply nested expressions used to take time exponential in the nesting depth.
+std::string generate_nested_expression(long int depth)
+{
+    std::string code = "module generated\n\nfunction calc(x :: Double) -> r :: Double\n    r = ";
+
+    for (long int i = 0; i < depth; ++i)
+    {
+        code += "(";
+    }
+
+    code += "x";
+
+    for (long int i = 0; i < depth; ++i)
+    {
+        code += " + 1.0)";
+    }
+
+    code += "\nend\n";
+
+    return code;
+}
+
+void parse_1mb_module(nonius::chronometer meter)
+{
+    static const std::string code = generate_module(1024 * 1024);
+
+    meter.measure([&] { return qubus::parse_qir(code); });
+}
+
+void parse_4mb_module(nonius::chronometer meter)
+{
+    static const std::string code = generate_module(4 * 1024 * 1024);
+
+    meter.measure([&] { return qubus::parse_qir(code); });
+}
+
+void parse_16mb_module(nonius::chronometer meter)
+{
+    static const std::string code = generate_module(16 * 1024 * 1024);
+
+    meter.measure([&] { return qubus::parse_qir(code); });
+}
+
+void parse_nested_expression(nonius::chronometer meter)
+{
+    static const std::string code = generate_nested_expression(1000);
+
+    meter.measure([&] { return qubus::parse_qir(code); });
+}
+
+int main()
+{
+    nonius::configuration cfg;
+    cfg.output_file = "parsing.html";
+
+    nonius::benchmark benchmarks[] = {
+        nonius::benchmark("Parse 1 MB module", parse_1mb_module),
+        nonius::benchmark("Parse 4 MB module", parse_4mb_module),
+        nonius::benchmark("Parse 16 MB module", parse_16mb_module),
+        nonius::benchmark("Parse nested expression (depth 1000)", parse_nested_expression)};
+
+    nonius::go(cfg, std::begin(benchmarks), std::end(benchmarks), nonius::html_reporter());
+
+    nonius::configuration cfg2;
+
+    nonius::go(cfg2, std::begin(benchmarks), std::end(benchmarks), nonius::standard_reporter());
+}
@@ -0,0 +1,132 @@
+#include <hpx/config.hpp>
+
+#include <nonius/nonius.h++>
+
+#include <qubus/IR/pretty_printer.hpp>
+#include <qubus/IR/qir.hpp>
+
+#include <qubus/qtl/IR/all.hpp>
+#include <qubus/qtl/lower_top_level_sums.hpp>
+#include <qubus/qtl/sparse_patterns.hpp>
+
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The rewrites construct a new matcher for every node they visit. Hence, these benchmarks are
+// dominated by the construction of the matchers and their dispatch tables.
+
+std::unique_ptr<qubus::expression> build_contraction(const qubus::variable_declaration& A,
+                                                     const qubus::variable_declaration& B,
+                                                     const qubus::variable_declaration& C)
+{
+    using namespace qubus;
+
+    variable_declaration i(types::index{});
+    variable_declaration j(types::index{});
+    variable_declaration k(types::index{});
+
+    std::vector<std::unique_ptr<expression>> lhs_indices;
+    lhs_indices.push_back(var(i));
+    lhs_indices.push_back(var(j));
+
+    std::vector<std::unique_ptr<expression>> A_indices;
+    A_indices.push_back(var(i));
+    A_indices.push_back(var(k));
+
+    std::vector<std::unique_ptr<expression>> B_indices;
+    B_indices.push_back(var(k));
+    B_indices.push_back(var(j));
+
+    return qtl::for_all(
+        std::vector<variable_declaration>{i, j},
+        assign(subscription(var(C), std::move(lhs_indices)),
+               qtl::sum(k, subscription(var(A), std::move(A_indices)) *
+                               subscription(var(B), std::move(B_indices)))));
+}
+
+std::unique_ptr<qubus::expression> build_loop_nest(const qubus::variable_declaration& A,
+                                                   const qubus::variable_declaration& B)
+{
+    using namespace qubus;
+
+    variable_declaration i(types::integer{});
+    variable_declaration j(types::integer{});
+
+    std::vector<std::unique_ptr<expression>> indices;
+    indices.push_back(var(i));
+    indices.push_back(var(j));
+
+    auto body = assign(subscription(var(A), clone(indices)),
+                       subscription(var(A), clone(indices)) * double_literal(2.0) +
+                           subscription(var(B), clone(indices)) - double_literal(1.0));
+
+    return for_(i, integer_literal(0), integer_literal(10),
+                for_(j, integer_literal(0), integer_literal(10), std::move(body)));
+}
+
+void lower_top_level_sums(nonius::chronometer meter)
+{
+    using namespace qubus;
+
+    variable_declaration A(types::array(types::double_{}, 2));
+    variable_declaration B(types::array(types::double_{}, 2));
+    variable_declaration C(types::array(types::double_{}, 2));
+
+    auto expr = build_contraction(A, B, C);
+
+    meter.measure([&] { return qtl::lower_top_level_sums(*expr); });
+}
+
+void optimize_sparse_patterns(nonius::chronometer meter)
+{
+    using namespace qubus;
+
+    variable_declaration A(types::array(types::double_{}, 2));
+    variable_declaration B(types::array(types::double_{}, 2));
+    variable_declaration C(types::array(types::double_{}, 2));
+
+    auto expr = build_contraction(A, B, C);
+
+    meter.measure([&] { return qtl::optimize_sparse_patterns(*expr); });
+}
+
+void pretty_print_loop_nest(nonius::chronometer meter)
+{
+    using namespace qubus;
+
+    variable_declaration A(types::array(types::double_{}, 2));
+    variable_declaration B(types::array(types::double_{}, 2));
+
+    auto expr = build_loop_nest(A, B);
+
+    meter.measure([&] {
+        auto block = pretty_print(*expr);
+
+        auto target = carrot::get_file_target();
+
+        carrot::plain_form form(target);
+
+        carrot::render(block, form);
+
+        return form.to_string();
+    });
+}
+
+int main()
+{
+    nonius::configuration cfg;
+    cfg.output_file = "pattern_matching.html";
+
+    nonius::benchmark benchmarks[] = {
+        nonius::benchmark("Lower top-level sums", lower_top_level_sums),
+        nonius::benchmark("Optimize sparse patterns", optimize_sparse_patterns),
+        nonius::benchmark("Pretty print loop nest", pretty_print_loop_nest)};
+
+    nonius::go(cfg, std::begin(benchmarks), std::end(benchmarks), nonius::html_reporter());
+
+    nonius::configuration cfg2;
+
+    nonius::go(cfg2, std::begin(benchmarks), std::end(benchmarks), nonius::standard_reporter());
+}
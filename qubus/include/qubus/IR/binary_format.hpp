@@ -0,0 +1,72 @@
+#ifndef QUBUS_IR_BINARY_FORMAT_HPP
+#define QUBUS_IR_BINARY_FORMAT_HPP
+
+#include <qubus/exception.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qubus
+{
+
+class binary_format_error : public virtual exception, public virtual std::runtime_error
+{
+public:
+    explicit binary_format_error(std::string reason_)
+    : std::runtime_error("Error while decoding binary QIR: " + std::move(reason_))
+    {
+    }
+};
+
+class binary_qir_io_error : public virtual exception, public virtual std::runtime_error
+{
+public:
+    explicit binary_qir_io_error(std::string reason_)
+    : std::runtime_error("Error while saving binary QIR: " + std::move(reason_))
+    {
+    }
+};
+
+class module;
+
+/** \brief The version of the binary QIR format which is written by encode_binary_qir.
+ *
+ * The version has to be incremented with every incompatible change of the encoding.
+ */
+constexpr std::uint32_t binary_qir_version = 1;
+
+/** \brief Encodes a module using the compact binary QIR format.
+ *
+ * The encoding consists of a header, a string table, a type table and a variable table
+ * followed by the functions of the module. The body of each function is stored as a flat
+ * array of nodes in post-order and all operands are encoded as variable-length integers.
+ *
+ * Annotations are not part of the encoding.
+ */
+std::vector<char> encode_binary_qir(const module& mod);
+
+/** \brief Decodes a module from a buffer containing binary QIR.
+ *
+ * The buffer is only read, which allows to decode modules directly from a memory-mapped file.
+ */
+std::unique_ptr<module> decode_binary_qir(const char* data, std::size_t size);
+
+std::unique_ptr<module> decode_binary_qir(const std::vector<char>& buffer);
+
+/** \brief Saves a module as a binary QIR file.
+ *
+ * Throws a binary_qir_io_error if the file could not be written completely.
+ */
+void save_binary_qir(const module& mod, const std::string& filename);
+
+/** \brief Loads a module from a binary QIR file by memory-mapping it.
+ */
+std::unique_ptr<module> load_binary_qir(const std::string& filename);
+}
+
+#endif
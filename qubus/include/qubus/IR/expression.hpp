@@ -5,13 +5,16 @@
 
 #include <qubus/IR/annotations.hpp>
 
+#include <qubus/util/assert.hpp>
 #include <qubus/util/multi_method.hpp>
 
-#include <boost/range/adaptor/transformed.hpp>
-#include <boost/range/any_range.hpp>
-#include <boost/range/irange.hpp>
-
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
 #include <type_traits>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
@@ -19,6 +22,7 @@ namespace qubus
 {
 
 class expression;
+class variable_declaration;
 
 class expression_cursor
 {
@@ -44,6 +48,99 @@ private:
 bool operator==(const expression_cursor& lhs, const expression_cursor& rhs);
 bool operator!=(const expression_cursor& lhs, const expression_cursor& rhs);
 
+class expression_child_iterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = expression;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const expression*;
+    using reference = const expression&;
+
+    expression_child_iterator() = default;
+
+    expression_child_iterator(const expression& parent_, std::size_t index_)
+    : parent_(&parent_), index_(index_)
+    {
+    }
+
+    friend bool operator==(const expression_child_iterator& lhs,
+                           const expression_child_iterator& rhs)
+    {
+        return lhs.parent_ == rhs.parent_ && lhs.index_ == rhs.index_;
+    }
+
+    friend bool operator!=(const expression_child_iterator& lhs,
+                           const expression_child_iterator& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    expression_child_iterator& operator++()
+    {
+        ++index_;
+
+        return *this;
+    }
+
+    expression_child_iterator operator++(int)
+    {
+        expression_child_iterator copy(*this);
+
+        ++*this;
+
+        return copy;
+    }
+
+    const expression& operator*() const;
+    const expression* operator->() const;
+
+private:
+    const expression* parent_ = nullptr;
+    std::size_t index_ = 0;
+};
+
+/** \brief The children of an expression.
+ *
+ * The range is a plain pair of indices into the parent expression. In contrast to a
+ * type-erased range, iterating over it does not involve any allocations or indirect
+ * calls besides the lookup of the child itself.
+ */
+class expression_child_range
+{
+public:
+    using iterator = expression_child_iterator;
+    using const_iterator = expression_child_iterator;
+
+    explicit expression_child_range(const expression& parent_);
+
+    iterator begin() const
+    {
+        return iterator(*parent_, 0);
+    }
+
+    iterator end() const
+    {
+        return iterator(*parent_, size_);
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    const expression& operator[](std::size_t index) const;
+
+private:
+    const expression* parent_;
+    std::size_t size_;
+};
+
 /** \brief Base class for all Qubus IR expression nodes.
  */
 class expression
@@ -71,12 +168,22 @@ public:
     virtual const expression& child(std::size_t index) const = 0;
     virtual std::size_t arity() const = 0;
 
-    virtual boost::any_range<const expression&, boost::forward_traversal_tag>
-    sub_expressions() const = 0;
+    expression_child_range sub_expressions() const
+    {
+        return expression_child_range(*this);
+    }
 
     virtual std::unique_ptr<expression>
     substitute_subexpressions(std::vector<std::unique_ptr<expression>> new_children) const = 0;
 
+    /** \brief Moves all children out of the expression.
+     *
+     * Afterwards, the expression may only be destroyed or passed to substitute_subexpressions.
+     * This allows unchanged children of an exclusively owned expression to be reused while
+     * rebuilding it.
+     */
+    virtual std::vector<std::unique_ptr<expression>> release_children() = 0;
+
     virtual expression* clone() const = 0;
 
     virtual annotation_map& annotations() const = 0;
@@ -86,21 +193,32 @@ public:
     {
         using value_type = typename std::decay<T>::type;
 
-        return dynamic_cast<const value_type&>(*this);
+        if (auto casted_ptr = try_as<value_type>())
+            return *casted_ptr;
+
+        throw std::bad_cast();
     }
 
+    /** \brief Casts the expression to a more derived type.
+     *
+     * Casts to concrete expression types only compare the type tags. Abstract base classes
+     * fall back to a dynamic_cast.
+     */
     template <typename T>
     const T* try_as() const
     {
         using value_type = typename std::decay<T>::type;
 
-        if (auto casted_ptr = dynamic_cast<const value_type*>(this))
+        if constexpr (std::is_final<value_type>::value)
         {
-            return casted_ptr;
+            if (type_tag() == value_type::static_type_tag())
+                return static_cast<const value_type*>(this);
+
+            return nullptr;
         }
         else
         {
-            return nullptr;
+            return dynamic_cast<const value_type*>(this);
         }
     }
 
@@ -116,13 +234,80 @@ public:
 
     virtual util::index_t type_tag() const = 0;
 
+    // Expressions are allocated from the active expression_arena, if there is one.
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr);
+
 protected:
     inline static util::implementation_table implementation_table_;
+
+private:
+    friend std::size_t structural_hash(const expression& expr);
+
+    // Lazily computed by structural_hash. Zero marks a hash which has not been computed yet.
+    mutable std::atomic<std::size_t> structural_hash_{0};
 };
 
+inline const expression& expression_child_iterator::operator*() const
+{
+    return parent_->child(index_);
+}
+
+inline const expression* expression_child_iterator::operator->() const
+{
+    return &parent_->child(index_);
+}
+
+inline expression_child_range::expression_child_range(const expression& parent_)
+: parent_(&parent_), size_(parent_.arity())
+{
+}
+
+inline const expression& expression_child_range::operator[](std::size_t index) const
+{
+    return parent_->child(index);
+}
+
 bool operator==(const expression& lhs, const expression& rhs);
 bool operator!=(const expression& lhs, const expression& rhs);
 
+/** \brief Computes a hash of the expression which is consistent with operator==.
+ *
+ * Structurally equal expressions have the same hash. Since expressions are immutable, the
+ * hash is only computed once per node and cached afterwards.
+ */
+std::size_t structural_hash(const expression& expr);
+
+/** \brief Computes a hash of the expression which does not depend on the identity of its
+ *         variables.
+ *
+ * Variables are numbered in the order of their first occurrence, starting with the free
+ * variables in the given order, and are represented by their number and type. Expressions
+ * which only differ in the choice of their variables therefore have the same hash. In
+ * contrast to structural_hash, all properties of the core IR nodes are taken into account
+ * and the hash does not depend on the order in which node types have been registered.
+ */
+std::size_t canonical_hash(const expression& expr,
+                           const std::vector<variable_declaration>& free_variables);
+
+/** \brief Lists the variables of an expression in the order in which canonical_hash numbers
+ *         them if no free variables are given.
+ *
+ * The variables of two alpha-equivalent expressions correspond to each other position by
+ * position.
+ */
+std::vector<variable_declaration> canonical_variables(const expression& expr);
+
+/** \brief Checks if two expressions only differ in the choice of their variables.
+ *
+ * The free variables of both expressions are matched by their position. All other variables
+ * need to correspond one-to-one. This is the equivalence relation underlying canonical_hash.
+ */
+bool alpha_equivalent(const expression& lhs,
+                      const std::vector<variable_declaration>& lhs_free_variables,
+                      const expression& rhs,
+                      const std::vector<variable_declaration>& rhs_free_variables);
+
 std::unique_ptr<expression> clone(const expression& expr);
 
 template <typename Expression, typename Enabled = typename std::enable_if<std::is_base_of<expression, Expression>::value>::type>
@@ -145,7 +330,16 @@ public:
 
     expression_base()
     {
-        tag_ = this->implementation_table_.template register_type<Expression>();
+        // Register the type as soon as the first instance is created.
+        static_type_tag();
+    }
+
+    static util::index_t static_type_tag()
+    {
+        static const util::index_t tag =
+            expression::implementation_table_.template register_type<Expression>();
+
+        return tag;
     }
 
     virtual ~expression_base() = default;
@@ -160,17 +354,9 @@ public:
         parent_ = &parent;
     }
 
-    boost::any_range<const expression&, boost::forward_traversal_tag>
-    sub_expressions() const override final
-    {
-        return boost::irange<std::size_t>(0, this->arity()) |
-               boost::adaptors::transformed(
-                   [this](std::size_t index) -> decltype(auto) { return this->child(index); });
-    }
-
     util::index_t type_tag() const override final
     {
-        return tag_;
+        return static_type_tag();
     }
 
     annotation_map& annotations() const override final
@@ -208,7 +394,6 @@ protected:
     }
 
 private:
-    util::index_t tag_;
     expression* parent_ = nullptr;
 
     mutable annotation_map annotations_;
@@ -220,6 +405,54 @@ std::unique_ptr<Expression> clone(const expression_base<Expression>& expr)
     return std::unique_ptr<Expression>(static_cast<const Expression&>(expr).clone());
 }
 
+namespace detail
+{
+template <typename Expression, typename ResultType, typename Visitor>
+ResultType visit_as(const expression& expr, Visitor& visitor)
+{
+    return visitor(static_cast<const Expression&>(expr));
+}
+}
+
+/** \brief Calls the visitor with the expression cast to its dynamic type.
+ *
+ * The candidate types are passed explicitly. The dispatch uses a table indexed by the type
+ * tag of the expression, without any RTTI. If the expression has none of the candidate
+ * types, the visitor is called with the expression itself.
+ */
+template <typename... Expressions, typename Visitor>
+decltype(auto) visit(const expression& expr, Visitor&& visitor)
+{
+    using result_type =
+        std::common_type_t<decltype(visitor(std::declval<const Expressions&>()))...,
+                           decltype(visitor(expr))>;
+
+    using handler_type = result_type (*)(const expression&, Visitor&);
+
+    static const std::vector<handler_type> handler_table = [] {
+        util::index_t tags[] = {Expressions::static_type_tag()...};
+        handler_type handlers[] = {&detail::visit_as<Expressions, result_type, Visitor>...};
+
+        auto max_tag = *std::max_element(std::begin(tags), std::end(tags));
+
+        std::vector<handler_type> handler_table(static_cast<std::size_t>(max_tag) + 1, nullptr);
+
+        for (std::size_t i = 0; i < sizeof...(Expressions); ++i)
+        {
+            handler_table[tags[i]] = handlers[i];
+        }
+
+        return handler_table;
+    }();
+
+    auto tag = static_cast<std::size_t>(expr.type_tag());
+
+    if (tag < handler_table.size() && handler_table[tag])
+        return handler_table[tag](expr, visitor);
+
+    return static_cast<result_type>(visitor(expr));
+}
+
 inline util::multi_method<bool(const util::virtual_<expression>&,
                                     const util::virtual_<expression>&)>
     equal;
@@ -0,0 +1,90 @@
+#ifndef QUBUS_EXPRESSION_ARENA_HPP
+#define QUBUS_EXPRESSION_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace qubus
+{
+
+/** \brief A bump allocator for the expressions created during one compilation session.
+ *
+ * While an arena is active in the current thread, all newly created expressions are
+ * allocated from it. Destroying an expression only runs its destructor, the memory of all
+ * expressions is released at once together with the arena. Expressions which should
+ * outlive the arena have to be cloned after the arena has been deactivated or while it is
+ * suspended. Destroying an arena while some of its expressions are still alive terminates
+ * the program.
+ *
+ * An arena is not thread-safe and is meant to be used by a single thread.
+ */
+class expression_arena
+{
+public:
+    static constexpr std::size_t default_block_size = 64 * 1024;
+
+    explicit expression_arena(std::size_t block_size_ = default_block_size);
+    ~expression_arena();
+
+    expression_arena(const expression_arena&) = delete;
+    expression_arena& operator=(const expression_arena&) = delete;
+
+    expression_arena(expression_arena&&) = delete;
+    expression_arena& operator=(expression_arena&&) = delete;
+
+    std::size_t number_of_live_expressions() const;
+
+private:
+    friend class expression;
+
+    void* allocate(std::size_t size);
+    void deallocate(void* ptr);
+
+    std::size_t block_size_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* next_ = nullptr;
+    char* end_ = nullptr;
+
+    std::size_t number_of_live_expressions_ = 0;
+};
+
+/** \brief Activates an arena for all expressions created in the current thread during the
+ *         lifetime of the scope.
+ *
+ * Scopes can be nested, the previously active arena is restored on destruction.
+ */
+class expression_arena_scope
+{
+public:
+    explicit expression_arena_scope(expression_arena& arena);
+    ~expression_arena_scope();
+
+    expression_arena_scope(const expression_arena_scope&) = delete;
+    expression_arena_scope& operator=(const expression_arena_scope&) = delete;
+
+private:
+    expression_arena* previous_arena_;
+};
+
+/** \brief Allocates all expressions created in the current thread during the lifetime of the
+ *         suspension from the heap, even if an arena is active.
+ *
+ * Stores which might outlive the active arena, like global caches, create their expressions
+ * within a suspension.
+ */
+class expression_arena_suspension
+{
+public:
+    expression_arena_suspension();
+    ~expression_arena_suspension();
+
+    expression_arena_suspension(const expression_arena_suspension&) = delete;
+    expression_arena_suspension& operator=(const expression_arena_suspension&) = delete;
+
+private:
+    expression_arena* suspended_arena_;
+};
+}
+
+#endif
@@ -14,6 +14,19 @@
 namespace qubus
 {
 
+/** \brief Name of the annotation marking loops whose iterations do not depend on each other.
+ *
+ * The value of the annotation is a bool.
+ */
+constexpr const char* independent_iterations_annotation = "qubus.independent_iterations";
+
+/** \brief Name of the annotation marking loops whose induction variable provably fits into
+ *         a 32-bit signed integer.
+ *
+ * The value of the annotation is a bool.
+ */
+constexpr const char* narrow_induction_variable_annotation = "qubus.narrow_induction_variable";
+
 class for_expr final : public expression_base<for_expr>
 {
 public:
@@ -48,6 +61,8 @@ public:
 
     std::size_t arity() const override final;
 
+    std::vector<std::unique_ptr<expression>> release_children() override final;
+
     std::unique_ptr<expression> substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const override final;
 
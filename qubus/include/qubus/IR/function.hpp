@@ -52,6 +52,12 @@ public:
 
     void substitute_body(std::unique_ptr<expression> body);
 
+    /** \brief Releases the ownership of the body.
+     *
+     * Afterwards, a new body has to be substituted before the function is used again.
+     */
+    std::unique_ptr<expression> release_body();
+
     annotation_map& annotations() const;
 
     annotation_map& annotations();
@@ -35,6 +35,8 @@ public:
 
     std::size_t arity() const override final;
 
+    std::vector<std::unique_ptr<expression>> release_children() override final;
+
     std::unique_ptr<expression> substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const override final;
 
@@ -28,6 +28,8 @@ public:
 
     std::size_t arity() const override;
 
+    std::vector<std::unique_ptr<expression>> release_children() override;
+
     std::unique_ptr<expression>
     substitute_subexpressions(std::vector<std::unique_ptr<expression>> new_children) const override;
 
@@ -15,8 +15,10 @@
 #include <boost/range/adaptor/indirected.hpp>
 #include <boost/range/adaptor/map.hpp>
 
+#include <qubus/util/optional_ref.hpp>
 #include <qubus/util/unused.hpp>
 
+#include <map>
 #include <memory>
 #include <ostream>
 #include <stdexcept>
@@ -129,6 +131,19 @@ public:
         }
     }
 
+    /** \brief Attaches a compiler directive to this module.
+     *
+     * Pragmas are preserved if the module is serialized and can be used to pass per-kernel
+     * options to the backend compilers.
+     */
+    void set_pragma(std::string name, std::string value);
+    util::optional_ref<const std::string> lookup_pragma(const std::string& name) const;
+
+    const std::map<std::string, std::string>& pragmas() const
+    {
+        return pragmas_;
+    }
+
     void dump(std::ostream& out) const;
 
     void save(hpx::serialization::output_archive& ar, unsigned version) const;
@@ -139,6 +154,7 @@ private:
     symbol_id id_;
     std::unordered_map<std::string, std::unique_ptr<function>> function_index_;
     std::unordered_map<std::string, types::struct_> type_index_;
+    std::map<std::string, std::string> pragmas_;
 
     module() = default;
 
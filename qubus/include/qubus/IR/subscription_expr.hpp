@@ -13,6 +13,13 @@
 namespace qubus
 {
 
+/** \brief Name of the annotation marking data-dependent indices into one-dimensional arrays
+ *         which may be narrowed to 32 bits if the extent of the array permits it.
+ *
+ * The value of the annotation is a bool.
+ */
+constexpr const char* narrow_index_annotation = "qubus.narrow_index";
+
 class subscription_expr final : public access_qualifier_base<subscription_expr>
 {
 public:
@@ -37,6 +44,8 @@ public:
 
     std::size_t arity() const override final;
 
+    std::vector<std::unique_ptr<expression>> release_children() override final;
+
     std::unique_ptr<expression> substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const override final;
 
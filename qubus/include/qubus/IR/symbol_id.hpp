@@ -6,6 +6,8 @@
 #include <qubus/util/hash.hpp>
 #include <qubus/util/unused.hpp>
 
+#include <hpx/include/serialization.hpp>
+
 #include <boost/range/adaptor/transformed.hpp>
 
 #include <functional>
@@ -26,37 +28,87 @@ public:
     }
 };
 
+namespace detail
+{
+struct symbol_id_entry
+{
+    std::vector<std::string> components;
+    std::string string;
+    std::size_t hash;
+    const symbol_id_entry* prefix;
+};
+}
+
+/** \brief A handle to an interned symbol id.
+ *
+ * Each distinct symbol id is stored exactly once per process together with its string form,
+ * its hash and its prefix. Comparing, hashing and taking the prefix of a symbol id therefore
+ * never allocates. Only the components are serialized and the id is interned again on the
+ * receiving locality.
+ */
 class symbol_id
 {
 public:
-    symbol_id() = default;
+    symbol_id();
     explicit symbol_id(const std::string& id);
 
     explicit symbol_id(std::vector<std::string> components_);
 
     auto components() const
     {
-        return components_ | boost::adaptors::transformed(
-                                 [](const std::string& value) { return std::string_view(value); });
+        return entry_->components |
+               boost::adaptors::transformed(
+                   [](const std::string& value) { return std::string_view(value); });
     }
 
     symbol_id get_prefix() const;
     const std::string& suffix() const;
 
-    std::string string() const;
+    const std::string& string() const
+    {
+        return entry_->string;
+    }
+
+    std::size_t hash() const
+    {
+        return entry_->hash;
+    }
+
+    friend bool operator==(const symbol_id& lhs, const symbol_id& rhs)
+    {
+        return lhs.entry_ == rhs.entry_;
+    }
+
+    friend bool operator!=(const symbol_id& lhs, const symbol_id& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename Archive>
+    void save(Archive& ar, unsigned QUBUS_UNUSED(version)) const
+    {
+        ar& entry_->components;
+    }
 
     template <typename Archive>
-    void serialize(Archive& ar, unsigned QUBUS_UNUSED(version))
+    void load(Archive& ar, unsigned QUBUS_UNUSED(version))
     {
-        ar& components_;
+        std::vector<std::string> components;
+
+        ar& components;
+
+        *this = symbol_id(std::move(components));
     }
 
+    HPX_SERIALIZATION_SPLIT_MEMBER();
+
 private:
-    std::vector<std::string> components_;
-};
+    explicit symbol_id(const detail::symbol_id_entry* entry_) : entry_(entry_)
+    {
+    }
 
-bool operator==(const symbol_id& lhs, const symbol_id& rhs);
-bool operator!=(const symbol_id& lhs, const symbol_id& rhs);
+    const detail::symbol_id_entry* entry_;
+};
 
 std::ostream& operator<<(std::ostream& out, const symbol_id& value);
 }
@@ -72,14 +124,7 @@ struct hash<qubus::symbol_id>
 
     result_type operator()(const argument_type& s) const noexcept
     {
-        std::size_t seed = 0;
-
-        for (const auto& component : s.components())
-        {
-            qubus::util::hash_combine(seed, component);
-        }
-
-        return seed;
+        return s.hash();
     }
 };
 }
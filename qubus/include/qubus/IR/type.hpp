@@ -42,6 +42,12 @@ public:
 };
 }
 
+/** \brief A handle to an interned type.
+ *
+ * All structurally equal types share a single canonical representation, which lives until
+ * the end of the program. Copying a type only copies the handle, equality is a pointer
+ * comparison and the hash of each type is computed once during interning.
+ */
 class type
 {
 public:
@@ -50,27 +56,12 @@ public:
     }
 
     template <typename T, typename Enabler = typename std::enable_if<is_type<T>::value>::type>
-    type(T value)
+    type(T value) : self_(intern_value(std::move(value)))
     {
-        auto tag = implementation_table_.register_type<T>();
-
-        self_ = std::make_unique<type_wrapper<T>>(value, tag);
-    }
-
-    type(const type& other) : self_(other.self_ ? other.self_->clone() : nullptr)
-    {
-    }
-
-    type& operator=(const type& other)
-    {
-        self_ = other.self_ ? other.self_->clone() : nullptr;
-
-        return *this;
+        // Register the type as soon as the first instance is created.
+        tag_of<T>();
     }
 
-    type(type&& other) = default;
-    type& operator=(type&& other) = default;
-
     bool is_primitive() const
     {
         return self_->is_primitive();
@@ -86,9 +77,9 @@ public:
     {
         using value_type = typename std::decay<T>::type;
 
-        if (self_->rtti() == typeid(value_type))
+        if (self_->tag() == tag_of<value_type>())
         {
-            return static_cast<type_wrapper<value_type>*>(self_.get())->get();
+            return static_cast<const type_wrapper<value_type>*>(self_)->get();
         }
         else
         {
@@ -101,9 +92,9 @@ public:
     {
         using value_type = typename std::decay<T>::type;
 
-        if (self_->rtti() == typeid(value_type))
+        if (self_->tag() == tag_of<value_type>())
         {
-            return &static_cast<type_wrapper<value_type>*>(self_.get())->get();
+            return &static_cast<const type_wrapper<value_type>*>(self_)->get();
         }
         else
         {
@@ -113,7 +104,12 @@ public:
 
     explicit operator bool() const
     {
-        return static_cast<bool>(self_);
+        return self_ != nullptr;
+    }
+
+    std::size_t hash() const
+    {
+        return self_->hash();
     }
 
     util::index_t type_tag() const
@@ -131,18 +127,59 @@ public:
         return implementation_table_.number_of_implementations();
     }
 
+    friend bool operator==(const type& lhs, const type& rhs)
+    {
+        return lhs.self_ == rhs.self_;
+    }
+
+    friend bool operator!=(const type& lhs, const type& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
     template <typename Archive>
-    void serialize(Archive& ar, unsigned QUBUS_UNUSED(version))
+    void save(Archive& ar, unsigned QUBUS_UNUSED(version)) const
+    {
+        std::unique_ptr<type_interface> self = self_->clone();
+
+        ar& self;
+    }
+
+    template <typename Archive>
+    void load(Archive& ar, unsigned QUBUS_UNUSED(version))
     {
-        ar& self_;
+        std::unique_ptr<type_interface> self;
+
+        ar& self;
+
+        self_ = intern(std::move(self));
     }
 
+    HPX_SERIALIZATION_SPLIT_MEMBER();
+
 private:
+    /** \brief Returns the tag of a type, registering the type on first use.
+     *
+     * Tags are assigned per process and are therefore never serialized.
+     */
+    template <typename T>
+    static util::index_t tag_of()
+    {
+        static const util::index_t tag = implementation_table_.register_type<T>();
+
+        return tag;
+    }
+
     class type_interface
     {
     public:
         virtual ~type_interface() = default;
 
+        std::size_t hash() const
+        {
+            return hash_;
+        }
+
         virtual bool is_primitive() const = 0;
 
         virtual std::type_index rtti() const = 0;
@@ -156,6 +193,11 @@ private:
         }
 
         HPX_SERIALIZATION_POLYMORPHIC_ABSTRACT(type_interface);
+
+    private:
+        friend class type;
+
+        std::size_t hash_ = 0;
     };
 
     template <typename T>
@@ -164,7 +206,7 @@ private:
     public:
         type_wrapper() = default;
 
-        explicit type_wrapper(T value_, util::index_t tag_) : value_(value_), tag_(tag_)
+        explicit type_wrapper(T value_) : value_(value_)
         {
         }
 
@@ -189,12 +231,12 @@ private:
 
         util::index_t tag() const override final
         {
-            return tag_;
+            return tag_of<T>();
         }
 
         std::unique_ptr<type_interface> clone() const override final
         {
-            return std::make_unique<type_wrapper<T>>(value_, tag_);
+            return std::make_unique<type_wrapper<T>>(value_);
         }
 
         template <typename Archive>
@@ -203,24 +245,45 @@ private:
             ar& hpx::serialization::base_object<type_interface>(*this);
 
             ar& value_;
-            ar& tag_;
         }
 
         HPX_SERIALIZATION_POLYMORPHIC_TEMPLATE(type_wrapper);
 
     private:
         T value_;
-        util::index_t tag_;
     };
 
-    std::unique_ptr<type_interface> self_;
+    explicit type(const type_interface* self_) : self_(self_)
+    {
+    }
+
+    /** \brief Returns the canonical representation of a type, adding the type to the
+     *         global type table if necessary.
+     */
+    static const type_interface* intern(std::unique_ptr<type_interface> candidate);
+
+    template <typename T>
+    static const type_interface* intern_value(T value)
+    {
+        if constexpr (std::is_empty<T>::value)
+        {
+            // All values of a stateless type are equal, so we only need to look it up once.
+            static const type_interface* const canonical_self =
+                intern(std::make_unique<type_wrapper<T>>(std::move(value)));
+
+            return canonical_self;
+        }
+        else
+        {
+            return intern(std::make_unique<type_wrapper<T>>(std::move(value)));
+        }
+    }
+
+    const type_interface* self_;
 
     inline static util::implementation_table implementation_table_;
 };
 
-bool operator==(const type& lhs, const type& rhs);
-bool operator!=(const type& lhs, const type& rhs);
-
 namespace types
 {
 
@@ -547,7 +610,10 @@ struct hash<qubus::type>
     using argument_type = qubus::type;
     using result_type = std::size_t;
 
-    std::size_t operator()(const qubus::type& value) const noexcept;
+    std::size_t operator()(const qubus::type& value) const noexcept
+    {
+        return value.hash();
+    }
 };
 
 template <>
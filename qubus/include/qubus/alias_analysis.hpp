@@ -58,6 +58,11 @@ public:
     basic_alias_analysis_result run(const expression& root, analysis_manager& manager,
                                     pass_resource_manager& resource_manager) const;
 
+    basic_alias_analysis_result relocate(const basic_alias_analysis_result& result,
+                                         const expression_relocation& relocation,
+                                         const expression& root, analysis_manager& manager,
+                                         pass_resource_manager& resource_manager) const;
+
     std::vector<analysis_id> required_analyses() const;
 };
 
@@ -85,6 +90,11 @@ public:
     alias_analysis_result run(const expression& root, analysis_manager& manager,
                               pass_resource_manager& resource_manager) const;
 
+    alias_analysis_result relocate(const alias_analysis_result& result,
+                                   const expression_relocation& relocation,
+                                   const expression& root, analysis_manager& manager,
+                                   pass_resource_manager& resource_manager) const;
+
     std::vector<analysis_id> required_analyses() const;
 };
 }
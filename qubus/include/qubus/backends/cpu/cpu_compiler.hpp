@@ -5,6 +5,9 @@
 
 #include <qubus/IR/module.hpp>
 #include <qubus/IR/symbol_id.hpp>
+#include <qubus/loop_optimizer.hpp>
+
+#include <qubus/util/integers.hpp>
 
 #include <functional>
 #include <memory>
@@ -15,6 +18,11 @@ namespace qubus
 
 class cpu_runtime;
 
+struct cpu_compilation_statistics
+{
+    std::vector<loop_optimization_report> loop_optimization_reports;
+};
+
 class cpu_plan
 {
 public:
@@ -26,6 +34,8 @@ public:
 
     virtual void execute(const symbol_id& entry_point, const std::vector<void*>& args,
                          cpu_runtime& runtime) const = 0;
+
+    virtual const cpu_compilation_statistics& statistics() const = 0;
 };
 
 class cpu_compiler_impl;
@@ -42,6 +52,12 @@ public:
 
     std::unique_ptr<cpu_plan> compile_computelet(std::unique_ptr<module> program);
 
+    /** \brief Compiles a computelet using the given tile sizes instead of the ones derived
+     *         from the cache model.
+     */
+    std::unique_ptr<cpu_plan> compile_computelet(std::unique_ptr<module> program,
+                                                 std::vector<util::index_t> tile_sizes);
+
 private:
     std::shared_ptr<cpu_compiler_impl> impl_;
 };
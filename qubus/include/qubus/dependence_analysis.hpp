@@ -0,0 +1,121 @@
+#ifndef QUBUS_DEPENDENCE_ANALYSIS_HPP
+#define QUBUS_DEPENDENCE_ANALYSIS_HPP
+
+#include <qubus/pass_manager.hpp>
+
+#include <qubus/IR/expression.hpp>
+#include <qubus/IR/for_expr.hpp>
+#include <qubus/IR/function.hpp>
+#include <qubus/IR/variable_declaration.hpp>
+
+#include <qubus/util/integers.hpp>
+#include <qubus/util/optional_ref.hpp>
+
+#include <boost/optional.hpp>
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace qubus
+{
+
+enum class dependence_kind
+{
+    flow,
+    anti,
+    output
+};
+
+/** \brief A dependence between two statements within a loop.
+ *
+ * The distance vector refers to the loops enclosing both statements, starting with the
+ * analyzed loop. Components which are not constant are unknown.
+ */
+struct dependence
+{
+    dependence(variable_declaration variable, const expression& source, const expression& target,
+               dependence_kind kind, bool is_carried, bool is_loop_independent,
+               std::vector<boost::optional<util::index_t>> distance);
+
+    variable_declaration variable;
+    std::reference_wrapper<const expression> source;
+    std::reference_wrapper<const expression> target;
+    dependence_kind kind;
+
+    /** \brief True if the dependence is carried by the analyzed loop.
+     */
+    bool is_carried;
+
+    /** \brief True if the dependence occurs within a single iteration of the analyzed loop.
+     */
+    bool is_loop_independent;
+
+    std::vector<boost::optional<util::index_t>> distance;
+};
+
+/** \brief The dependences between the statements of a loop.
+ *
+ * The dependences are a conservative approximation. Non-affine accesses are assumed to
+ * access any element of the accessed variable and non-affine loop bounds or conditions are
+ * ignored.
+ */
+class loop_dependences
+{
+public:
+    explicit loop_dependences(std::vector<dependence> dependences_);
+
+    const std::vector<dependence>& dependences() const;
+
+    /** \brief Checks if any dependence is carried by the loop, i.e. if its iterations
+     *         can not be executed in parallel.
+     */
+    bool carries_dependences() const;
+
+private:
+    std::vector<dependence> dependences_;
+};
+
+class dependence_analysis_result
+{
+public:
+    explicit dependence_analysis_result(
+        std::unordered_map<const expression*, loop_dependences> loop_table_);
+
+    util::optional_ref<const loop_dependences> get_dependences(const for_expr& loop) const;
+
+    /** \brief Checks if a loop carries dependences.
+     *
+     * Loops which have not been analyzed are conservatively assumed to carry dependences.
+     */
+    bool carries_dependences(const for_expr& loop) const;
+
+private:
+    friend class dependence_analysis_pass;
+
+    std::unordered_map<const expression*, loop_dependences> loop_table_;
+};
+
+class dependence_analysis_pass
+{
+public:
+    using result_type = dependence_analysis_result;
+
+    dependence_analysis_result run(const expression& root, analysis_manager& manager,
+                                   pass_resource_manager& resource_manager) const;
+
+    dependence_analysis_result relocate(const dependence_analysis_result& result,
+                                        const expression_relocation& relocation,
+                                        const expression& root, analysis_manager& manager,
+                                        pass_resource_manager& resource_manager) const;
+
+    std::vector<analysis_id> required_analyses() const;
+};
+
+/** \brief Annotates all loops of a function which carry no dependences with the
+ *         independent_iterations_annotation.
+ */
+void annotate_independent_loops(const function& func);
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef QUBUS_INDEX_NARROWING_HPP
+#define QUBUS_INDEX_NARROWING_HPP
+
+#include <qubus/IR/function.hpp>
+#include <qubus/IR/module.hpp>
+
+namespace qubus
+{
+
+/** \brief Name of the module pragma which controls the narrowing of indices to 32 bits.
+ *
+ * Narrowing is enabled by default. Modules carrying this pragma with the value "false" keep
+ * all indices and induction variables 64-bit wide.
+ */
+constexpr const char* narrow_indices_pragma = "qubus.narrow_indices";
+
+bool is_index_narrowing_requested(const module& mod);
+
+/** \brief Annotates the loops and array indices of a function which can be narrowed to 32 bits.
+ *
+ * Loops are marked with the narrow_induction_variable_annotation if the value range analysis
+ * proves that their bounds and increment keep the induction variable within the range of a
+ * 32-bit signed integer.
+ *
+ * Indices which are loaded from memory, like the column indices of a sparse matrix, are marked
+ * with the narrow_index_annotation if they index a one-dimensional array passed to the function.
+ * Since every valid index lies within the extent of the indexed array, the JIT narrows these
+ * indices in vectorized loops after checking the extent at runtime.
+ */
+void annotate_narrow_indices(const function& func);
+}
+
+#endif
@@ -65,7 +65,7 @@ public:
 
     ast_builder(const ast_builder& other) = delete;
 
-    explicit ast_builder(const context& ctx);
+    explicit ast_builder(context_ref ctx);
     explicit ast_builder(set params);
 
     ~ast_builder();
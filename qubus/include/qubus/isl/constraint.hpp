@@ -3,6 +3,7 @@
 
 #include <qubus/isl/local_space.hpp>
 #include <qubus/isl/affine_expr.hpp>
+#include <qubus/isl/value.hpp>
 
 #include <isl/constraint.h>
 
@@ -26,6 +27,8 @@ public:
 
     constraint& set_constant(int value);
 
+    constraint& set_constant(value val);
+
     constraint& set_coefficient(isl_dim_type type, int pos, int value);
 
     static constraint equality(local_space ls);
@@ -1,6 +1,8 @@
 #ifndef QUBUS_ISL_ID_HPP
 #define QUBUS_ISL_ID_HPP
 
+#include <qubus/isl/context.hpp>
+
 #include <isl/id.h>
 
 #include <boost/any.hpp>
@@ -12,14 +14,12 @@ namespace qubus
 namespace isl
 {
 
-class context;
-
 class id
 {
 public:
     explicit id(isl_id* handle_);
-    id(const context& ctx, const std::string& name);
-    id(const context& ctx, const std::string& name, boost::any user_data);
+    id(context_ref ctx, const std::string& name);
+    id(context_ref ctx, const std::string& name, boost::any user_data);
 
     id(const id& other);
 
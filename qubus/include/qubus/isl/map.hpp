@@ -150,6 +150,10 @@ map align_params(map m, space s);
 
 map reverse(map m);
 
+set deltas(map m);
+
+bool is_empty(const map& m);
+
 map coalesce(map m);
 map detect_equalities(map m);
 map remove_redundancies(map m);
@@ -42,6 +42,9 @@ pw_aff operator-(pw_aff lhs, pw_aff rhs);
 set set_from_pw_aff(pw_aff fn);
 map map_from_pw_aff(pw_aff fn);
 
+pw_aff dim_min(set s, int pos);
+pw_aff dim_max(set s, int pos);
+
 }
 }
 
@@ -1,6 +1,7 @@
 #ifndef QUBUS_ISL_SCHEDULE_NODE_HPP
 #define QUBUS_ISL_SCHEDULE_NODE_HPP
 
+#include <qubus/isl/context.hpp>
 #include <qubus/isl/set.hpp>
 #include <qubus/isl/id.hpp>
 #include <qubus/isl/multi_union_pw_affine_expr.hpp>
@@ -33,9 +34,14 @@ public:
     
     schedule_node parent() const;
 
+    context_ref get_ctx() const;
+
+    int get_schedule_depth() const;
+
     union_map band_get_partial_schedule_union_map() const;
     int band_n_member() const;
     bool band_is_permutable() const;
+    bool band_member_get_coincident(int pos) const;
     void band_member_set_coincident(int pos, bool is_coincident);
     void band_member_set_ast_loop_type(int pos, isl_ast_loop_type type);
     void band_member_set_isolate_ast_loop_type(int pos, isl_ast_loop_type type);
@@ -66,6 +72,7 @@ schedule_node insert_mark(schedule_node parent, id mark);
 schedule_node group(schedule_node node, id group_id);
 
 schedule_node tile_band(schedule_node node, std::vector<long int> sizes);
+schedule_node delete_node(schedule_node node);
 
 schedule_node graft_before(schedule_node node, schedule_node graft);
 schedule_node graft_after(schedule_node node, schedule_node graft);
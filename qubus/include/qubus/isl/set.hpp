@@ -3,6 +3,7 @@
 
 #include <qubus/isl/space.hpp>
 #include <qubus/isl/constraint.hpp>
+#include <qubus/isl/value.hpp>
 
 #include <isl/set.h>
 #include <isl/union_set.h>
@@ -134,6 +135,8 @@ bool is_strict_subset(const set& lhs, const set& rhs);
 
 bool is_empty(const set& s);
 
+value plain_get_val_if_fixed(const set& s, isl_dim_type type, unsigned int pos);
+
 set get_params(set s);
 
 set flat_product(set lhs, set rhs);
@@ -28,6 +28,14 @@ llvm::Value* load_array_shape_ptr(reference array, llvm_environment& env, compil
 
 reference extent(const expression& array_like, const expression& dim, compiler& comp);
 
+/** \brief Emits a check whether all given data-dependent indices can be narrowed to 32 bits.
+ *
+ * Each index has to be a valid index into a one-dimensional array passed to the current
+ * function. The check succeeds if the extents of all these arrays fit into 32 bits.
+ */
+llvm::Value* emit_index_narrowing_guard(
+    const std::vector<std::reference_wrapper<const expression>>& indices, compiler& comp);
+
 reference emit_subscription(const expression& array_like,
                             const std::vector<std::reference_wrapper<const expression>>& indices,
                             compiler& comp);
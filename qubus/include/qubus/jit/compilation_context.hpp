@@ -21,6 +21,8 @@
 
 #include <memory>
 #include <map>
+#include <set>
+#include <vector>
 
 namespace qubus
 {
@@ -99,6 +101,20 @@ public:
 
     void wait_on_pending_tasks() const;
 
+    util::optional_ref<const std::vector<llvm::Value*>>
+    lookup_hoisted_strides(llvm::Value* array) const;
+
+    void register_hoisted_strides(llvm::Value* array, std::vector<llvm::Value*> strides);
+
+    /** \brief Checks if a data-dependent index may be narrowed to 32 bits.
+     *
+     * Indices are only narrowed after the extent of the indexed array has been checked.
+     */
+    bool is_index_narrowing_permitted(const expression& index) const;
+
+    void permit_index_narrowing(const expression& index);
+    void revoke_index_narrowing(const expression& index);
+
 private:
     void answer_pending_global_alias_queries();
 
@@ -110,6 +126,10 @@ private:
     mutable std::vector<global_alias_info_query> pending_global_alias_queries_;
 
     std::vector<hpx::lcos::future<void>> pending_tasks_;
+
+    std::map<llvm::Value*, std::vector<llvm::Value*>> hoisted_strides_;
+
+    std::set<const expression*> narrowable_indices_;
 };
 }
 }
@@ -12,6 +12,18 @@ std::vector<std::string> deduce_host_cpu_features();
 std::vector<std::string> get_host_cpu_features();
 util::index_t get_prefered_alignment();
 
+/** \brief Returns the sizes of the host's data caches in bytes, starting with the innermost level.
+ */
+std::vector<util::index_t> get_host_data_cache_sizes();
+
+/** \brief Returns the size of the host's widest vector registers in bytes.
+ */
+util::index_t get_host_vector_register_size();
+
+/** \brief Returns the number of the host's vector registers.
+ */
+util::index_t get_host_number_of_vector_registers();
+
 }
 
 #endif
\ No newline at end of file
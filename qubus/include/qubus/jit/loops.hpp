@@ -15,9 +15,24 @@ namespace qubus
 {
 namespace jit
 {
+/** \brief Emits a counting loop.
+ *
+ * If vectorize is set, the loop carries a hint which requests its vectorization.
+ */
 void emit_loop(reference induction_variable, llvm::Value* lower_bound, llvm::Value* upper_bound,
                llvm::Value* increment, std::function<void()> body_emitter, llvm_environment& env,
-               compilation_context& ctx);
+               compilation_context& ctx, bool vectorize = false);
+
+/** \brief Emits a counting loop with a 32-bit loop counter.
+ *
+ * The bounds and the increment are truncated to 32 bits, so the caller has to ensure that
+ * all values of the counter are representable. At the start of each iteration, the
+ * sign-extended counter is stored into the induction variable.
+ */
+void emit_narrow_loop(reference induction_variable, llvm::Value* lower_bound,
+                      llvm::Value* upper_bound, llvm::Value* increment,
+                      std::function<void()> body_emitter, llvm_environment& env,
+                      compilation_context& ctx, bool vectorize = false);
 }
 }
 
@@ -1,14 +1,124 @@
 #ifndef QUBUS_LOOP_OPTIMIZER_HPP
 #define QUBUS_LOOP_OPTIMIZER_HPP
 
-#include <qubus/IR/function.hpp>
+#include <qubus/IR/module.hpp>
+#include <qubus/IR/symbol_id.hpp>
+
+#include <qubus/util/integers.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace qubus
 {
- 
-std::unique_ptr<function> optimize_loops(const function& expr);
-    
-}
 
+/** \brief Name of the module pragma which requests polyhedral loop optimization.
+ *
+ * Modules carrying this pragma with the value "true" are passed through optimize_loops
+ * by the backends supporting it.
+ */
+constexpr const char* optimize_loops_pragma = "qubus.optimize_loops";
+
+/** \brief Name of the module pragma which requests the empirical tuning of the tile sizes.
+ *
+ * The pragma is only honoured if loop optimization is requested, too.
+ */
+constexpr const char* autotune_loops_pragma = "qubus.autotune_loops";
+
+bool is_loop_optimization_requested(const module& mod);
+bool is_loop_autotuning_requested(const module& mod);
+
+/** \brief Parameters of the loop optimizer.
+ */
+struct loop_optimizer_options
+{
+    /** \brief Sizes of the data caches in bytes, starting with the innermost level.
+     *
+     * The tile sizes are derived from these sizes by a simple footprint model.
+     */
+    std::vector<util::index_t> cache_sizes;
+
+    /** \brief Explicit tile sizes, starting with the outermost tile level.
+     *
+     * If non-empty, these sizes are used instead of the ones derived from the cache model.
+     */
+    std::vector<util::index_t> tile_sizes;
+
+    /** \brief Maximal number of isl operations spent on the optimization of a single SCoP.
+     *
+     * A value of zero disables the limit.
+     */
+    unsigned long int max_isl_operations = 1000000;
+
+    /** \brief Size of a vector register in bytes.
+     *
+     * Together with the number of vector registers, this size determines the shape of the
+     * micro-kernels used for contractions. A value of zero denotes an unknown target.
+     */
+    util::index_t vector_register_size = 0;
+
+    /** \brief Number of vector registers of the target.
+     */
+    util::index_t number_of_vector_registers = 0;
+};
+
+/** \brief Returns the tile size configurations which are explored by the autotuner.
+ *
+ * The first candidate is always empty, i.e. it refers to the tile sizes of the cache model.
+ */
+std::vector<std::vector<util::index_t>> get_tile_size_candidates();
+
+/** \brief Fallback taken since the isl operation budget has been exceeded.
+ *
+ * The fallbacks are ordered by severity.
+ */
+enum class loop_optimization_fallback
+{
+    none,
+    reduced_effort,
+    original_code
+};
+
+/** \brief Outcome of the loop optimization of a single function.
+ *
+ * If a function contains several SCoPs, the report summarizes all of them.
+ */
+struct loop_optimization_report
+{
+    std::string function_name;
+    bool is_scop = false;
+    long int number_of_scops = 0;
+    long int number_of_independent_loops = 0;
+    bool has_been_optimized = false;
+    loop_optimization_fallback fallback = loop_optimization_fallback::none;
+    std::vector<util::index_t> tile_sizes;
+    std::vector<util::index_t> micro_kernel_shape;
+};
+
+/** \brief Applies polyhedral loop optimizations to all functions of a module.
+ *
+ * Maximal sequences of statements forming a static control part (SCoP) are optimized as a
+ * whole, which allows the scheduler to fuse loops across statements. Code outside of any SCoP
+ * or which can not be optimized is copied unaltered. For each function a report is appended
+ * to reports.
+ */
+std::unique_ptr<module> optimize_loops(const module& mod, const loop_optimizer_options& options,
+                                       std::vector<loop_optimization_report>& reports);
+
+/** \brief Records the loop optimization reports of a module compiled by a backend.
+ *
+ * Recording the reports of a module again replaces the previous ones.
+ */
+void record_loop_optimization_reports(const symbol_id& module_id,
+                                      std::vector<loop_optimization_report> reports);
+
+/** \brief Returns the loop optimization reports recorded for a module.
+ *
+ * The result is empty if the module has not been compiled with loop optimizations yet.
+ */
+std::vector<loop_optimization_report> get_loop_optimization_reports(const symbol_id& module_id);
+
+}
 
-#endif
\ No newline at end of file
+#endif
@@ -7,7 +7,9 @@
 
 #include <hpx/include/actions.hpp>
 #include <hpx/include/components.hpp>
+#include <hpx/include/local_lcos.hpp>
 
+#include <memory>
 #include <stdexcept>
 #include <unordered_map>
 
@@ -42,18 +44,44 @@ private:
     symbol_id module_id_;
 };
 
+/** \brief Signals that a module differs from an existing module with the same id.
+ */
+class conflicting_module_error : public virtual exception, public virtual std::runtime_error
+{
+public:
+    explicit conflicting_module_error(symbol_id module_id_);
+
+    const symbol_id& module_id() const
+    {
+        return module_id_;
+    }
+
+private:
+    symbol_id module_id_;
+};
+
 class module_library_server : public hpx::components::component_base<module_library_server>
 {
 public:
     void add(std::unique_ptr<module> m);
+    void add_if_absent(std::unique_ptr<module> m);
 
     std::unique_ptr<module> lookup(const symbol_id& id) const;
 
     HPX_DEFINE_COMPONENT_ACTION(module_library_server, add, add_action);
+    HPX_DEFINE_COMPONENT_ACTION(module_library_server, add_if_absent, add_if_absent_action);
     HPX_DEFINE_COMPONENT_ACTION(module_library_server, lookup, lookup_action);
 
 private:
-    std::unordered_map<symbol_id, std::unique_ptr<module>> module_index_;
+    /** \brief Adds the module unless its id is already taken.
+     *
+     * Returns the existing module with the same id, or a null pointer if the module has been
+     * added.
+     */
+    std::shared_ptr<const module> try_add(std::shared_ptr<const module> m);
+
+    std::unordered_map<symbol_id, std::shared_ptr<const module>> module_index_;
+    mutable hpx::lcos::local::mutex module_index_mutex_;
 };
 
 class module_library : public hpx::components::client_base<module_library, module_library_server>
@@ -67,7 +95,23 @@ public:
 
     [[nodiscard]] hpx::future<void> add(std::unique_ptr<module> m) const;
 
-    [[nodiscard]] hpx::future<std::unique_ptr<module>> lookup(const symbol_id& id) const;
+    /** \brief Adds a module unless a module with the same id is already part of the library.
+     *
+     * This is intended for content-addressed modules, whose id already determines their
+     * code. If the module is already known to this locality, no request is sent at all.
+     * Since the ids are derived from hashes, the code of an existing module is compared with
+     * the new one and a conflicting_module_error is raised if they are not alpha-equivalent.
+     */
+    [[nodiscard]] hpx::future<void> add_if_absent(std::unique_ptr<module> m) const;
+
+    /** \brief Looks up a module.
+     *
+     * Modules can not be changed after they have been added to the library. Therefore, each
+     * locality caches the most recently used modules of each library, which it has looked up
+     * before or which have been prefetched when they were added, and shares them between all
+     * callers.
+     */
+    [[nodiscard]] hpx::future<std::shared_ptr<const module>> lookup(const symbol_id& id) const;
 };
 }
 
@@ -4,6 +4,7 @@
 #include <qubus/IR/type.hpp>
 #include <qubus/abi_info.hpp>
 
+#include <qubus/util/detail/dispatch_table.hpp>
 #include <qubus/util/integers.hpp>
 #include <qubus/util/unused.hpp>
 
@@ -42,8 +43,8 @@ public:
     template <typename T>
     const T* try_as() const
     {
-        if (auto typed_self = dynamic_cast<const object_description_wrapper<T>*>(self_.get()))
-            return &typed_self->value();
+        if (self_ && self_->tag() == tag_of<T>())
+            return &static_cast<const object_description_wrapper<T>*>(self_.get())->value();
 
         return nullptr;
     }
@@ -55,6 +56,14 @@ public:
     }
 
 private:
+    template <typename T>
+    static util::index_t tag_of()
+    {
+        static const util::index_t tag = implementation_table_.register_type<T>();
+
+        return tag;
+    }
+
     class object_description_interface
     {
     public:
@@ -64,6 +73,8 @@ private:
         object_description_interface(const object_description_interface&) = delete;
         object_description_interface& operator=(const object_description_interface&) = delete;
 
+        virtual util::index_t tag() const = 0;
+
         template <typename Archive>
         void serialize(Archive& QUBUS_UNUSED(ar), unsigned QUBUS_UNUSED(version))
         {
@@ -87,6 +98,11 @@ private:
             return value_;
         }
 
+        util::index_t tag() const override final
+        {
+            return tag_of<T>();
+        }
+
         template <typename Archive>
         void serialize(Archive& ar, unsigned QUBUS_UNUSED(version))
         {
@@ -102,6 +118,8 @@ private:
     };
 
     std::shared_ptr<object_description_interface> self_;
+
+    inline static util::implementation_table implementation_table_;
 };
 
 class array_description : public object_description_base<array_description>
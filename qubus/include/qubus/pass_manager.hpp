@@ -9,16 +9,20 @@
 #include <boost/any.hpp>
 
 #include <qubus/util/assert.hpp>
+#include <qubus/util/handle.hpp>
 #include <qubus/util/optional_ref.hpp>
+#include <qubus/util/unreachable.hpp>
 
 #include <algorithm>
 #include <functional>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <type_traits>
 #include <typeinfo>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace qubus
@@ -41,7 +45,40 @@ analysis_id get_analysis_id()
     return typeid(AnalysisPass);
 }
 
-using preserved_analyses_info = std::vector<analysis_id>;
+/** \brief Describes which analysis results remain valid after a transformation.
+ *
+ * By default, no analysis is preserved and the whole function is considered to be modified.
+ * Transformations which only rewrite parts of a function can list the roots of the rewritten
+ * subtrees (as found in the transformed function). In this case, only the results computed for
+ * these subtrees, for their descendants or for their ancestors are invalidated. The results of
+ * all other subtrees are reused.
+ */
+class preserved_analyses_info
+{
+public:
+    preserved_analyses_info() = default;
+
+    static preserved_analyses_info all();
+
+    template <typename AnalysisPass>
+    void preserve()
+    {
+        preserve(get_analysis_id<AnalysisPass>());
+    }
+
+    void preserve(analysis_id id);
+
+    bool is_preserved(const analysis_id& id) const;
+
+    void mark_modified(const expression& subtree);
+
+    const std::vector<const expression*>& modified_subtrees() const;
+
+private:
+    bool preserves_all_ = false;
+    std::vector<analysis_id> preserved_analyses_;
+    std::vector<const expression*> modified_subtrees_;
+};
 
 class analysis_manager;
 
@@ -135,6 +172,62 @@ private:
     std::unique_ptr<analysis_result_interface> self_;
 };
 
+/** \brief Maps the nodes and variables of an expression onto an alpha-equivalent expression.
+ *
+ * Nodes are mapped by their position within the tree and variables by their position in the
+ * canonical numbering of both expressions. Variables which do not occur in the source
+ * expression are mapped onto themselves.
+ */
+class expression_relocation
+{
+public:
+    expression_relocation(const expression& source_, const expression& target_);
+
+    const expression& map(const expression& node) const;
+
+    template <typename Expression,
+              typename Enabled = typename std::enable_if<
+                  std::is_base_of<expression, Expression>::value>::type>
+    const Expression& map(const Expression& node) const
+    {
+        return map(static_cast<const expression&>(node)).template as<Expression>();
+    }
+
+    variable_declaration map(const variable_declaration& var) const;
+
+private:
+    std::unordered_map<const expression*, const expression*> node_table_;
+    std::unordered_map<util::handle, variable_declaration> variable_table_;
+};
+
+/** \brief Checks if the results of an analysis pass can be transferred between
+ *         alpha-equivalent expressions.
+ *
+ * Analysis passes opt in by providing a member function
+ *
+ *     result_type relocate(const result_type& result, const expression_relocation& relocation,
+ *                          const expression& root, analysis_manager& manager,
+ *                          pass_resource_manager& resource_manager) const;
+ *
+ * which rebuilds a result computed for an alpha-equivalent expression for root. References
+ * to the results of other analyses must be requested from manager again.
+ */
+template <typename AnalysisPass, typename Enabled = void>
+struct is_relocatable_analysis : std::false_type
+{
+};
+
+template <typename AnalysisPass>
+struct is_relocatable_analysis<
+    AnalysisPass,
+    std::void_t<decltype(std::declval<const AnalysisPass&>().relocate(
+        std::declval<const typename AnalysisPass::result_type&>(),
+        std::declval<const expression_relocation&>(), std::declval<const expression&>(),
+        std::declval<analysis_manager&>(), std::declval<pass_resource_manager&>()))>>
+    : std::true_type
+{
+};
+
 class analysis_pass
 {
 public:
@@ -160,6 +253,19 @@ public:
         return self_->required_analyses();
     }
 
+    bool is_relocatable() const
+    {
+        return self_->is_relocatable();
+    }
+
+    analysis_result relocate(const analysis_result& result,
+                             const expression_relocation& relocation, const expression& root,
+                             analysis_manager& manager,
+                             pass_resource_manager& resource_manager_) const
+    {
+        return self_->relocate(result, relocation, root, manager, resource_manager_);
+    }
+
 private:
     class analysis_pass_interface
     {
@@ -179,6 +285,13 @@ private:
         virtual std::vector<analysis_id> required_analyses() const = 0;
 
         virtual analysis_id id() const = 0;
+
+        virtual bool is_relocatable() const = 0;
+
+        virtual analysis_result relocate(const analysis_result& result,
+                                         const expression_relocation& relocation,
+                                         const expression& root, analysis_manager& manager,
+                                         pass_resource_manager& resource_manager_) const = 0;
     };
 
     template <typename AnalysisPass>
@@ -207,6 +320,28 @@ private:
             return typeid(AnalysisPass);
         }
 
+        bool is_relocatable() const override
+        {
+            return is_relocatable_analysis<AnalysisPass>::value;
+        }
+
+        analysis_result relocate(const analysis_result& result,
+                                 const expression_relocation& relocation, const expression& root,
+                                 analysis_manager& manager,
+                                 pass_resource_manager& resource_manager_) const override
+        {
+            if constexpr (is_relocatable_analysis<AnalysisPass>::value)
+            {
+                return analysis_.relocate(
+                    result.as<typename analysis_traits<AnalysisPass>::result_type>(), relocation,
+                    root, manager, resource_manager_);
+            }
+            else
+            {
+                QUBUS_UNREACHABLE_BECAUSE("The analysis does not support relocation.");
+            }
+        }
+
     private:
         AnalysisPass analysis_;
     };
@@ -214,6 +349,74 @@ private:
     std::unique_ptr<analysis_pass_interface> self_;
 };
 
+/** \brief Process-wide cache of relocatable analysis results.
+ *
+ * The results are keyed by the canonical hash of the analyzed expression, such that
+ * expressions which only differ in the choice of their variables, like the bodies of two
+ * separately built kernels, share their results. Each entry retains a copy of the analyzed
+ * expression together with the result relocated onto this copy. Hash collisions are detected
+ * by checking the copy for alpha-equivalence. If the cache is full, the least recently used
+ * entry is evicted.
+ */
+class analysis_cache
+{
+public:
+    class entry
+    {
+    public:
+        entry(std::size_t hash_, const analysis_pass& pass_, const expression& expr_,
+              const analysis_result& result_);
+
+        ~entry();
+
+        entry(const entry&) = delete;
+        entry& operator=(const entry&) = delete;
+
+        std::size_t hash() const;
+        const analysis_id& id() const;
+
+        const expression& expr() const;
+        const analysis_result& result() const;
+
+    private:
+        std::size_t hash_;
+        analysis_id id_;
+        std::unique_ptr<expression> expr_;
+        pass_resource_manager resource_manager_;
+        std::unique_ptr<analysis_manager> manager_;
+        analysis_result result_;
+    };
+
+    std::shared_ptr<const entry> lookup(const analysis_id& id, const expression& expr) const;
+
+    void insert(const analysis_pass& pass, const expression& expr,
+                const analysis_result& result);
+
+    /** \brief Variants of lookup and insert which use a precomputed hash of the expression.
+     */
+    std::shared_ptr<const entry> lookup(const analysis_id& id, const expression& expr,
+                                        std::size_t hash) const;
+
+    void insert(const analysis_pass& pass, const expression& expr, std::size_t hash,
+                const analysis_result& result);
+
+    std::size_t size() const;
+
+    void clear();
+
+    static constexpr std::size_t max_number_of_entries = 1024;
+
+    static analysis_cache& get_instance();
+
+private:
+    using entry_list = std::list<std::shared_ptr<const entry>>;
+
+    mutable std::mutex entries_mutex_;
+    // The entries are ordered from the most to the least recently used one.
+    mutable entry_list entries_;
+    std::unordered_multimap<std::size_t, entry_list::iterator> index_;
+};
+
 class analysis_pass_registry
 {
 public:
@@ -262,10 +465,12 @@ public:
     util::optional_ref<const typename analysis_traits<Analysis>::result_type>
     get_analysis_cached(const expression& expr) const
     {
-        if (!cached_result_.empty())
+        auto search_result = cached_results_.find(&expr);
+
+        if (search_result != cached_results_.end())
         {
             const auto& typed_result =
-                cached_result_.as<typename analysis_traits<Analysis>::result_type>();
+                search_result->second->as<typename analysis_traits<Analysis>::result_type>();
 
             return typed_result;
         }
@@ -278,22 +483,38 @@ public:
     template <typename Analysis>
     const typename analysis_traits<Analysis>::result_type& get_analysis(const expression& expr)
     {
-        if (cached_result_.empty())
+        auto& cached_result = cached_results_[&expr];
+
+        if (!cached_result)
         {
-            cached_result_ = pass_.run(expr, manager_, *resource_manager_);
+            cached_result = run_pass(expr);
         }
 
         const auto& typed_result =
-            cached_result_.as<typename analysis_traits<Analysis>::result_type>();
+            cached_result->as<typename analysis_traits<Analysis>::result_type>();
 
         return typed_result;
     }
 
+    /** \brief Invalidates all results of this analysis and of all dependent analyses.
+     */
     void invalidate();
 
+    /** \brief Invalidates the results computed for the given roots, including the ones of all
+     *         dependent analyses.
+     */
+    void invalidate(const std::unordered_set<const expression*>& roots);
+
+    /** \brief Discards the results whose roots are not contained in live_nodes.
+     */
+    void discard_dead_results(const std::unordered_set<const expression*>& live_nodes);
+
 private:
+    std::shared_ptr<const analysis_result> run_pass(const expression& expr);
+
     analysis_pass pass_;
-    analysis_result cached_result_;
+    std::unordered_map<const expression*, std::shared_ptr<const analysis_result>>
+        cached_results_;
 
     std::vector<analysis_node*> dependents_;
 
@@ -304,7 +525,15 @@ private:
 class analysis_manager
 {
 public:
-    explicit analysis_manager(pass_resource_manager& resource_manager_);
+    /** \brief Constructs an analysis manager.
+     *
+     * If use_analysis_cache is true, the results of relocatable analyses are shared with
+     * other managers via the process-wide analysis cache.
+     */
+    explicit analysis_manager(pass_resource_manager& resource_manager_,
+                              bool use_analysis_cache_ = true);
+
+    bool uses_analysis_cache() const;
 
     template <typename Analysis>
     util::optional_ref<const typename analysis_traits<Analysis>::result_type>
@@ -339,8 +568,16 @@ public:
 
     void invalidate(const preserved_analyses_info& preserved_analyses);
     void invalidate();
+
+    /** \brief Discards all results computed for nodes which are not part of the tree root.
+     *
+     * This needs to be called after each transformation since the memory of destroyed nodes
+     * might be reused.
+     */
+    void discard_results_outside_of(const expression& root);
 private:
     std::unordered_map<analysis_id, std::unique_ptr<analysis_node>> analysis_table_;
+    bool use_analysis_cache_;
 };
 
 class transformation_pass
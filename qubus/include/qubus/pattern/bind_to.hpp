@@ -1,6 +1,7 @@
 #ifndef QUBUS_PATTERN_BIND_TO_HPP
 #define QUBUS_PATTERN_BIND_TO_HPP
 
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/variable.hpp>
 
 #include <qubus/util/function_traits.hpp>
@@ -46,6 +47,11 @@ public:
         var_.reset();
     }
 
+    node_filter root_filter() const
+    {
+        return qubus::pattern::root_filter(bound_pattern_);
+    }
+
 private:
     Pattern bound_pattern_;
     variable<T> var_;
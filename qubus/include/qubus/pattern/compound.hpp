@@ -4,6 +4,7 @@
 #include <qubus/IR/compound_expr.hpp>
 
 #include <qubus/pattern/any.hpp>
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/sequence.hpp>
 #include <qubus/pattern/value.hpp>
 #include <qubus/pattern/variable.hpp>
@@ -52,6 +53,11 @@ public:
         body_.reset();
     }
 
+    node_filter root_filter() const
+    {
+        return node_filter::node<compound_expr>();
+    }
+
 private:
     Order order_;
     Body body_;
@@ -3,6 +3,7 @@
 
 #include <qubus/IR/construct_expr.hpp>
 
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/variable.hpp>
 #include <qubus/pattern/sequence.hpp>
 
@@ -51,6 +52,11 @@ public:
         parameters_.reset();
     }
 
+    node_filter root_filter() const
+    {
+        return node_filter::node<construct_expr>();
+    }
+
 private:
     ResultType result_type_;
     Parameters parameters_;
@@ -5,6 +5,7 @@
 
 #include <qubus/pattern/any.hpp>
 #include <qubus/pattern/literal.hpp>
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/value.hpp>
 #include <qubus/pattern/variable.hpp>
 
@@ -73,6 +74,11 @@ public:
         body_.reset();
     }
 
+    node_filter root_filter() const
+    {
+        return node_filter::node<for_expr>();
+    }
+
 private:
     Order order_;
     Index index_;
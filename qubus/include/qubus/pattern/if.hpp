@@ -3,6 +3,7 @@
 
 #include <qubus/IR/if_expr.hpp>
 
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/variable.hpp>
 
 #include <utility>
@@ -55,6 +56,11 @@ public:
         else_branch_.reset();
     }
 
+    node_filter root_filter() const
+    {
+        return node_filter::node<if_expr>();
+    }
+
 private:
     Condition condition_;
     ThenBranch then_branch_;
@@ -4,6 +4,7 @@
 #include <qubus/IR/integer_range_expr.hpp>
 
 #include <qubus/pattern/any.hpp>
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/value.hpp>
 #include <qubus/pattern/variable.hpp>
 
@@ -58,6 +59,11 @@ public:
         stride_.reset();
     }
 
+    node_filter root_filter() const
+    {
+        return node_filter::node<integer_range_expr>();
+    }
+
 private:
     LowerBound lower_bound_;
     UpperBound upper_bound_;
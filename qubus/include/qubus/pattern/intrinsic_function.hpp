@@ -3,6 +3,7 @@
 
 #include <qubus/IR/intrinsic_function_expr.hpp>
 
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/variable.hpp>
 #include <qubus/pattern/sequence.hpp>
 
@@ -50,6 +51,11 @@ public:
         name_.reset();
         args_.reset();
     }
+
+    node_filter root_filter() const
+    {
+        return node_filter::node<intrinsic_function_expr>();
+    }
 private:
     Name name_;
     Args args_;
@@ -3,6 +3,7 @@
 
 #include <qubus/IR/literal_expr.hpp>
 
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/variable.hpp>
 
 #include <utility>
@@ -43,6 +44,11 @@ public:
     {
         value_.reset();
     }
+
+    node_filter root_filter() const
+    {
+        return node_filter::node<double_literal_expr>();
+    }
 private:
     Value value_;
 };
@@ -78,6 +84,11 @@ public:
     {
         value_.reset();
     }
+
+    node_filter root_filter() const
+    {
+        return node_filter::node<float_literal_expr>();
+    }
 private:
     Value value_;
 };
@@ -113,6 +124,11 @@ public:
     {
         value_.reset();
     }
+
+    node_filter root_filter() const
+    {
+        return node_filter::node<integer_literal_expr>();
+    }
 private:
     Value value_;
 };
@@ -148,6 +164,11 @@ public:
     {
         value_.reset();
     }
+
+    node_filter root_filter() const
+    {
+        return node_filter::node<bool_literal_expr>();
+    }
 private:
     Value value_;
 };
@@ -3,6 +3,7 @@
 
 #include <qubus/IR/local_variable_def_expr.hpp>
 
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/variable.hpp>
 #include <qubus/pattern/sequence.hpp>
 
@@ -51,6 +52,11 @@ public:
         initializer_.reset();
     }
 
+    node_filter root_filter() const
+    {
+        return node_filter::node<local_variable_def_expr>();
+    }
+
 private:
     Decl decl_;
     Initializer initializer_;
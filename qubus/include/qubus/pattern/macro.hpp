@@ -3,6 +3,7 @@
 
 #include <qubus/IR/macro_expr.hpp>
 
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/variable.hpp>
 
 #include <utility>
@@ -49,6 +50,11 @@ public:
         body_.reset();
     }
 
+    node_filter root_filter() const
+    {
+        return node_filter::node<macro_expr>();
+    }
+
 private:
     Params params_;
     Body body_;
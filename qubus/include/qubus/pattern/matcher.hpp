@@ -1,15 +1,19 @@
 #ifndef QUBUS_PATTERN_MATCHER_HPP
 #define QUBUS_PATTERN_MATCHER_HPP
 
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/pattern.hpp>
 
 #include <qubus/util/function_traits.hpp>
 #include <qubus/util/unused.hpp>
 
+#include <boost/container/small_vector.hpp>
 #include <boost/optional.hpp>
 
 #include <qubus/util/make_unique.hpp>
 
+#include <cstddef>
+#include <map>
 #include <tuple>
 #include <stdexcept>
 #include <type_traits>
@@ -152,6 +156,150 @@ private:
     std::unique_ptr<case_interface> self_;
 };
 
+
+/** \brief Selects the cases of a matcher which might match a value.
+ *
+ * For arbitrary base types, all cases are candidates.
+ */
+template <typename BaseType>
+class case_dispatch_table
+{
+public:
+    void add_case(const node_filter& QUBUS_UNUSED(filter))
+    {
+        all_cases_.push_back(all_cases_.size());
+    }
+
+    const std::vector<std::size_t>& candidates(const BaseType& QUBUS_UNUSED(value)) const
+    {
+        return all_cases_;
+    }
+
+private:
+    std::vector<std::size_t> all_cases_;
+};
+
+/** \brief Selects the cases of an expression matcher based on the root of the expression.
+ *
+ * Each case is registered under the root keys admitted by its pattern. Looking up the
+ * candidates of an expression therefore only requires its root key, independent of the
+ * number of cases. The candidates are always ordered by their position in the matcher.
+ *
+ * Matchers are usually constructed right before they are used and only admit a handful of
+ * root keys. Hence, the keys are kept in a flat list and the candidates of each key are stored
+ * inline, such that building a matcher with a few cases does not allocate.
+ */
+template <>
+class case_dispatch_table<expression>
+{
+public:
+    using case_list = boost::container::small_vector<std::size_t, 4>;
+
+    void add_case(const node_filter& filter)
+    {
+        const std::size_t index = number_of_cases_++;
+
+        if (filter.admits_any_node())
+        {
+            generic_cases_.push_back(index);
+
+            for (auto& entry : cases_by_key_)
+            {
+                append_case(entry.cases, index);
+            }
+
+            return;
+        }
+
+        for (const auto& key : filter.keys())
+        {
+            if (key.operator_tag == any_operator)
+            {
+                // The case also applies to all operators of this type.
+                for (auto& entry : cases_by_key_)
+                {
+                    if (entry.type_tag == key.type_tag)
+                    {
+                        append_case(entry.cases, index);
+                    }
+                }
+            }
+
+            append_case(lookup_or_create(key), index);
+        }
+    }
+
+    const case_list& candidates(const expression& value) const
+    {
+        const auto key = root_key(value);
+
+        if (auto cases = find(key.type_tag, key.operator_tag))
+            return *cases;
+
+        if (auto cases = find(key.type_tag, any_operator))
+            return *cases;
+
+        return generic_cases_;
+    }
+
+private:
+    struct entry
+    {
+        entry(util::index_t type_tag, long int operator_tag, case_list cases)
+        : type_tag(type_tag), operator_tag(operator_tag), cases(std::move(cases))
+        {
+        }
+
+        util::index_t type_tag;
+        long int operator_tag;
+        case_list cases;
+    };
+
+    static void append_case(case_list& cases, std::size_t index)
+    {
+        if (cases.empty() || cases.back() != index)
+        {
+            cases.push_back(index);
+        }
+    }
+
+    const case_list* find(util::index_t type_tag, long int operator_tag) const
+    {
+        for (const auto& entry : cases_by_key_)
+        {
+            if (entry.type_tag == type_tag && entry.operator_tag == operator_tag)
+                return &entry.cases;
+        }
+
+        return nullptr;
+    }
+
+    case_list& lookup_or_create(const node_key& key)
+    {
+        if (auto cases = find(key.type_tag, key.operator_tag))
+            return const_cast<case_list&>(*cases);
+
+        // New entries inherit all previous cases which also admit this key.
+        case_list previous_cases = generic_cases_;
+
+        if (key.operator_tag != any_operator)
+        {
+            if (auto type_cases = find(key.type_tag, any_operator))
+            {
+                previous_cases = *type_cases;
+            }
+        }
+
+        cases_by_key_.emplace_back(key.type_tag, key.operator_tag, std::move(previous_cases));
+
+        return cases_by_key_.back().cases;
+    }
+
+    std::size_t number_of_cases_ = 0;
+    case_list generic_cases_;
+    boost::container::small_vector<entry, 4> cases_by_key_;
+};
+
 }
 
 template <typename BaseType, typename ResultType>
@@ -165,6 +313,7 @@ public:
     template <typename Pattern, typename Callback>
     matcher<BaseType, result_type> case_(Pattern pattern, Callback callback) &&
     {
+        dispatch_table_.add_case(root_filter(pattern));
         cases_.emplace_back(std::move(pattern), std::move(callback));
 
         return std::move(*this);
@@ -172,8 +321,10 @@ public:
 
     ResultType match(const BaseType& value) const
     {
-        for (const auto& case_ : cases_)
+        for (auto index : dispatch_table_.candidates(value))
         {
+            const auto& case_ = cases_[index];
+
             if (auto result = case_.try_match(value))
             {
                 return std::move(*result);
@@ -189,8 +340,10 @@ public:
 
     try_match_result_type try_match(const BaseType& value) const
     {
-        for (const auto& case_ : cases_)
+        for (auto index : dispatch_table_.candidates(value))
         {
+            const auto& case_ = cases_[index];
+
             if (auto result = case_.try_match(value))
             {
                 return std::move(*result);
@@ -214,6 +367,7 @@ public:
 
 private:
     std::vector<detail::case_type<BaseType, result_type>> cases_;
+    detail::case_dispatch_table<BaseType> dispatch_table_;
 };
 
 template <typename BaseType>
@@ -227,6 +381,7 @@ public:
     template <typename Pattern, typename Callback>
     matcher<BaseType, result_type> case_(Pattern pattern, Callback callback) &&
     {
+        dispatch_table_.add_case(root_filter(pattern));
         cases_.emplace_back(std::move(pattern), std::move(callback));
 
         return std::move(*this);
@@ -234,8 +389,10 @@ public:
 
     result_type match(const BaseType& value) const
     {
-        for (const auto& case_ : cases_)
+        for (auto index : dispatch_table_.candidates(value))
         {
+            const auto& case_ = cases_[index];
+
             if (auto result = case_.try_match(value))
             {
                 return;
@@ -251,8 +408,10 @@ public:
 
     try_match_result_type try_match(const BaseType& value) const
     {
-        for (const auto& case_ : cases_)
+        for (auto index : dispatch_table_.candidates(value))
         {
+            const auto& case_ = cases_[index];
+
             if (auto result = case_.try_match(value))
             {
                 return result;
@@ -276,6 +435,7 @@ public:
 
 private:
     std::vector<detail::case_type<BaseType, result_type>> cases_;
+    detail::case_dispatch_table<BaseType> dispatch_table_;
 };
 
 template <typename BaseType, typename ResultType>
@@ -2,6 +2,7 @@
 #define QUBUS_PATTERN_MEMBER_ACCESS_HPP
 
 #include <qubus/IR/member_access_expr.hpp>
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/variable.hpp>
 
 #include <utility>
@@ -48,6 +49,11 @@ public:
         member_name_.reset();
     }
 
+    node_filter root_filter() const
+    {
+        return node_filter::node<member_access_expr>();
+    }
+
 private:
     Object object_;
     MemberName member_name_;
@@ -0,0 +1,140 @@
+#ifndef QUBUS_PATTERN_NODE_FILTER_HPP
+#define QUBUS_PATTERN_NODE_FILTER_HPP
+
+#include <qubus/IR/binary_operator_expr.hpp>
+#include <qubus/IR/expression.hpp>
+#include <qubus/IR/unary_operator_expr.hpp>
+
+#include <qubus/util/integers.hpp>
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace qubus
+{
+namespace pattern
+{
+
+constexpr long int any_operator = -1;
+
+/** \brief Identifies the root of an expression by its type tag and, for operators, by its
+ *         operator tag.
+ */
+struct node_key
+{
+    util::index_t type_tag;
+    long int operator_tag;
+};
+
+inline node_key root_key(const expression& expr)
+{
+    if (auto binary_op = expr.try_as<binary_operator_expr>())
+        return node_key{expr.type_tag(), static_cast<long int>(binary_op->tag())};
+
+    if (auto unary_op = expr.try_as<unary_operator_expr>())
+        return node_key{expr.type_tag(), static_cast<long int>(unary_op->tag())};
+
+    return node_key{expr.type_tag(), any_operator};
+}
+
+/** \brief Describes the roots of the expressions which a pattern might match.
+ *
+ * Patterns can provide a filter through a root_filter() member. Patterns without a filter
+ * are assumed to match expressions with any root.
+ */
+class node_filter
+{
+public:
+    static node_filter any_node()
+    {
+        return node_filter();
+    }
+
+    template <typename Expression>
+    static node_filter node(long int operator_tag = any_operator)
+    {
+        node_filter filter;
+
+        // Instances of derived classes do not share the tag of their base class.
+        if constexpr (std::is_final<Expression>::value)
+        {
+            filter.admits_any_node_ = false;
+            filter.keys_.push_back(node_key{Expression::static_type_tag(), operator_tag});
+        }
+
+        return filter;
+    }
+
+    bool admits_any_node() const
+    {
+        return admits_any_node_;
+    }
+
+    const std::vector<node_key>& keys() const
+    {
+        return keys_;
+    }
+
+    bool admits(const node_key& key) const
+    {
+        if (admits_any_node_)
+            return true;
+
+        for (const auto& admitted_key : keys_)
+        {
+            if (admitted_key.type_tag == key.type_tag &&
+                (admitted_key.operator_tag == any_operator ||
+                 admitted_key.operator_tag == key.operator_tag))
+                return true;
+        }
+
+        return false;
+    }
+
+    friend node_filter operator|(node_filter lhs, const node_filter& rhs)
+    {
+        if (lhs.admits_any_node_ || rhs.admits_any_node_)
+            return any_node();
+
+        lhs.keys_.insert(lhs.keys_.end(), rhs.keys_.begin(), rhs.keys_.end());
+
+        return lhs;
+    }
+
+private:
+    bool admits_any_node_ = true;
+    std::vector<node_key> keys_;
+};
+
+namespace detail
+{
+template <typename Pattern, typename Enabler = void>
+struct has_root_filter : std::false_type
+{
+};
+
+template <typename Pattern>
+struct has_root_filter<Pattern,
+                       std::void_t<decltype(std::declval<const Pattern&>().root_filter())>>
+: std::true_type
+{
+};
+}
+
+template <typename Pattern>
+node_filter root_filter(const Pattern& pattern)
+{
+    if constexpr (detail::has_root_filter<Pattern>::value)
+    {
+        return pattern.root_filter();
+    }
+    else
+    {
+        return node_filter::any_node();
+    }
+}
+}
+}
+
+#endif
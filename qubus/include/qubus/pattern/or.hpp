@@ -1,6 +1,7 @@
 #ifndef QUBUS_PATTERN_OR_HPP
 #define QUBUS_PATTERN_OR_HPP
 
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/variable.hpp>
 
 #include <utility>
@@ -39,6 +40,11 @@ public:
         lhs_.reset();
         rhs_.reset();
     }
+
+    node_filter root_filter() const
+    {
+        return qubus::pattern::root_filter(lhs_) | qubus::pattern::root_filter(rhs_);
+    }
 private:
     LHS lhs_;
     RHS rhs_;
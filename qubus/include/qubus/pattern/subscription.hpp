@@ -3,6 +3,7 @@
 
 #include <qubus/IR/subscription_expr.hpp>
 
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/variable.hpp>
 #include <qubus/pattern/sequence.hpp>
 
@@ -50,6 +51,11 @@ public:
         indexed_expr_.reset();
         indices_.reset();
     }
+
+    node_filter root_filter() const
+    {
+        return node_filter::node<subscription_expr>();
+    }
 private:
     IndexedExpr indexed_expr_;
     Indices indices_;
@@ -45,6 +45,94 @@ std::unique_ptr<expression> substitute(const expression& expr, const Matcher& ma
     }
 }
 
+namespace detail
+{
+template <typename Matcher>
+std::unique_ptr<expression> substitute_owned(expression& expr, const Matcher& matcher);
+
+/** \brief Substitutes all matches within the children of an exclusively owned expression.
+ *
+ * Returns a null pointer if none of the children has been changed. Otherwise, the children
+ * are released from the expression and the rebuilt expression is returned.
+ */
+template <typename Matcher>
+std::unique_ptr<expression> substitute_in_children(expression& expr, const Matcher& matcher)
+{
+    std::vector<std::unique_ptr<expression>> new_children;
+
+    for (std::size_t i = 0, arity = expr.arity(); i < arity; ++i)
+    {
+        // Since the caller exclusively owns the expression, its children may be modified.
+        auto& child = const_cast<expression&>(expr.child(i));
+
+        if (auto new_child = substitute_owned(child, matcher))
+        {
+            if (new_children.empty())
+            {
+                new_children.resize(arity);
+            }
+
+            new_children[i] = std::move(new_child);
+        }
+    }
+
+    if (new_children.empty())
+        return nullptr;
+
+    auto children = expr.release_children();
+
+    for (std::size_t i = 0; i < children.size(); ++i)
+    {
+        if (new_children[i])
+        {
+            children[i] = std::move(new_children[i]);
+        }
+    }
+
+    return expr.substitute_subexpressions(std::move(children));
+}
+
+/** \brief Substitutes all matches within an exclusively owned expression.
+ *
+ * Returns a null pointer if the expression does not contain any match.
+ */
+template <typename Matcher>
+std::unique_ptr<expression> substitute_owned(expression& expr, const Matcher& matcher)
+{
+    auto new_expr = try_match(static_cast<const expression&>(expr), matcher);
+
+    if (new_expr)
+    {
+        std::unique_ptr<expression> replacement = std::move(*new_expr);
+
+        if (auto new_replacement = substitute_in_children(*replacement, matcher))
+            return new_replacement;
+
+        return replacement;
+    }
+
+    return substitute_in_children(expr, matcher);
+}
+}
+
+/** \brief Substitutes all matches within an expression which is consumed in the process.
+ *
+ * In contrast to the copying variant, subexpressions which do not contain any match are
+ * moved into the result instead of being rebuilt. Only the matched subexpressions and their
+ * ancestors are recreated, all other nodes keep their identity and annotations.
+ *
+ * The matcher should only inspect the matched subexpression, since parts of the consumed
+ * expression are taken apart during the substitution.
+ */
+template <typename Matcher>
+std::unique_ptr<expression> substitute(std::unique_ptr<expression> expr, const Matcher& matcher)
+{
+    if (auto new_expr = detail::substitute_owned(*expr, matcher))
+        return new_expr;
+
+    return expr;
+}
+
 }
 }
 
@@ -3,6 +3,7 @@
 
 #include <qubus/IR/type_conversion_expr.hpp>
 
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/variable.hpp>
 #include <qubus/pattern/any.hpp>
 
@@ -50,6 +51,11 @@ public:
         arg_.reset();
     }
 
+    node_filter root_filter() const
+    {
+        return node_filter::node<type_conversion_expr>();
+    }
+
 private:
     TargetType target_type_;
     Arg arg_;
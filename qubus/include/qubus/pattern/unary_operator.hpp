@@ -5,10 +5,12 @@
 
 #include <qubus/pattern/variable.hpp>
 #include <qubus/pattern/any.hpp>
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/value.hpp>
 
 #include <utility>
 #include <functional>
+#include <type_traits>
 
 namespace qubus
 {
@@ -50,6 +52,18 @@ public:
         tag_.reset();
         arg_.reset();
     }
+
+    node_filter root_filter() const
+    {
+        if constexpr (std::is_same<Tag, value_pattern<unary_op_tag>>::value)
+        {
+            return node_filter::node<unary_operator_expr>(static_cast<long int>(tag_.get()));
+        }
+        else
+        {
+            return node_filter::node<unary_operator_expr>();
+        }
+    }
 private:
     Tag tag_;
     Arg arg_;
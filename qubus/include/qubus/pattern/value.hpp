@@ -38,6 +38,11 @@ public:
     void reset() const
     {
     }
+
+    const T& get() const
+    {
+        return value_;
+    }
 private:
     T value_;
 };
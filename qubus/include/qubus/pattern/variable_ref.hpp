@@ -2,6 +2,7 @@
 #define QUBUS_PATTERN_VARIABLE_REF_HPP
 
 #include <qubus/IR/variable_ref_expr.hpp>
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/variable.hpp>
 #include <qubus/pattern/any.hpp>
 
@@ -45,6 +46,11 @@ public:
     {
         declaration_.reset();
     }
+
+    node_filter root_filter() const
+    {
+        return node_filter::node<variable_ref_expr>();
+    }
 private:
     Declaration declaration_;
 };
@@ -30,11 +30,28 @@ void add_code(std::unique_ptr<expression> code);
 void construct(kernel& new_kernel, std::function<void()> constructor);
 }
 
+struct kernel_options
+{
+    /** \brief Request polyhedral loop optimizations for this kernel.
+     *
+     * Kernels which can not be represented as a SCoP are compiled without them.
+     */
+    bool optimize_loops = false;
+
+    /** \brief Select the tile sizes by benchmarking several candidates on first use.
+     *
+     * The selected tile sizes are persisted across runs in the file named by the environment
+     * variable QUBUS_AUTOTUNING_DB, which defaults to qubus_autotuning.db. Only honoured if
+     * optimize_loops is set.
+     */
+    bool autotune_loops = false;
+};
+
 class kernel
 {
 public:
     template <typename Kernel>
-    kernel(Kernel kernel_)
+    kernel(Kernel kernel_, kernel_options options_ = kernel_options())
     {
         auto kernel_args = instantiate_kernel_args<Kernel>();
 
@@ -45,7 +62,7 @@ public:
         boost::hana::for_each(kernel_args,
                               [&params](const auto& arg) { params.push_back(arg.var()); });
 
-        translate_kernel(std::move(params));
+        translate_kernel(std::move(params), options_);
     }
 
     kernel(const kernel&) = delete;
@@ -82,8 +99,15 @@ public:
         computations_.push_back(std::move(code));
     }
 
+    /** \brief The symbol of the function implementing the kernel.
+     */
+    const symbol_id& entry_point() const
+    {
+        return code_;
+    }
+
 private:
-    void translate_kernel(std::vector<variable_declaration> params);
+    void translate_kernel(std::vector<variable_declaration> params, const kernel_options& options);
 
     std::vector<std::unique_ptr<expression>> computations_;
 
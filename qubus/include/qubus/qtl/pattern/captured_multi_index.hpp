@@ -1,6 +1,7 @@
 #ifndef QUBUS_QTL_PATTERN_CAPTURED_MULTI_INDEX_HPP
 #define QUBUS_QTL_PATTERN_CAPTURED_MULTI_INDEX_HPP
 
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/variable.hpp>
 #include <qubus/qtl/IR/multi_index_expr.hpp>
 
@@ -51,6 +52,11 @@ public:
         element_indices_.reset();
     }
 
+    qubus::pattern::node_filter root_filter() const
+    {
+        return qubus::pattern::node_filter::node<multi_index_expr>();
+    }
+
 private:
     MultiIndex multi_index_;
     ElementIndices element_indices_;
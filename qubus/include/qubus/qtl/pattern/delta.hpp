@@ -4,6 +4,7 @@
 #include <qubus/qtl/IR/kronecker_delta_expr.hpp>
 
 #include <qubus/pattern/any.hpp>
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/variable.hpp>
 
 #include <functional>
@@ -56,6 +57,11 @@ public:
         second_index_.reset();
     }
 
+    qubus::pattern::node_filter root_filter() const
+    {
+        return qubus::pattern::node_filter::node<kronecker_delta_expr>();
+    }
+
 private:
     Extent extent_;
     FirstIndex first_index_;
@@ -3,6 +3,7 @@
 
 #include <qubus/qtl/IR/for_all_expr.hpp>
 
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/sequence.hpp>
 #include <qubus/pattern/variable.hpp>
 
@@ -53,6 +54,11 @@ public:
         body_.reset();
     }
 
+    qubus::pattern::node_filter root_filter() const
+    {
+        return qubus::pattern::node_filter::node<for_all_expr>();
+    }
+
 private:
     Indices indices_;
     Body body_;
@@ -103,6 +109,11 @@ public:
         body_.reset();
     }
 
+    qubus::pattern::node_filter root_filter() const
+    {
+        return qubus::pattern::node_filter::node<for_all_expr>();
+    }
+
 private:
     Indices indices_;
     Alias alias_;
@@ -5,6 +5,7 @@
 #include <qubus/IR/variable_declaration.hpp>
 #include <qubus/IR/variable_ref_expr.hpp>
 #include <qubus/pattern/any.hpp>
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/type.hpp>
 #include <qubus/pattern/variable.hpp>
 
@@ -52,6 +53,11 @@ public:
         declaration_.reset();
     }
 
+    qubus::pattern::node_filter root_filter() const
+    {
+        return qubus::pattern::node_filter::node<variable_ref_expr>();
+    }
+
 private:
     Declaration declaration_;
 };
@@ -104,6 +110,11 @@ public:
         declaration_.reset();
     }
 
+    qubus::pattern::node_filter root_filter() const
+    {
+        return qubus::pattern::node_filter::node<variable_ref_expr>();
+    }
+
 private:
     Declaration declaration_;
 };
@@ -2,6 +2,7 @@
 #define QUBUS_QTL_PATTERN_OBJECT_HPP
 
 #include <qubus/qtl/IR/object_expr.hpp>
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/variable.hpp>
 
 #include <functional>
@@ -46,6 +47,11 @@ public:
         object_.reset();
     }
 
+    qubus::pattern::node_filter root_filter() const
+    {
+        return qubus::pattern::node_filter::node<object_expr>();
+    }
+
 private:
     Object object_;
 };
@@ -3,6 +3,7 @@
 
 #include <qubus/qtl/IR/sum_expr.hpp>
 
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/sequence.hpp>
 #include <qubus/pattern/variable.hpp>
 
@@ -53,6 +54,11 @@ public:
         indices_.reset();
     }
 
+    qubus::pattern::node_filter root_filter() const
+    {
+        return qubus::pattern::node_filter::node<sum_expr>();
+    }
+
 private:
     Body body_;
     Indices indices_;
@@ -103,6 +109,11 @@ public:
         alias_.reset();
     }
 
+    qubus::pattern::node_filter root_filter() const
+    {
+        return qubus::pattern::node_filter::node<sum_expr>();
+    }
+
 private:
     Body body_;
     Indices indices_;
@@ -4,6 +4,7 @@
 #include <qubus/IR/type.hpp>
 #include <qubus/IR/variable_ref_expr.hpp>
 #include <qubus/pattern/any.hpp>
+#include <qubus/pattern/node_filter.hpp>
 #include <qubus/pattern/type.hpp>
 #include <qubus/pattern/variable.hpp>
 
@@ -53,6 +54,11 @@ public:
         tensor_type_.reset();
     }
 
+    qubus::pattern::node_filter root_filter() const
+    {
+        return qubus::pattern::node_filter::node<variable_ref_expr>();
+    }
+
 private:
     Declaration declaration_;
     TensorType tensor_type_;
@@ -3,7 +3,9 @@
 
 #include <qubus/IR/module.hpp>
 
+#include <map>
 #include <memory>
+#include <string>
 
 namespace qubus
 {
@@ -13,7 +15,14 @@ class expression;
 namespace qtl
 {
 
-std::unique_ptr<module> wrap_code_in_task(std::unique_ptr<expression> expr);
+/** \brief Wraps the code into the entry function of a new module.
+ *
+ * The id of the module is derived from the canonical hash of the entry function and the
+ * pragmas, which are attached to the module. Equivalent code thus always yields the same
+ * module id, which allows the runtime to share the compiled code.
+ */
+std::unique_ptr<module> wrap_code_in_task(std::unique_ptr<expression> expr,
+                                          const std::map<std::string, std::string>& pragmas);
 
 }
 }
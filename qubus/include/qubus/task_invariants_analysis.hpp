@@ -31,6 +31,11 @@ public:
     task_invariants_analysis_result run(const expression& root, analysis_manager& manager,
                                         pass_resource_manager& resource_manager) const;
 
+    task_invariants_analysis_result relocate(const task_invariants_analysis_result& result,
+                                             const expression_relocation& relocation,
+                                             const expression& root, analysis_manager& manager,
+                                             pass_resource_manager& resource_manager) const;
+
     std::vector<analysis_id> required_analyses() const;
 };
 }
@@ -43,6 +43,11 @@ public:
     value_range_analysis_result run(const expression& root, analysis_manager& manager,
                                     pass_resource_manager& resource_manager) const;
 
+    value_range_analysis_result relocate(const value_range_analysis_result& result,
+                                         const expression_relocation& relocation,
+                                         const expression& root, analysis_manager& manager,
+                                         pass_resource_manager& resource_manager) const;
+
     std::vector<analysis_id> required_analyses() const;
 };
 }
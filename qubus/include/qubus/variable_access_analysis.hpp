@@ -102,6 +102,8 @@ public:
     access_set query_accesses_for_location(const expression& location, access_kind kind = access_kind::external) const;
 
 private:
+    friend class variable_access_analysis;
+
     std::unique_ptr<variable_access_index> access_index_;
 };
 
@@ -113,6 +115,53 @@ public:
     variable_access_analyis_result run(const expression& root, analysis_manager& manager,
                                        pass_resource_manager& resource_manager) const;
 
+    variable_access_analyis_result relocate(const variable_access_analyis_result& result,
+                                            const expression_relocation& relocation,
+                                            const expression& root, analysis_manager& manager,
+                                            pass_resource_manager& resource_manager) const;
+
+    std::vector<analysis_id> required_analyses() const;
+};
+
+/** \brief Variables which are read or written by an expression, ignoring their location.
+ *
+ * The variables are listed in the order of their first access. Written variables are not
+ * listed as read variables.
+ */
+class variable_usage_analysis_result
+{
+public:
+    variable_usage_analysis_result(std::vector<variable_declaration> read_variables_,
+                                   std::vector<variable_declaration> written_variables_);
+
+    const std::vector<variable_declaration>& read_variables() const
+    {
+        return read_variables_;
+    }
+
+    const std::vector<variable_declaration>& written_variables() const
+    {
+        return written_variables_;
+    }
+
+private:
+    std::vector<variable_declaration> read_variables_;
+    std::vector<variable_declaration> written_variables_;
+};
+
+class variable_usage_analysis
+{
+public:
+    using result_type = variable_usage_analysis_result;
+
+    variable_usage_analysis_result run(const expression& root, analysis_manager& manager,
+                                       pass_resource_manager& resource_manager) const;
+
+    variable_usage_analysis_result relocate(const variable_usage_analysis_result& result,
+                                            const expression_relocation& relocation,
+                                            const expression& root, analysis_manager& manager,
+                                            pass_resource_manager& resource_manager) const;
+
     std::vector<analysis_id> required_analyses() const;
 };
 }
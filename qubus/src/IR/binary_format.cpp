@@ -0,0 +1,1047 @@
+#include <qubus/IR/binary_format.hpp>
+
+#include <qubus/IR/module.hpp>
+#include <qubus/IR/qir.hpp>
+
+#include <qubus/util/handle.hpp>
+#include <qubus/util/integers.hpp>
+#include <qubus/util/unused.hpp>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+
+namespace qubus
+{
+
+namespace
+{
+
+constexpr char binary_qir_magic[] = {'Q', 'I', 'R', 'B'};
+
+enum class type_kind : std::uint64_t
+{
+    unknown,
+    double_,
+    float_,
+    integer,
+    bool_,
+    index,
+    multi_index,
+    complex,
+    integer_range,
+    array,
+    array_slice,
+    struct_
+};
+
+enum class node_kind : std::uint64_t
+{
+    binary_operator,
+    unary_operator,
+    double_literal,
+    float_literal,
+    integer_literal,
+    bool_literal,
+    intrinsic_function,
+    subscription,
+    type_conversion,
+    for_loop,
+    compound,
+    macro,
+    local_variable_def,
+    construct,
+    if_,
+    member_access,
+    integer_range,
+    variable_ref
+};
+
+class binary_writer
+{
+public:
+    explicit binary_writer(std::vector<char>& buffer_) : buffer_(&buffer_)
+    {
+    }
+
+    void write_varint(std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            buffer_->push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+
+        buffer_->push_back(static_cast<char>(value));
+    }
+
+    void write_signed_varint(std::int64_t value)
+    {
+        // Zigzag encoding maps values with a small magnitude to small unsigned values.
+        write_varint((static_cast<std::uint64_t>(value) << 1) ^
+                     static_cast<std::uint64_t>(value >> 63));
+    }
+
+    void write_fixed(std::uint64_t value, std::size_t width)
+    {
+        for (std::size_t i = 0; i < width; ++i)
+        {
+            buffer_->push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    void write_bytes(const char* data, std::size_t size)
+    {
+        buffer_->insert(buffer_->end(), data, data + size);
+    }
+
+private:
+    std::vector<char>* buffer_;
+};
+
+class binary_reader
+{
+public:
+    binary_reader(const char* pos_, const char* end_) : pos_(pos_), end_(end_)
+    {
+    }
+
+    std::uint64_t read_varint()
+    {
+        std::uint64_t value = 0;
+
+        for (unsigned int shift = 0; shift < 64; shift += 7)
+        {
+            if (pos_ == end_)
+                throw binary_format_error("Unexpected end of data.");
+
+            auto byte = static_cast<unsigned char>(*pos_++);
+
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+
+        throw binary_format_error("Malformed variable-length integer.");
+    }
+
+    std::int64_t read_signed_varint()
+    {
+        auto value = read_varint();
+
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    std::uint64_t read_fixed(std::size_t width)
+    {
+        auto bytes = read_bytes(width);
+
+        std::uint64_t value = 0;
+
+        for (std::size_t i = 0; i < width; ++i)
+        {
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+        }
+
+        return value;
+    }
+
+    std::string_view read_bytes(std::size_t size)
+    {
+        if (static_cast<std::size_t>(end_ - pos_) < size)
+            throw binary_format_error("Unexpected end of data.");
+
+        std::string_view bytes(pos_, size);
+
+        pos_ += size;
+
+        return bytes;
+    }
+
+    /** \brief Reads an index into a table with the specified number of entries.
+     */
+    std::size_t read_index(std::size_t table_size)
+    {
+        auto index = read_varint();
+
+        if (index >= table_size)
+            throw binary_format_error("Table index out of range.");
+
+        return index;
+    }
+
+    /** \brief Reads an enumerator of an enumeration whose enumerators are numbered
+     *         consecutively starting at zero.
+     */
+    template <typename Enum>
+    Enum read_enumerator(Enum last_enumerator)
+    {
+        auto value = read_varint();
+
+        if (value > static_cast<std::uint64_t>(last_enumerator))
+            throw binary_format_error("Enumerator out of range.");
+
+        return static_cast<Enum>(value);
+    }
+
+    /** \brief Reads the number of entries of a table.
+     *
+     * Each entry occupies at least one byte, which allows us to reject corrupted sizes before
+     * reserving any memory.
+     */
+    std::size_t read_count()
+    {
+        auto count = read_varint();
+
+        if (count > static_cast<std::size_t>(end_ - pos_))
+            throw binary_format_error("Invalid number of entries.");
+
+        return count;
+    }
+
+private:
+    const char* pos_;
+    const char* end_;
+};
+
+class qir_encoder
+{
+public:
+    qir_encoder()
+    : strings_writer_(strings_), types_writer_(types_), variables_writer_(variables_)
+    {
+    }
+
+    std::vector<char> encode(const module& mod)
+    {
+        std::vector<char> body;
+        binary_writer body_writer(body);
+
+        body_writer.write_varint(string_index(mod.id().string()));
+
+        body_writer.write_varint(mod.pragmas().size());
+
+        for (const auto& pragma : mod.pragmas())
+        {
+            body_writer.write_varint(string_index(pragma.first));
+            body_writer.write_varint(string_index(pragma.second));
+        }
+
+        std::vector<std::size_t> user_types;
+
+        for (const auto& user_type : mod.types())
+        {
+            user_types.push_back(type_index(user_type));
+        }
+
+        body_writer.write_varint(user_types.size());
+
+        for (auto index : user_types)
+        {
+            body_writer.write_varint(index);
+        }
+
+        std::vector<std::reference_wrapper<const function>> functions;
+
+        for (const auto& func : mod.functions())
+        {
+            functions.push_back(func);
+        }
+
+        body_writer.write_varint(functions.size());
+
+        std::vector<char> nodes;
+
+        for (const function& func : functions)
+        {
+            body_writer.write_varint(string_index(func.name()));
+
+            body_writer.write_varint(func.params().size());
+
+            for (const auto& param : func.params())
+            {
+                body_writer.write_varint(variable_index(param));
+            }
+
+            body_writer.write_varint(variable_index(func.result()));
+
+            nodes.clear();
+            binary_writer nodes_writer(nodes);
+
+            auto number_of_nodes = encode_expression(func.body(), nodes_writer);
+
+            body_writer.write_varint(number_of_nodes);
+            body_writer.write_bytes(nodes.data(), nodes.size());
+        }
+
+        std::vector<char> result;
+        binary_writer result_writer(result);
+
+        result_writer.write_bytes(binary_qir_magic, sizeof(binary_qir_magic));
+        result_writer.write_varint(binary_qir_version);
+
+        result_writer.write_varint(string_table_.size());
+        result_writer.write_bytes(strings_.data(), strings_.size());
+
+        result_writer.write_varint(type_table_.size());
+        result_writer.write_bytes(types_.data(), types_.size());
+
+        result_writer.write_varint(variable_table_.size());
+        result_writer.write_bytes(variables_.data(), variables_.size());
+
+        result_writer.write_bytes(body.data(), body.size());
+
+        return result;
+    }
+
+    std::size_t string_index(const std::string& value)
+    {
+        auto [pos, is_new] = string_table_.emplace(value, string_table_.size());
+
+        if (is_new)
+        {
+            strings_writer_.write_varint(value.size());
+            strings_writer_.write_bytes(value.data(), value.size());
+        }
+
+        return pos->second;
+    }
+
+    std::size_t type_index(const type& value)
+    {
+        auto search_result = type_table_.find(value);
+
+        if (search_result != type_table_.end())
+            return search_result->second;
+
+        // All types referenced by this type have to precede it in the type table.
+        if (auto complex_type = value.try_as<types::complex>())
+        {
+            auto real_type = type_index(complex_type->real_type());
+
+            types_writer_.write_varint(static_cast<std::uint64_t>(type_kind::complex));
+            types_writer_.write_varint(real_type);
+        }
+        else if (auto array_type = value.try_as<types::array>())
+        {
+            auto value_type = type_index(array_type->value_type());
+
+            types_writer_.write_varint(static_cast<std::uint64_t>(type_kind::array));
+            types_writer_.write_varint(value_type);
+            types_writer_.write_signed_varint(array_type->rank());
+        }
+        else if (auto slice_type = value.try_as<types::array_slice>())
+        {
+            auto value_type = type_index(slice_type->value_type());
+
+            types_writer_.write_varint(static_cast<std::uint64_t>(type_kind::array_slice));
+            types_writer_.write_varint(value_type);
+            types_writer_.write_signed_varint(slice_type->rank());
+        }
+        else if (auto struct_type = value.try_as<types::struct_>())
+        {
+            std::vector<std::pair<std::size_t, std::size_t>> members;
+
+            for (const auto& member : struct_type->members())
+            {
+                members.emplace_back(type_index(member.datatype), string_index(member.id));
+            }
+
+            types_writer_.write_varint(static_cast<std::uint64_t>(type_kind::struct_));
+            types_writer_.write_varint(string_index(struct_type->id()));
+            types_writer_.write_varint(members.size());
+
+            for (const auto& member : members)
+            {
+                types_writer_.write_varint(member.first);
+                types_writer_.write_varint(member.second);
+            }
+        }
+        else if (auto multi_index_type = value.try_as<types::multi_index>())
+        {
+            types_writer_.write_varint(static_cast<std::uint64_t>(type_kind::multi_index));
+            types_writer_.write_signed_varint(multi_index_type->rank());
+        }
+        else
+        {
+            types_writer_.write_varint(static_cast<std::uint64_t>(primitive_type_kind(value)));
+        }
+
+        auto index = type_table_.size();
+
+        type_table_.emplace(value, index);
+
+        return index;
+    }
+
+    std::size_t variable_index(const variable_declaration& var)
+    {
+        auto search_result = variable_table_.find(var.id());
+
+        if (search_result != variable_table_.end())
+            return search_result->second;
+
+        auto name = string_index(var.name());
+        auto var_type = type_index(var.var_type());
+
+        variables_writer_.write_varint(name);
+        variables_writer_.write_varint(var_type);
+
+        auto index = variable_table_.size();
+
+        variable_table_.emplace(var.id(), index);
+
+        return index;
+    }
+
+private:
+    static type_kind primitive_type_kind(const type& value)
+    {
+        if (value.try_as<types::double_>())
+            return type_kind::double_;
+
+        if (value.try_as<types::float_>())
+            return type_kind::float_;
+
+        if (value.try_as<types::integer>())
+            return type_kind::integer;
+
+        if (value.try_as<types::bool_>())
+            return type_kind::bool_;
+
+        if (value.try_as<types::index>())
+            return type_kind::index;
+
+        if (value.try_as<types::integer_range_type>())
+            return type_kind::integer_range;
+
+        if (value.try_as<types::unknown>())
+            return type_kind::unknown;
+
+        throw binary_format_error("Unsupported type.");
+    }
+
+    std::size_t encode_expression(const expression& expr, binary_writer& writer);
+
+    std::vector<char> strings_;
+    std::vector<char> types_;
+    std::vector<char> variables_;
+
+    binary_writer strings_writer_;
+    binary_writer types_writer_;
+    binary_writer variables_writer_;
+
+    std::unordered_map<std::string, std::size_t> string_table_;
+    std::unordered_map<type, std::size_t> type_table_;
+    std::unordered_map<util::handle, std::size_t> variable_table_;
+};
+
+/** \brief Writes the kind, the arity and the properties of a node which are not part of its
+ *         children.
+ */
+class node_encoder
+{
+public:
+    node_encoder(qir_encoder& encoder_, binary_writer& writer_)
+    : encoder_(&encoder_), writer_(&writer_)
+    {
+    }
+
+    void operator()(const binary_operator_expr& expr) const
+    {
+        begin_node(node_kind::binary_operator, expr);
+        writer_->write_varint(static_cast<std::uint64_t>(expr.tag()));
+    }
+
+    void operator()(const unary_operator_expr& expr) const
+    {
+        begin_node(node_kind::unary_operator, expr);
+        writer_->write_varint(static_cast<std::uint64_t>(expr.tag()));
+    }
+
+    void operator()(const double_literal_expr& expr) const
+    {
+        static_assert(sizeof(double) == sizeof(std::uint64_t), "Unsupported double format.");
+
+        auto value = expr.value();
+
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        begin_node(node_kind::double_literal, expr);
+        writer_->write_fixed(bits, sizeof(bits));
+    }
+
+    void operator()(const float_literal_expr& expr) const
+    {
+        static_assert(sizeof(float) == sizeof(std::uint32_t), "Unsupported float format.");
+
+        auto value = expr.value();
+
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        begin_node(node_kind::float_literal, expr);
+        writer_->write_fixed(bits, sizeof(bits));
+    }
+
+    void operator()(const integer_literal_expr& expr) const
+    {
+        begin_node(node_kind::integer_literal, expr);
+        writer_->write_signed_varint(expr.value());
+    }
+
+    void operator()(const bool_literal_expr& expr) const
+    {
+        begin_node(node_kind::bool_literal, expr);
+        writer_->write_varint(expr.value() ? 1 : 0);
+    }
+
+    void operator()(const intrinsic_function_expr& expr) const
+    {
+        begin_node(node_kind::intrinsic_function, expr);
+        writer_->write_varint(encoder_->string_index(expr.name()));
+    }
+
+    void operator()(const subscription_expr& expr) const
+    {
+        begin_node(node_kind::subscription, expr);
+    }
+
+    void operator()(const type_conversion_expr& expr) const
+    {
+        begin_node(node_kind::type_conversion, expr);
+        writer_->write_varint(encoder_->type_index(expr.target_type()));
+    }
+
+    void operator()(const for_expr& expr) const
+    {
+        begin_node(node_kind::for_loop, expr);
+        writer_->write_varint(encoder_->variable_index(expr.loop_index()));
+        writer_->write_varint(static_cast<std::uint64_t>(expr.order()));
+    }
+
+    void operator()(const compound_expr& expr) const
+    {
+        begin_node(node_kind::compound, expr);
+        writer_->write_varint(static_cast<std::uint64_t>(expr.order()));
+    }
+
+    void operator()(const macro_expr& expr) const
+    {
+        begin_node(node_kind::macro, expr);
+        writer_->write_varint(expr.params().size());
+
+        for (const auto& param : expr.params())
+        {
+            writer_->write_varint(encoder_->variable_index(param));
+        }
+    }
+
+    void operator()(const local_variable_def_expr& expr) const
+    {
+        begin_node(node_kind::local_variable_def, expr);
+        writer_->write_varint(encoder_->variable_index(expr.decl()));
+    }
+
+    void operator()(const construct_expr& expr) const
+    {
+        begin_node(node_kind::construct, expr);
+        writer_->write_varint(encoder_->type_index(expr.result_type()));
+    }
+
+    void operator()(const if_expr& expr) const
+    {
+        begin_node(node_kind::if_, expr);
+    }
+
+    void operator()(const member_access_expr& expr) const
+    {
+        begin_node(node_kind::member_access, expr);
+        writer_->write_varint(encoder_->string_index(expr.member_name()));
+    }
+
+    void operator()(const integer_range_expr& expr) const
+    {
+        begin_node(node_kind::integer_range, expr);
+    }
+
+    void operator()(const variable_ref_expr& expr) const
+    {
+        begin_node(node_kind::variable_ref, expr);
+        writer_->write_varint(encoder_->variable_index(expr.declaration()));
+    }
+
+    void operator()(const expression& QUBUS_UNUSED(expr)) const
+    {
+        throw binary_format_error("Unsupported expression.");
+    }
+
+private:
+    void begin_node(node_kind kind, const expression& expr) const
+    {
+        writer_->write_varint(static_cast<std::uint64_t>(kind));
+        writer_->write_varint(expr.arity());
+    }
+
+    qir_encoder* encoder_;
+    binary_writer* writer_;
+};
+
+std::size_t qir_encoder::encode_expression(const expression& expr, binary_writer& writer)
+{
+    std::size_t number_of_nodes = 1;
+
+    for (const auto& child : expr.sub_expressions())
+    {
+        number_of_nodes += encode_expression(child, writer);
+    }
+
+    visit<binary_operator_expr, unary_operator_expr, double_literal_expr, float_literal_expr,
+          integer_literal_expr, bool_literal_expr, intrinsic_function_expr, subscription_expr,
+          type_conversion_expr, for_expr, compound_expr, macro_expr, local_variable_def_expr,
+          construct_expr, if_expr, member_access_expr, integer_range_expr, variable_ref_expr>(
+        expr, node_encoder(*this, writer));
+
+    return number_of_nodes;
+}
+
+std::unique_ptr<access_expr> as_access_expr(std::unique_ptr<expression> expr)
+{
+    auto access = dynamic_cast<access_expr*>(expr.get());
+
+    if (!access)
+        throw binary_format_error("Expected an access expression.");
+
+    expr.release();
+
+    return std::unique_ptr<access_expr>(access);
+}
+
+class qir_decoder
+{
+public:
+    explicit qir_decoder(binary_reader reader_) : reader_(std::move(reader_))
+    {
+    }
+
+    std::unique_ptr<module> decode()
+    {
+        auto magic = reader_.read_bytes(sizeof(binary_qir_magic));
+
+        if (std::memcmp(magic.data(), binary_qir_magic, sizeof(binary_qir_magic)) != 0)
+            throw binary_format_error("Missing binary QIR header.");
+
+        auto version = reader_.read_varint();
+
+        if (version != binary_qir_version)
+            throw binary_format_error("Unsupported format version " + std::to_string(version) +
+                                      ".");
+
+        decode_strings();
+        decode_types();
+        decode_variables();
+
+        auto mod = std::make_unique<module>(symbol_id(read_string()));
+
+        auto number_of_pragmas = reader_.read_count();
+
+        for (std::size_t i = 0; i < number_of_pragmas; ++i)
+        {
+            auto name = read_string();
+            auto value = read_string();
+
+            mod->set_pragma(std::move(name), std::move(value));
+        }
+
+        auto number_of_user_types = reader_.read_count();
+
+        for (std::size_t i = 0; i < number_of_user_types; ++i)
+        {
+            const auto& user_type = read_type();
+
+            auto struct_type = user_type.try_as<types::struct_>();
+
+            if (!struct_type)
+                throw binary_format_error("User-defined types have to be structs.");
+
+            mod->add_type(*struct_type);
+        }
+
+        auto number_of_functions = reader_.read_count();
+
+        for (std::size_t i = 0; i < number_of_functions; ++i)
+        {
+            auto name = read_string();
+
+            auto number_of_params = reader_.read_count();
+
+            std::vector<variable_declaration> params;
+            params.reserve(number_of_params);
+
+            for (std::size_t j = 0; j < number_of_params; ++j)
+            {
+                params.push_back(read_variable());
+            }
+
+            auto result = read_variable();
+
+            auto body = decode_expression();
+
+            mod->add_function(std::move(name), std::move(params), std::move(result),
+                              std::move(body));
+        }
+
+        return mod;
+    }
+
+private:
+    void decode_strings()
+    {
+        auto number_of_strings = reader_.read_count();
+
+        strings_.reserve(number_of_strings);
+
+        for (std::size_t i = 0; i < number_of_strings; ++i)
+        {
+            auto length = reader_.read_varint();
+
+            strings_.push_back(reader_.read_bytes(length));
+        }
+    }
+
+    void decode_types()
+    {
+        auto number_of_types = reader_.read_count();
+
+        types_.reserve(number_of_types);
+
+        for (std::size_t i = 0; i < number_of_types; ++i)
+        {
+            types_.push_back(decode_type());
+        }
+    }
+
+    type decode_type()
+    {
+        auto kind = static_cast<type_kind>(reader_.read_varint());
+
+        switch (kind)
+        {
+        case type_kind::unknown:
+            return types::unknown{};
+        case type_kind::double_:
+            return types::double_{};
+        case type_kind::float_:
+            return types::float_{};
+        case type_kind::integer:
+            return types::integer{};
+        case type_kind::bool_:
+            return types::bool_{};
+        case type_kind::index:
+            return types::index{};
+        case type_kind::multi_index:
+            return types::multi_index(reader_.read_signed_varint());
+        case type_kind::complex:
+            return types::complex(read_type());
+        case type_kind::integer_range:
+            return types::integer_range_type{};
+        case type_kind::array:
+        {
+            auto value_type = read_type();
+            auto rank = reader_.read_signed_varint();
+
+            return types::array(value_type, rank);
+        }
+        case type_kind::array_slice:
+        {
+            auto value_type = read_type();
+            auto rank = reader_.read_signed_varint();
+
+            return types::array_slice(value_type, rank);
+        }
+        case type_kind::struct_:
+        {
+            auto id = read_string();
+
+            auto number_of_members = reader_.read_count();
+
+            std::vector<types::struct_::member> members;
+            members.reserve(number_of_members);
+
+            for (std::size_t i = 0; i < number_of_members; ++i)
+            {
+                auto datatype = read_type();
+                auto member_id = read_string();
+
+                members.emplace_back(datatype, std::move(member_id));
+            }
+
+            return types::struct_(std::move(id), std::move(members));
+        }
+        default:
+            throw binary_format_error("Unknown type kind.");
+        }
+    }
+
+    void decode_variables()
+    {
+        auto number_of_variables = reader_.read_count();
+
+        variables_.reserve(number_of_variables);
+
+        for (std::size_t i = 0; i < number_of_variables; ++i)
+        {
+            auto name = read_string();
+            auto var_type = read_type();
+
+            variables_.emplace_back(std::move(name), var_type);
+        }
+    }
+
+    /** \brief Decodes the nodes of an expression.
+     *
+     * The nodes are stored in post-order, so the children of each node are the topmost
+     * expressions on the stack.
+     */
+    std::unique_ptr<expression> decode_expression()
+    {
+        auto number_of_nodes = reader_.read_count();
+
+        std::vector<std::unique_ptr<expression>> stack;
+
+        for (std::size_t i = 0; i < number_of_nodes; ++i)
+        {
+            auto kind = static_cast<node_kind>(reader_.read_varint());
+            auto arity = reader_.read_varint();
+
+            if (arity > stack.size())
+                throw binary_format_error("Missing operands.");
+
+            std::vector<std::unique_ptr<expression>> children(
+                std::make_move_iterator(stack.end() - arity), std::make_move_iterator(stack.end()));
+
+            stack.erase(stack.end() - arity, stack.end());
+
+            stack.push_back(decode_node(kind, std::move(children)));
+        }
+
+        if (stack.size() != 1)
+            throw binary_format_error("Malformed expression.");
+
+        return std::move(stack.back());
+    }
+
+    std::unique_ptr<expression> decode_node(node_kind kind,
+                                            std::vector<std::unique_ptr<expression>> children)
+    {
+        switch (kind)
+        {
+        case node_kind::binary_operator:
+        {
+            expect_arity(children, 2);
+
+            auto tag = reader_.read_enumerator(binary_op_tag::logical_or);
+
+            return binary_operator(tag, std::move(children[0]), std::move(children[1]));
+        }
+        case node_kind::unary_operator:
+        {
+            expect_arity(children, 1);
+
+            auto tag = reader_.read_enumerator(unary_op_tag::logical_not);
+
+            return unary_operator(tag, std::move(children[0]));
+        }
+        case node_kind::double_literal:
+        {
+            expect_arity(children, 0);
+
+            std::uint64_t bits = reader_.read_fixed(sizeof(std::uint64_t));
+
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+
+            return double_literal(value);
+        }
+        case node_kind::float_literal:
+        {
+            expect_arity(children, 0);
+
+            auto bits = static_cast<std::uint32_t>(reader_.read_fixed(sizeof(std::uint32_t)));
+
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+
+            return float_literal(value);
+        }
+        case node_kind::integer_literal:
+            expect_arity(children, 0);
+
+            return integer_literal(reader_.read_signed_varint());
+        case node_kind::bool_literal:
+            expect_arity(children, 0);
+
+            return bool_literal(reader_.read_varint() != 0);
+        case node_kind::intrinsic_function:
+            return intrinsic_function(read_string(), std::move(children));
+        case node_kind::subscription:
+        {
+            if (children.empty())
+                throw binary_format_error("Missing operands.");
+
+            auto indexed_expr = as_access_expr(std::move(children.front()));
+
+            children.erase(children.begin());
+
+            return subscription(std::move(indexed_expr), std::move(children));
+        }
+        case node_kind::type_conversion:
+            expect_arity(children, 1);
+
+            return type_conversion(read_type(), std::move(children[0]));
+        case node_kind::for_loop:
+        {
+            expect_arity(children, 4);
+
+            auto loop_index = read_variable();
+            auto order = reader_.read_enumerator(execution_order::parallel);
+
+            return std::make_unique<for_expr>(order, std::move(loop_index), std::move(children[0]),
+                                              std::move(children[1]), std::move(children[2]),
+                                              std::move(children[3]));
+        }
+        case node_kind::compound:
+        {
+            auto order = reader_.read_enumerator(execution_order::parallel);
+
+            return std::make_unique<compound_expr>(order, std::move(children));
+        }
+        case node_kind::macro:
+        {
+            expect_arity(children, 1);
+
+            auto number_of_params = reader_.read_count();
+
+            std::vector<variable_declaration> params;
+            params.reserve(number_of_params);
+
+            for (std::size_t i = 0; i < number_of_params; ++i)
+            {
+                params.push_back(read_variable());
+            }
+
+            return make_macro(std::move(params), std::move(children[0]));
+        }
+        case node_kind::local_variable_def:
+            expect_arity(children, 1);
+
+            return std::make_unique<local_variable_def_expr>(read_variable(),
+                                                             std::move(children[0]));
+        case node_kind::construct:
+            return construct(read_type(), std::move(children));
+        case node_kind::if_:
+            if (children.size() == 3)
+            {
+                return if_(std::move(children[0]), std::move(children[1]),
+                           std::move(children[2]));
+            }
+
+            expect_arity(children, 2);
+
+            return if_(std::move(children[0]), std::move(children[1]));
+        case node_kind::member_access:
+            expect_arity(children, 1);
+
+            return member_access(as_access_expr(std::move(children[0])), read_string());
+        case node_kind::integer_range:
+            expect_arity(children, 3);
+
+            return range(std::move(children[0]), std::move(children[1]), std::move(children[2]));
+        case node_kind::variable_ref:
+            expect_arity(children, 0);
+
+            return variable_ref(read_variable());
+        default:
+            throw binary_format_error("Unknown expression kind.");
+        }
+    }
+
+    static void expect_arity(const std::vector<std::unique_ptr<expression>>& children,
+                             std::size_t arity)
+    {
+        if (children.size() != arity)
+            throw binary_format_error("Wrong number of operands.");
+    }
+
+    std::string read_string()
+    {
+        return std::string(strings_[reader_.read_index(strings_.size())]);
+    }
+
+    const type& read_type()
+    {
+        return types_[reader_.read_index(types_.size())];
+    }
+
+    const variable_declaration& read_variable()
+    {
+        return variables_[reader_.read_index(variables_.size())];
+    }
+
+    binary_reader reader_;
+
+    std::vector<std::string_view> strings_;
+    std::vector<type> types_;
+    std::vector<variable_declaration> variables_;
+};
+}
+
+std::vector<char> encode_binary_qir(const module& mod)
+{
+    qir_encoder encoder;
+
+    return encoder.encode(mod);
+}
+
+std::unique_ptr<module> decode_binary_qir(const char* data, std::size_t size)
+{
+    qir_decoder decoder(binary_reader(data, data + size));
+
+    return decoder.decode();
+}
+
+std::unique_ptr<module> decode_binary_qir(const std::vector<char>& buffer)
+{
+    return decode_binary_qir(buffer.data(), buffer.size());
+}
+
+void save_binary_qir(const module& mod, const std::string& filename)
+{
+    auto buffer = encode_binary_qir(mod);
+
+    std::ofstream fout(filename, std::ios::binary);
+
+    fout.write(buffer.data(), buffer.size());
+
+    fout.close();
+
+    if (!fout)
+        throw binary_qir_io_error("Unable to write " + filename + ".");
+}
+
+std::unique_ptr<module> load_binary_qir(const std::string& filename)
+{
+    namespace bip = boost::interprocess;
+
+    bip::file_mapping file(filename.c_str(), bip::read_only);
+    bip::mapped_region region(file, bip::read_only);
+
+    return decode_binary_qir(static_cast<const char*>(region.get_address()), region.get_size());
+}
+}
@@ -53,6 +53,17 @@ std::size_t binary_operator_expr::arity() const
     return 2;
 }
 
+std::vector<std::unique_ptr<expression>> binary_operator_expr::release_children()
+{
+    std::vector<std::unique_ptr<expression>> children;
+    children.reserve(2);
+
+    children.push_back(std::move(left_));
+    children.push_back(std::move(right_));
+
+    return children;
+}
+
 std::unique_ptr<expression> binary_operator_expr::substitute_subexpressions(
     std::vector<std::unique_ptr<expression>> new_children) const
 {
@@ -35,6 +35,11 @@ std::size_t compound_expr::arity() const
     return body_.size();
 }
 
+std::vector<std::unique_ptr<expression>> compound_expr::release_children()
+{
+    return std::move(body_);
+}
+
 std::unique_ptr<expression> compound_expr::substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const
 {
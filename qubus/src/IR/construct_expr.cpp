@@ -24,7 +24,7 @@ const expression& construct_expr::child(std::size_t index) const
 {
     if (index < parameters_.size())
     {
-        return *parameters_[0];
+        return *parameters_[index];
     }
     else
     {
@@ -37,6 +37,11 @@ std::size_t construct_expr::arity() const
     return parameters_.size();
 }
 
+std::vector<std::unique_ptr<expression>> construct_expr::release_children()
+{
+    return std::move(parameters_);
+}
+
 std::unique_ptr<expression> construct_expr::substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const
 {
@@ -5,8 +5,15 @@
 #include <qubus/pattern/core.hpp>
 #include <qubus/pattern/IR.hpp>
 
-#include <mutex>
+#include <qubus/util/hash.hpp>
+#include <qubus/util/unused.hpp>
+
+#include <atomic>
 #include <functional>
+#include <mutex>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
 
 namespace qubus
 {
@@ -94,6 +101,11 @@ std::once_flag equal_init_flag = {};
 
 bool operator==(const expression& lhs, const expression& rhs)
 {
+    // Structurally equal expressions have equal hashes, which allows us to reject most
+    // mismatches without traversing the expressions.
+    if (structural_hash(lhs) != structural_hash(rhs))
+        return false;
+
     std::call_once(equal_init_flag, init_equal);
 
     return equal(lhs, rhs);
@@ -104,6 +116,482 @@ bool operator!=(const expression& lhs, const expression& rhs)
     return !(lhs == rhs);
 }
 
+namespace
+{
+/** \brief Hashes the properties of a node which are not part of its children.
+ */
+template <typename VariableHasher>
+class node_property_hasher
+{
+public:
+    node_property_hasher(std::size_t& seed_, VariableHasher hash_variable_)
+    : seed_(&seed_), hash_variable_(std::move(hash_variable_))
+    {
+    }
+
+    void operator()(const variable_ref_expr& var_ref) const
+    {
+        hash_variable_(*seed_, var_ref.declaration());
+    }
+
+    void operator()(const binary_operator_expr& binary_op) const
+    {
+        util::hash_combine(*seed_, binary_op.tag());
+    }
+
+    void operator()(const unary_operator_expr& unary_op) const
+    {
+        util::hash_combine(*seed_, unary_op.tag());
+    }
+
+    void operator()(const intrinsic_function_expr& intrinsic) const
+    {
+        util::hash_combine(*seed_, intrinsic.name());
+    }
+
+    void operator()(const integer_literal_expr& literal) const
+    {
+        util::hash_combine(*seed_, literal.value());
+    }
+
+    void operator()(const double_literal_expr& literal) const
+    {
+        util::hash_combine(*seed_, literal.value());
+    }
+
+    void operator()(const float_literal_expr& literal) const
+    {
+        util::hash_combine(*seed_, literal.value());
+    }
+
+    void operator()(const type_conversion_expr& conversion) const
+    {
+        util::hash_combine(*seed_, conversion.target_type());
+    }
+
+    void operator()(const for_expr& loop) const
+    {
+        hash_variable_(*seed_, loop.loop_index());
+        util::hash_combine(*seed_, loop.order());
+    }
+
+    void operator()(const compound_expr& compound) const
+    {
+        util::hash_combine(*seed_, compound.order());
+    }
+
+    void operator()(const expression& QUBUS_UNUSED(expr)) const
+    {
+    }
+
+protected:
+    std::size_t& seed() const
+    {
+        return *seed_;
+    }
+
+    const VariableHasher& hash_variable() const
+    {
+        return hash_variable_;
+    }
+
+private:
+    std::size_t* seed_;
+    VariableHasher hash_variable_;
+};
+
+struct variable_identity_hasher
+{
+    void operator()(std::size_t& seed, const variable_declaration& var) const
+    {
+        util::hash_combine(seed, var.id());
+    }
+};
+
+std::size_t compute_structural_hash(const expression& expr)
+{
+    std::size_t seed = 0;
+
+    util::hash_combine(seed, expr.type_tag());
+
+    visit<variable_ref_expr, binary_operator_expr, unary_operator_expr, intrinsic_function_expr,
+          integer_literal_expr, double_literal_expr, float_literal_expr, type_conversion_expr,
+          for_expr, compound_expr>(
+        expr, node_property_hasher<variable_identity_hasher>(seed, variable_identity_hasher()));
+
+    for (const auto& child : expr.sub_expressions())
+    {
+        util::hash_combine(seed, structural_hash(child));
+    }
+
+    return seed;
+}
+}
+
+std::size_t structural_hash(const expression& expr)
+{
+    auto hash = expr.structural_hash_.load(std::memory_order_relaxed);
+
+    if (hash == 0)
+    {
+        hash = compute_structural_hash(expr);
+
+        // Reserve zero for hashes which have not been computed yet.
+        if (hash == 0)
+        {
+            hash = 1;
+        }
+
+        // Concurrent computations of the hash yield the same value, so the race is benign.
+        expr.structural_hash_.store(hash, std::memory_order_relaxed);
+    }
+
+    return hash;
+}
+
+namespace
+{
+/** \brief Numbers the variables in the order of their first occurrence.
+ */
+class variable_numbering
+{
+public:
+    explicit variable_numbering(std::unordered_map<util::handle, std::size_t>& numbers_,
+                                std::vector<variable_declaration>* variables_ = nullptr)
+    : numbers_(&numbers_), variables_(variables_)
+    {
+    }
+
+    void operator()(std::size_t& seed, const variable_declaration& var) const
+    {
+        auto [number, is_new] = number_variable(var);
+
+        if (is_new)
+        {
+            util::hash_combine(seed, var.var_type());
+        }
+
+        util::hash_combine(seed, number);
+    }
+
+    /** \brief Returns the number of the variable, numbering it if it occurs for the first time.
+     */
+    std::size_t operator()(const variable_declaration& var) const
+    {
+        return number_variable(var).first;
+    }
+
+private:
+    std::pair<std::size_t, bool> number_variable(const variable_declaration& var) const
+    {
+        auto next_number = numbers_->size();
+
+        auto [pos, is_new] = numbers_->emplace(var.id(), next_number);
+
+        if (is_new && variables_)
+        {
+            variables_->push_back(var);
+        }
+
+        return {pos->second, is_new};
+    }
+
+    std::unordered_map<util::handle, std::size_t>* numbers_;
+    std::vector<variable_declaration>* variables_;
+};
+
+/** \brief Hashes all properties of a node which might influence the generated code.
+ */
+class canonical_node_property_hasher : public node_property_hasher<variable_numbering>
+{
+public:
+    using node_property_hasher<variable_numbering>::node_property_hasher;
+    using node_property_hasher<variable_numbering>::operator();
+
+    void operator()(const bool_literal_expr& literal) const
+    {
+        util::hash_combine(seed(), literal.value());
+    }
+
+    void operator()(const local_variable_def_expr& def) const
+    {
+        hash_variable()(seed(), def.decl());
+    }
+
+    void operator()(const member_access_expr& access) const
+    {
+        util::hash_combine(seed(), access.member_name());
+    }
+
+    void operator()(const construct_expr& construction) const
+    {
+        util::hash_combine(seed(), construction.result_type());
+    }
+
+    void operator()(const macro_expr& macro) const
+    {
+        for (const auto& param : macro.params())
+        {
+            hash_variable()(seed(), param);
+        }
+    }
+};
+
+void hash_canonical_node_properties(const expression& expr, std::size_t& seed,
+                                    const variable_numbering& numbering)
+{
+    // Type tags are assigned per process, so we use the type info instead.
+    util::hash_combine(seed, std::type_index(typeid(expr)));
+    util::hash_combine(seed, expr.arity());
+
+    visit<variable_ref_expr, binary_operator_expr, unary_operator_expr, intrinsic_function_expr,
+          integer_literal_expr, double_literal_expr, float_literal_expr, bool_literal_expr,
+          type_conversion_expr, for_expr, compound_expr, local_variable_def_expr,
+          member_access_expr, construct_expr, macro_expr>(
+        expr, canonical_node_property_hasher(seed, numbering));
+}
+
+void compute_canonical_hash(const expression& expr, std::size_t& seed,
+                            const variable_numbering& numbering)
+{
+    hash_canonical_node_properties(expr, seed, numbering);
+
+    for (const auto& child : expr.sub_expressions())
+    {
+        compute_canonical_hash(child, seed, numbering);
+    }
+}
+}
+
+std::size_t canonical_hash(const expression& expr,
+                           const std::vector<variable_declaration>& free_variables)
+{
+    std::unordered_map<util::handle, std::size_t> numbers;
+    variable_numbering numbering(numbers);
+
+    std::size_t seed = 0;
+
+    util::hash_combine(seed, free_variables.size());
+
+    for (const auto& var : free_variables)
+    {
+        numbering(seed, var);
+    }
+
+    compute_canonical_hash(expr, seed, numbering);
+
+    return seed;
+}
+
+std::vector<variable_declaration> canonical_variables(const expression& expr)
+{
+    std::unordered_map<util::handle, std::size_t> numbers;
+    std::vector<variable_declaration> variables;
+    variable_numbering numbering(numbers, &variables);
+
+    std::size_t seed = 0;
+
+    compute_canonical_hash(expr, seed, numbering);
+
+    return variables;
+}
+
+namespace
+{
+/** \brief Compares the properties of two nodes of the same type which are not part of their
+ *         children.
+ *
+ * The visitor is applied to the left-hand side. Since the variables of both expressions are
+ * numbered in the order of their first occurrence, corresponding variables only have equal
+ * numbers if they are mapped onto each other bijectively.
+ */
+class canonical_node_property_comparator
+{
+public:
+    canonical_node_property_comparator(const expression& rhs_,
+                                       const variable_numbering& lhs_numbering_,
+                                       const variable_numbering& rhs_numbering_)
+    : rhs_(&rhs_), lhs_numbering_(&lhs_numbering_), rhs_numbering_(&rhs_numbering_)
+    {
+    }
+
+    bool operator()(const variable_ref_expr& var_ref) const
+    {
+        return equivalent(var_ref.declaration(), rhs(var_ref).declaration());
+    }
+
+    bool operator()(const binary_operator_expr& binary_op) const
+    {
+        return binary_op.tag() == rhs(binary_op).tag();
+    }
+
+    bool operator()(const unary_operator_expr& unary_op) const
+    {
+        return unary_op.tag() == rhs(unary_op).tag();
+    }
+
+    bool operator()(const intrinsic_function_expr& intrinsic) const
+    {
+        return intrinsic.name() == rhs(intrinsic).name();
+    }
+
+    bool operator()(const integer_literal_expr& literal) const
+    {
+        return literal.value() == rhs(literal).value();
+    }
+
+    bool operator()(const double_literal_expr& literal) const
+    {
+        return literal.value() == rhs(literal).value();
+    }
+
+    bool operator()(const float_literal_expr& literal) const
+    {
+        return literal.value() == rhs(literal).value();
+    }
+
+    bool operator()(const bool_literal_expr& literal) const
+    {
+        return literal.value() == rhs(literal).value();
+    }
+
+    bool operator()(const type_conversion_expr& conversion) const
+    {
+        return conversion.target_type() == rhs(conversion).target_type();
+    }
+
+    bool operator()(const for_expr& loop) const
+    {
+        const auto& other = rhs(loop);
+
+        return loop.order() == other.order() && equivalent(loop.loop_index(), other.loop_index());
+    }
+
+    bool operator()(const compound_expr& compound) const
+    {
+        return compound.order() == rhs(compound).order();
+    }
+
+    bool operator()(const local_variable_def_expr& def) const
+    {
+        return equivalent(def.decl(), rhs(def).decl());
+    }
+
+    bool operator()(const member_access_expr& access) const
+    {
+        return access.member_name() == rhs(access).member_name();
+    }
+
+    bool operator()(const construct_expr& construction) const
+    {
+        return construction.result_type() == rhs(construction).result_type();
+    }
+
+    bool operator()(const macro_expr& macro) const
+    {
+        const auto& lhs_params = macro.params();
+        const auto& rhs_params = rhs(macro).params();
+
+        if (lhs_params.size() != rhs_params.size())
+            return false;
+
+        for (std::size_t i = 0; i < lhs_params.size(); ++i)
+        {
+            if (!equivalent(lhs_params[i], rhs_params[i]))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool operator()(const expression& QUBUS_UNUSED(expr)) const
+    {
+        return true;
+    }
+
+private:
+    template <typename Expression>
+    const Expression& rhs(const Expression& QUBUS_UNUSED(lhs)) const
+    {
+        return static_cast<const Expression&>(*rhs_);
+    }
+
+    bool equivalent(const variable_declaration& lhs, const variable_declaration& rhs) const
+    {
+        return lhs.var_type() == rhs.var_type() &&
+               (*lhs_numbering_)(lhs) == (*rhs_numbering_)(rhs);
+    }
+
+    const expression* rhs_;
+    const variable_numbering* lhs_numbering_;
+    const variable_numbering* rhs_numbering_;
+};
+
+bool are_alpha_equivalent(const expression& lhs, const variable_numbering& lhs_numbering,
+                          const expression& rhs, const variable_numbering& rhs_numbering)
+{
+    if (typeid(lhs) != typeid(rhs) || lhs.arity() != rhs.arity())
+        return false;
+
+    // Comparing the hashes of both nodes rejects most mismatches cheaply. Hash collisions
+    // are ruled out by comparing the properties themselves.
+    std::size_t lhs_seed = 0;
+    hash_canonical_node_properties(lhs, lhs_seed, lhs_numbering);
+
+    std::size_t rhs_seed = 0;
+    hash_canonical_node_properties(rhs, rhs_seed, rhs_numbering);
+
+    if (lhs_seed != rhs_seed)
+        return false;
+
+    bool have_equal_properties =
+        visit<variable_ref_expr, binary_operator_expr, unary_operator_expr,
+              intrinsic_function_expr, integer_literal_expr, double_literal_expr,
+              float_literal_expr, bool_literal_expr, type_conversion_expr, for_expr,
+              compound_expr, local_variable_def_expr, member_access_expr, construct_expr,
+              macro_expr>(lhs, canonical_node_property_comparator(rhs, lhs_numbering,
+                                                                  rhs_numbering));
+
+    if (!have_equal_properties)
+        return false;
+
+    for (std::size_t i = 0; i < lhs.arity(); ++i)
+    {
+        if (!are_alpha_equivalent(lhs.child(i), lhs_numbering, rhs.child(i), rhs_numbering))
+            return false;
+    }
+
+    return true;
+}
+}
+
+bool alpha_equivalent(const expression& lhs,
+                      const std::vector<variable_declaration>& lhs_free_variables,
+                      const expression& rhs,
+                      const std::vector<variable_declaration>& rhs_free_variables)
+{
+    if (lhs_free_variables.size() != rhs_free_variables.size())
+        return false;
+
+    std::unordered_map<util::handle, std::size_t> lhs_numbers;
+    variable_numbering lhs_numbering(lhs_numbers);
+
+    std::unordered_map<util::handle, std::size_t> rhs_numbers;
+    variable_numbering rhs_numbering(rhs_numbers);
+
+    for (std::size_t i = 0; i < lhs_free_variables.size(); ++i)
+    {
+        const auto& lhs_var = lhs_free_variables[i];
+        const auto& rhs_var = rhs_free_variables[i];
+
+        if (lhs_var.var_type() != rhs_var.var_type() ||
+            lhs_numbering(lhs_var) != rhs_numbering(rhs_var))
+            return false;
+    }
+
+    return are_alpha_equivalent(lhs, lhs_numbering, rhs, rhs_numbering);
+}
+
 std::unique_ptr<expression> clone(const expression& expr)
 {
     return std::unique_ptr<expression>(expr.clone());
@@ -0,0 +1,145 @@
+#include <qubus/IR/expression_arena.hpp>
+
+#include <qubus/IR/expression.hpp>
+
+#include <qubus/util/assert.hpp>
+#include <qubus/util/unused.hpp>
+
+#include <exception>
+#include <iostream>
+#include <new>
+
+namespace qubus
+{
+
+namespace
+{
+thread_local expression_arena* current_arena = nullptr;
+
+constexpr std::size_t round_up_to_alignment(std::size_t size)
+{
+    return (size + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) *
+           alignof(std::max_align_t);
+}
+
+// Every expression is preceded by a header recording the arena which owns its memory.
+// Expressions allocated outside of any arena record a null pointer.
+struct allocation_header
+{
+    expression_arena* arena;
+};
+
+constexpr std::size_t header_size = round_up_to_alignment(sizeof(allocation_header));
+}
+
+expression_arena::expression_arena(std::size_t block_size_) : block_size_(block_size_)
+{
+}
+
+expression_arena::~expression_arena()
+{
+    // Expressions which are still alive would refer to released memory. This is a bug in the
+    // caller which has to be detected in release builds, too.
+    if (number_of_live_expressions_ != 0)
+    {
+        std::cerr << "Destroying an expression arena with " << number_of_live_expressions_
+                  << " live expressions. Expressions which outlive the arena have to be cloned "
+                     "while the arena is inactive.\n";
+
+        std::terminate();
+    }
+}
+
+std::size_t expression_arena::number_of_live_expressions() const
+{
+    return number_of_live_expressions_;
+}
+
+void* expression_arena::allocate(std::size_t size)
+{
+    size = round_up_to_alignment(size);
+
+    if (size > block_size_)
+    {
+        // Oversized allocations get a block of their own. The current block stays in use.
+        blocks_.insert(blocks_.begin(), std::unique_ptr<char[]>(new char[size]));
+
+        ++number_of_live_expressions_;
+
+        return blocks_.front().get();
+    }
+
+    if (static_cast<std::size_t>(end_ - next_) < size)
+    {
+        blocks_.push_back(std::unique_ptr<char[]>(new char[block_size_]));
+
+        next_ = blocks_.back().get();
+        end_ = next_ + block_size_;
+    }
+
+    auto memory = next_;
+    next_ += size;
+
+    ++number_of_live_expressions_;
+
+    return memory;
+}
+
+void expression_arena::deallocate(void* QUBUS_UNUSED(ptr))
+{
+    QUBUS_ASSERT(number_of_live_expressions_ > 0, "Deallocating an unknown expression.");
+
+    --number_of_live_expressions_;
+}
+
+expression_arena_scope::expression_arena_scope(expression_arena& arena)
+: previous_arena_(current_arena)
+{
+    current_arena = &arena;
+}
+
+expression_arena_scope::~expression_arena_scope()
+{
+    current_arena = previous_arena_;
+}
+
+expression_arena_suspension::expression_arena_suspension() : suspended_arena_(current_arena)
+{
+    current_arena = nullptr;
+}
+
+expression_arena_suspension::~expression_arena_suspension()
+{
+    current_arena = suspended_arena_;
+}
+
+void* expression::operator new(std::size_t size)
+{
+    auto arena = current_arena;
+
+    void* memory = arena ? arena->allocate(header_size + size) : ::operator new(header_size + size);
+
+    new (memory) allocation_header{arena};
+
+    return static_cast<char*>(memory) + header_size;
+}
+
+void expression::operator delete(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    auto memory = static_cast<char*>(ptr) - header_size;
+
+    auto arena = static_cast<allocation_header*>(static_cast<void*>(memory))->arena;
+
+    if (arena)
+    {
+        arena->deallocate(memory);
+    }
+    else
+    {
+        ::operator delete(memory);
+    }
+}
+}
@@ -102,6 +102,19 @@ std::size_t for_expr::arity() const
     return 4;
 }
 
+std::vector<std::unique_ptr<expression>> for_expr::release_children()
+{
+    std::vector<std::unique_ptr<expression>> children;
+    children.reserve(4);
+
+    children.push_back(std::move(lower_bound_));
+    children.push_back(std::move(upper_bound_));
+    children.push_back(std::move(increment_));
+    children.push_back(std::move(body_));
+
+    return children;
+}
+
 std::unique_ptr<expression>
 for_expr::substitute_subexpressions(std::vector<std::unique_ptr<expression>> new_children) const
 {
@@ -65,6 +65,11 @@ void function::substitute_body(std::unique_ptr<expression> body)
     body_ = std::move(body);
 }
 
+std::unique_ptr<expression> function::release_body()
+{
+    return std::move(body_);
+}
+
 annotation_map& function::annotations() const
 {
     return annotations_;
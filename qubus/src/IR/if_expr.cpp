@@ -93,6 +93,22 @@ std::size_t if_expr::arity() const
     }
 }
 
+std::vector<std::unique_ptr<expression>> if_expr::release_children()
+{
+    std::vector<std::unique_ptr<expression>> children;
+    children.reserve(3);
+
+    children.push_back(std::move(condition_));
+    children.push_back(std::move(then_branch_));
+
+    if (else_branch_)
+    {
+        children.push_back(std::move(*else_branch_));
+    }
+
+    return children;
+}
+
 std::unique_ptr<expression>
 if_expr::substitute_subexpressions(std::vector<std::unique_ptr<expression>> new_children) const
 {
@@ -61,6 +61,18 @@ std::size_t integer_range_expr::arity() const
     return 3;
 }
 
+std::vector<std::unique_ptr<expression>> integer_range_expr::release_children()
+{
+    std::vector<std::unique_ptr<expression>> children;
+    children.reserve(3);
+
+    children.push_back(std::move(lower_bound_));
+    children.push_back(std::move(upper_bound_));
+    children.push_back(std::move(stride_));
+
+    return children;
+}
+
 std::unique_ptr<expression> integer_range_expr::substitute_subexpressions(
     std::vector<std::unique_ptr<expression>> new_children) const
 {
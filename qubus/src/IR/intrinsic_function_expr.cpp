@@ -31,6 +31,11 @@ std::size_t intrinsic_function_expr::arity() const
     return args_.size();
 }
 
+std::vector<std::unique_ptr<expression>> intrinsic_function_expr::release_children()
+{
+    return std::move(args_);
+}
+
 std::unique_ptr<expression> intrinsic_function_expr::substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const
 {
@@ -30,6 +30,11 @@ std::size_t double_literal_expr::arity() const
     return 0;
 }
 
+std::vector<std::unique_ptr<expression>> double_literal_expr::release_children()
+{
+    return {};
+}
+
 std::unique_ptr<expression> double_literal_expr::substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const
 {
@@ -73,6 +78,11 @@ std::size_t float_literal_expr::arity() const
     return 0;
 }
 
+std::vector<std::unique_ptr<expression>> float_literal_expr::release_children()
+{
+    return {};
+}
+
 std::unique_ptr<expression> float_literal_expr::substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const
 {
@@ -116,6 +126,11 @@ std::size_t integer_literal_expr::arity() const
     return 0;
 }
 
+std::vector<std::unique_ptr<expression>> integer_literal_expr::release_children()
+{
+    return {};
+}
+
 std::unique_ptr<expression> integer_literal_expr::substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const
 {
@@ -159,6 +174,11 @@ std::size_t bool_literal_expr::arity() const
     return 0;
 }
 
+std::vector<std::unique_ptr<expression>> bool_literal_expr::release_children()
+{
+    return {};
+}
+
 std::unique_ptr<expression> bool_literal_expr::substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const
 {
@@ -45,6 +45,14 @@ std::size_t local_variable_def_expr::arity() const
     return 1;
 }
 
+std::vector<std::unique_ptr<expression>> local_variable_def_expr::release_children()
+{
+    std::vector<std::unique_ptr<expression>> children;
+    children.push_back(std::move(initializer_));
+
+    return children;
+}
+
 std::unique_ptr<expression> local_variable_def_expr::substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const
 {
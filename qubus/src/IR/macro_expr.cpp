@@ -46,6 +46,14 @@ std::size_t macro_expr::arity() const
     return 1;
 }
 
+std::vector<std::unique_ptr<expression>> macro_expr::release_children()
+{
+    std::vector<std::unique_ptr<expression>> children;
+    children.push_back(std::move(body_));
+
+    return children;
+}
+
 std::unique_ptr<expression> macro_expr::substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const
 {
@@ -85,7 +93,7 @@ std::unique_ptr<expression> expand_macro(const macro_expr& macro, std::vector<st
                         }
                     );
                     
-        body = pattern::substitute(*body, m);
+        body = pattern::substitute(std::move(body), m);
     }
     
     return body;
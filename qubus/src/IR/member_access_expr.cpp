@@ -49,6 +49,14 @@ std::size_t member_access_expr::arity() const
     return 1;
 }
 
+std::vector<std::unique_ptr<expression>> member_access_expr::release_children()
+{
+    std::vector<std::unique_ptr<expression>> children;
+    children.push_back(std::move(object_));
+
+    return children;
+}
+
 std::unique_ptr<expression> member_access_expr::substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const
 {
@@ -1,7 +1,9 @@
 #include <qubus/IR/module.hpp>
 
+#include <qubus/IR/binary_format.hpp>
 #include <qubus/IR/pretty_printer.hpp>
-#include <qubus/IR/parsing.hpp>
+
+#include <vector>
 
 namespace qubus
 {
@@ -75,6 +77,25 @@ void module::add_type(types::struct_ user_defined_type)
         throw duplicate_symbol_error(id(), type_id);
 }
 
+void module::set_pragma(std::string name, std::string value)
+{
+    pragmas_[std::move(name)] = std::move(value);
+}
+
+util::optional_ref<const std::string> module::lookup_pragma(const std::string& name) const
+{
+    auto search_result = pragmas_.find(name);
+
+    if (search_result != pragmas_.end())
+    {
+        return search_result->second;
+    }
+    else
+    {
+        return {};
+    }
+}
+
 void module::dump(std::ostream& out) const
 {
     auto serialized_code = pretty_print(*this);
@@ -90,26 +111,16 @@ void module::dump(std::ostream& out) const
 
 void module::save(hpx::serialization::output_archive& ar, unsigned QUBUS_UNUSED(version)) const
 {
-    auto serialized_code = pretty_print(*this);
-
-    auto target = carrot::get_file_target();
-
-    carrot::plain_form form(target);
-
-    carrot::render(serialized_code, form);
-
-    ar & form.to_string();
+    ar & encode_binary_qir(*this);
 }
 
 void module::load(hpx::serialization::input_archive& ar, unsigned QUBUS_UNUSED(version))
 {
-    std::string code;
+    std::vector<char> code;
 
     ar & code;
 
-    auto parsed_code = parse_qir(code);
-
-    *this = std::move(*parsed_code);
+    *this = std::move(*decode_binary_qir(code));
 }
 
 void load_construct_data(hpx::serialization::input_archive& ar, module* mod, unsigned QUBUS_UNUSED(version))
@@ -132,6 +143,11 @@ std::unique_ptr<module> clone(const module& other)
         new_module->add_type(type);
     }
 
+    for (const auto& pragma : other.pragmas())
+    {
+        new_module->set_pragma(pragma.first, pragma.second);
+    }
+
     return new_module;
 }
 }
\ No newline at end of file
@@ -77,18 +77,20 @@ struct parameterized_type : x3::position_tagged
 
 struct variable;
 struct binary_operator;
+struct operation_sequence;
 struct unary_operator;
 struct qualified_expr;
 struct if_expr;
 struct for_expr;
 struct let_expr;
-struct integer_range;
+struct non_task_expr;
 struct function_call;
 
 struct expression : x3::variant<x3::forward_ast<variable>, x3::forward_ast<binary_operator>,
+                                x3::forward_ast<operation_sequence>,
                                 x3::forward_ast<unary_operator>, x3::forward_ast<qualified_expr>,
                                 x3::forward_ast<if_expr>, x3::forward_ast<for_expr>,
-                                x3::forward_ast<let_expr>, x3::forward_ast<integer_range>,
+                                x3::forward_ast<let_expr>, x3::forward_ast<non_task_expr>,
                                 x3::forward_ast<function_call>, util::index_t, double, bool>
 {
     // workaround for GCC <= 7
@@ -120,6 +122,20 @@ struct binary_operator : x3::position_tagged
     expression rhs;
 };
 
+struct operation : x3::position_tagged
+{
+    std::string operator_id;
+    expression operand;
+};
+
+/** \brief A sequence of binary operations whose precedences have not been resolved yet.
+ */
+struct operation_sequence : x3::position_tagged
+{
+    expression first_operand;
+    std::vector<operation> operations;
+};
+
 struct unary_operator : x3::position_tagged
 {
     std::string operator_id;
@@ -171,11 +187,27 @@ struct if_expr : x3::position_tagged
     boost::optional<expression_block> else_branch;
 };
 
+/** \brief The bounds of an integer range following its lower bound.
+ *
+ * Ranges are written as lower:upper or lower:stride:upper, i.e. the first bound is the stride
+ * if a second bound is present and the upper bound otherwise.
+ */
+struct range_bounds : x3::position_tagged
+{
+    expression first_bound;
+    boost::optional<expression> second_bound;
+};
+
 struct integer_range : x3::position_tagged
 {
     expression lower_bound;
-    expression stride;
-    expression upper_bound;
+    range_bounds bounds;
+};
+
+struct non_task_expr : x3::position_tagged
+{
+    expression expr;
+    boost::optional<range_bounds> bounds;
 };
 
 struct variable_declaration : x3::position_tagged
@@ -248,6 +280,11 @@ BOOST_FUSION_ADAPT_STRUCT(qubus::ast::variable, (std::string, name));
 BOOST_FUSION_ADAPT_STRUCT(qubus::ast::binary_operator,
                           (qubus::ast::expression, lhs)(std::string,
                                                         operator_id)(qubus::ast::expression, rhs));
+BOOST_FUSION_ADAPT_STRUCT(qubus::ast::operation,
+                          (std::string, operator_id)(qubus::ast::expression, operand));
+BOOST_FUSION_ADAPT_STRUCT(qubus::ast::operation_sequence,
+                          (qubus::ast::expression,
+                           first_operand)(std::vector<qubus::ast::operation>, operations));
 BOOST_FUSION_ADAPT_STRUCT(qubus::ast::unary_operator,
                           (std::string, operator_id)(qubus::ast::expression, arg));
 BOOST_FUSION_ADAPT_STRUCT(qubus::ast::subscription, (std::vector<qubus::ast::expression>, indices));
@@ -271,10 +308,14 @@ BOOST_FUSION_ADAPT_STRUCT(qubus::ast::for_expr,
 BOOST_FUSION_ADAPT_STRUCT(qubus::ast::let_expr, (qubus::ast::variable_declaration,
                                                  var)(qubus::ast::expression, initializer));
 
+BOOST_FUSION_ADAPT_STRUCT(qubus::ast::range_bounds,
+                          (qubus::ast::expression,
+                           first_bound)(boost::optional<qubus::ast::expression>, second_bound));
 BOOST_FUSION_ADAPT_STRUCT(qubus::ast::integer_range,
-                          (qubus::ast::expression, lower_bound)(qubus::ast::expression,
-                                                                stride)(qubus::ast::expression,
-                                                                        upper_bound));
+                          (qubus::ast::expression, lower_bound)(qubus::ast::range_bounds, bounds));
+BOOST_FUSION_ADAPT_STRUCT(qubus::ast::non_task_expr,
+                          (qubus::ast::expression,
+                           expr)(boost::optional<qubus::ast::range_bounds>, bounds));
 
 BOOST_FUSION_ADAPT_STRUCT(qubus::ast::module,
                           (std::string, id)(std::vector<qubus::ast::definition>, definitions));
@@ -319,15 +360,10 @@ class expression;
 x3::rule<expression, ast::expression> expression = "expression";
 x3::rule<class variable, ast::variable> variable = "variable";
 x3::rule<class assignment, ast::binary_operator> assignment = "assignment";
-x3::rule<class non_task_expr, ast::expression> non_task_expr = "non_task_expr";
-x3::rule<class logical_expr, ast::binary_operator> logical_expr = "logical_expr";
-x3::rule<class logical_expressions, ast::expression> logical_expressions = "logical_expressions";
-x3::rule<class comparison, ast::binary_operator> comparison = "comparison";
-x3::rule<class comparisons, ast::expression> comparisons = "comparisons";
-x3::rule<class addition, ast::binary_operator> addition = "addition";
-x3::rule<class additions, ast::expression> additions = "additions";
-x3::rule<class multiplication, ast::binary_operator> multiplication = "multiplication";
-x3::rule<class multiplications, ast::expression> multiplications = "multiplications";
+x3::rule<class non_task_expr, ast::non_task_expr> non_task_expr = "non_task_expr";
+x3::rule<class operation, ast::operation> operation = "operation";
+x3::rule<class operation_sequence, ast::operation_sequence> operation_sequence =
+    "operation_sequence";
 x3::rule<class qualified_expr, ast::qualified_expr> qualified_expr = "qualified_expr";
 x3::rule<class base_expression, ast::expression> base_expression = "base_expression";
 x3::rule<class function_call, ast::function_call> function_call = "function_call";
@@ -342,18 +378,35 @@ x3::rule<for_expr, ast::for_expr> for_expr = "for_expr";
 x3::rule<class let_expr, ast::let_expr> let_expr = "let_expr";
 
 x3::rule<class integer_range, ast::integer_range> integer_range = "integer_range";
+x3::rule<class range_bounds, ast::range_bounds> range_bounds = "range_bounds";
+x3::rule<class range_bound, ast::expression> range_bound = "range_bound";
+
+// Keywords and word operators must not be followed by further identifier characters. Otherwise,
+// identifiers like "format" would be split into a keyword and a remainder.
+auto kw(const char* name)
+{
+    return x3::lexeme[x3::lit(name) >> !(x3::ascii::alnum | '_')];
+}
+
+auto word_op(const char* name)
+{
+    return x3::lexeme[x3::string(name) >> !(x3::ascii::alnum | '_')];
+}
 
-const auto keyword = x3::lit("for") | x3::lit("if") | x3::lit("else") | x3::lit("end") |
-                     x3::lit("module") | x3::lit("struct") | x3::lit("function") | x3::lit("let") |
-                     x3::lit("parallel") | x3::lit("unordered") | x3::lit("true") |
-                     x3::lit("false");
+const auto keyword = kw("for") | kw("if") | kw("else") | kw("end") | kw("module") | kw("struct") |
+                     kw("function") | kw("let") | kw("parallel") | kw("unordered") | kw("true") |
+                     kw("false");
 
 const auto id_def = x3::raw[x3::lexeme[x3::ascii::alpha >> *(x3::ascii::alnum | '_')]] - keyword;
-const auto boolean = "true" >> x3::attr(true) | "false" >> x3::attr(false);
+const auto boolean = kw("true") >> x3::attr(true) | kw("false") >> x3::attr(false);
 const auto strict_double = x3::real_parser<double, x3::strict_real_policies<double>>();
 const auto literal = strict_double | x3::long_ | boolean;
-const auto integer_range_def = logical_expressions >> ':' >>
-                               (logical_expressions >> ':' | x3::attr(1l)) >> logical_expressions;
+
+// The stride and the upper bound are only told apart after both have been parsed, which
+// avoids parsing the same bound twice.
+const auto range_bound_def = operation_sequence;
+const auto range_bounds_def = range_bound >> -(':' >> range_bound);
+const auto integer_range_def = operation_sequence >> ':' >> range_bounds;
 
 const auto type_parameter = type | x3::long_;
 const auto basic_type_def = id;
@@ -362,71 +415,63 @@ const auto type_def = parameterized_type | basic_type;
 
 const auto variable_declaration_def = id >> ("::" > type);
 
-const auto module_def = "module" > id > *definition;
+const auto module_def = kw("module") > id > *definition;
 const auto definition_def = function | user_defined_type;
-const auto function_def = "function" > id > '(' > -(variable_declaration % ',') > ')' >
-                          "->" > variable_declaration > expression_block > "end";
+const auto function_def = kw("function") > id > '(' > -(variable_declaration % ',') > ')' >
+                          "->" > variable_declaration > expression_block > kw("end");
 const auto user_defined_type_def = struct_definition;
-const auto struct_definition_def = "struct" > id > *variable_declaration > "end";
+const auto struct_definition_def = kw("struct") > id > *variable_declaration > kw("end");
 
 const auto expression_block_def = *expression >> x3::attr(false);
 const auto expression_def = if_expr | for_expr | let_expr | assignment;
 const auto variable_def = id;
 
-const auto multiplication_op = x3::string("*") | x3::string("/") | x3::string("%");
-const auto multiplication_def = unary_operators >> multiplication_op >> multiplications;
-const auto multiplications_def = multiplication | unary_operators;
-
-const auto addition_op = x3::string("+") | x3::string("-");
-const auto addition_def = multiplications >> addition_op >> additions;
-const auto additions_def = addition | multiplications;
+// All binary operators are parsed into a flat sequence of operations, whose precedences are
+// resolved during the semantic analysis. In contrast to a rule per precedence level, this
+// does not need to parse an operand again if it is not followed by an operator.
+const auto binary_op = x3::string("*") | x3::string("/") | x3::string("%") |
+                       x3::string("+") >> !x3::lit('=') | x3::string("-") | x3::string("==") |
+                       x3::string("!=") | x3::string("<=") | x3::string(">=") | x3::string("<") |
+                       x3::string(">") | word_op("and") | word_op("or");
+const auto operation_def = binary_op >> unary_operators;
+const auto operation_sequence_def = unary_operators >> *operation;
 
-const auto comparison_op = x3::string("==") | x3::string("!=") | x3::string("<") | x3::string(">") |
-                           x3::string("<=") | x3::string(">=");
-const auto comparison_def = additions >> comparison_op >> comparisons;
-const auto comparisons_def = comparison | additions;
-
-const auto logical_op = x3::string("and") | x3::string("or");
-const auto logical_expr_def = comparisons >> logical_op >> logical_expressions;
-const auto logical_expressions_def = logical_expr | comparisons;
-
-const auto non_task_expr_def = integer_range | logical_expressions;
+const auto non_task_expr_def = operation_sequence >> -(':' >> range_bounds);
 
 const auto assignment_op = x3::string("=") | x3::string("+=");
 const auto assignment_def = non_task_expr >> assignment_op > non_task_expr;
 
-const auto unary_op = x3::string("+") | x3::string("-") | x3::string("not");
+const auto unary_op = x3::string("+") | x3::string("-") | word_op("not");
 const auto unary_operator_def = unary_op >> unary_operators;
 const auto unary_operators_def = unary_operator | qualified_expr;
 
-const auto subscription_def = '[' >> -(non_task_expr % ',') >> ']';
-const auto member_access_def = '.' >> id;
+const auto subscription_def = '[' > -(non_task_expr % ',') > ']';
+const auto member_access_def = '.' > id;
 
 const auto qualified_expr_def = base_expression >> *(subscription | member_access);
 
-const auto function_call_def = id >> '(' >> non_task_expr % ',' >> ')';
+const auto function_call_def = id >> '(' > non_task_expr % ',' > ')';
 
-const auto base_expression_def = '(' >> non_task_expr >> ')' | function_call | variable | literal;
+const auto base_expression_def = '(' > non_task_expr > ')' | function_call | variable | literal;
 
-const auto if_expr_def = "if" > non_task_expr > expression_block > -("else" > expression_block) >
-                         "end";
+const auto if_expr_def = kw("if") > non_task_expr > expression_block >
+                         -(kw("else") > expression_block) > kw("end");
 
-const auto ordering =
-    x3::string("parallel") | x3::string("unordered") | x3::attr(std::string("sequential"));
-const auto for_expr_def =
-    ordering >> "for" > variable_declaration > "in" > integer_range > expression_block > "end";
+const auto ordering = word_op("parallel") | word_op("unordered") |
+                      x3::attr(std::string("sequential"));
+const auto for_expr_def = ordering >> kw("for") > variable_declaration > kw("in") >
+                          integer_range > expression_block > kw("end");
 
-const auto let_expr_def = "let" > variable_declaration > '=' > non_task_expr;
+const auto let_expr_def = kw("let") > variable_declaration > '=' > non_task_expr;
 
 const auto skipper = x3::ascii::space;
 
 BOOST_SPIRIT_DEFINE(id, module, definition, function, expression_block, user_defined_type,
                     struct_definition, variable_declaration, type, parameterized_type, basic_type,
-                    expression, variable, assignment, non_task_expr, logical_expr,
-                    logical_expressions, comparison, comparisons, addition, additions,
-                    multiplication, multiplications, qualified_expr, base_expression,
-                    unary_operator, unary_operators, subscription, member_access, if_expr, for_expr,
-                    integer_range, let_expr, function_call);
+                    expression, variable, assignment, non_task_expr, operation,
+                    operation_sequence, qualified_expr, base_expression, unary_operator,
+                    unary_operators, subscription, member_access, if_expr, for_expr, integer_range,
+                    range_bounds, range_bound, let_expr, function_call);
 } // namespace grammar
 
 class type_analyzer
@@ -597,6 +642,74 @@ private:
     symbol_table* sym_table_;
 };
 
+binary_op_tag translate_binary_operator(const std::string& operator_id)
+{
+    if (operator_id == "=")
+        return binary_op_tag::assign;
+
+    if (operator_id == "+=")
+        return binary_op_tag::plus_assign;
+
+    if (operator_id == "+")
+        return binary_op_tag::plus;
+
+    if (operator_id == "-")
+        return binary_op_tag::minus;
+
+    if (operator_id == "*")
+        return binary_op_tag::multiplies;
+
+    if (operator_id == "/")
+        return binary_op_tag::divides;
+
+    if (operator_id == "%")
+        return binary_op_tag::modulus;
+
+    if (operator_id == "==")
+        return binary_op_tag::equal_to;
+
+    if (operator_id == "!=")
+        return binary_op_tag::not_equal_to;
+
+    if (operator_id == "<")
+        return binary_op_tag::less;
+
+    if (operator_id == "<=")
+        return binary_op_tag::less_equal;
+
+    if (operator_id == ">")
+        return binary_op_tag::greater;
+
+    if (operator_id == ">=")
+        return binary_op_tag::greater_equal;
+
+    if (operator_id == "and")
+        return binary_op_tag::logical_and;
+
+    if (operator_id == "or")
+        return binary_op_tag::logical_or;
+
+    QUBUS_UNREACHABLE();
+}
+
+int binary_operator_precedence(const std::string& operator_id)
+{
+    if (operator_id == "*" || operator_id == "/" || operator_id == "%")
+        return 3;
+
+    if (operator_id == "+" || operator_id == "-")
+        return 2;
+
+    if (operator_id == "==" || operator_id == "!=" || operator_id == "<" || operator_id == "<=" ||
+        operator_id == ">" || operator_id == ">=")
+        return 1;
+
+    if (operator_id == "and" || operator_id == "or")
+        return 0;
+
+    QUBUS_UNREACHABLE();
+}
+
 class expression_analyzer;
 
 std::unique_ptr<expression> analyze_expression_block(const ast::expression_block& block,
@@ -643,68 +756,19 @@ public:
         auto lhs = op.lhs.apply_visitor(*this);
         auto rhs = op.rhs.apply_visitor(*this);
 
-        if (op.operator_id == "=")
-        {
-            return binary_operator(binary_op_tag::assign, std::move(lhs), std::move(rhs));
-        }
-        else if (op.operator_id == "+=")
-        {
-            return binary_operator(binary_op_tag::plus_assign, std::move(lhs), std::move(rhs));
-        }
-        else if (op.operator_id == "+")
-        {
-            return binary_operator(binary_op_tag::plus, std::move(lhs), std::move(rhs));
-        }
-        else if (op.operator_id == "-")
-        {
-            return binary_operator(binary_op_tag::minus, std::move(lhs), std::move(rhs));
-        }
-        else if (op.operator_id == "*")
-        {
-            return binary_operator(binary_op_tag::multiplies, std::move(lhs), std::move(rhs));
-        }
-        else if (op.operator_id == "/")
-        {
-            return binary_operator(binary_op_tag::divides, std::move(lhs), std::move(rhs));
-        }
-        else if (op.operator_id == "%")
-        {
-            return binary_operator(binary_op_tag::modulus, std::move(lhs), std::move(rhs));
-        }
-        else if (op.operator_id == "==")
-        {
-            return binary_operator(binary_op_tag::equal_to, std::move(lhs), std::move(rhs));
-        }
-        else if (op.operator_id == "!=")
-        {
-            return binary_operator(binary_op_tag::not_equal_to, std::move(lhs), std::move(rhs));
-        }
-        else if (op.operator_id == "<")
-        {
-            return binary_operator(binary_op_tag::less, std::move(lhs), std::move(rhs));
-        }
-        else if (op.operator_id == "<=")
-        {
-            return binary_operator(binary_op_tag::less_equal, std::move(lhs), std::move(rhs));
-        }
-        else if (op.operator_id == ">")
-        {
-            return binary_operator(binary_op_tag::greater, std::move(lhs), std::move(rhs));
-        }
-        else if (op.operator_id == ">=")
-        {
-            return binary_operator(binary_op_tag::greater_equal, std::move(lhs), std::move(rhs));
-        }
-        else if (op.operator_id == "and")
-        {
-            return binary_operator(binary_op_tag::logical_and, std::move(lhs), std::move(rhs));
-        }
-        else if (op.operator_id == "or")
-        {
-            return binary_operator(binary_op_tag::logical_or, std::move(lhs), std::move(rhs));
-        }
+        return binary_operator(translate_binary_operator(op.operator_id), std::move(lhs),
+                               std::move(rhs));
+    }
 
-        QUBUS_UNREACHABLE();
+    result_type operator()(const ast::operation_sequence& seq)
+    {
+        QUBUS_ASSERT(sym_table_ != nullptr, "expression_analyzer has not been initialized.");
+
+        auto first_operand = seq.first_operand.apply_visitor(*this);
+
+        std::size_t pos = 0;
+
+        return analyze_operations(seq.operations, pos, std::move(first_operand), 0);
     }
 
     result_type operator()(const ast::unary_operator& op)
@@ -785,8 +849,7 @@ public:
         auto loop_index = sym_table_->create_variable(expr.loop_index);
 
         auto lower_bound = expr.range.lower_bound.apply_visitor(*this);
-        auto upper_bound = expr.range.upper_bound.apply_visitor(*this);
-        auto increment = expr.range.stride.apply_visitor(*this);
+        auto [upper_bound, increment] = analyze_range_bounds(expr.range.bounds);
 
         auto body = analyze_expression_block(expr.body, *this);
 
@@ -849,18 +912,68 @@ public:
         return lit(value);
     }
 
-    result_type operator()(const ast::integer_range& expr)
+    result_type operator()(const ast::non_task_expr& expr)
     {
         QUBUS_ASSERT(sym_table_ != nullptr, "expression_analyzer has not been initialized.");
 
-        auto lower_bound = expr.lower_bound.apply_visitor(*this);
-        auto upper_bound = expr.upper_bound.apply_visitor(*this);
-        auto stride = expr.stride.apply_visitor(*this);
+        auto value = expr.expr.apply_visitor(*this);
+
+        if (!expr.bounds)
+            return value;
 
-        return range(std::move(lower_bound), std::move(upper_bound), std::move(stride));
+        auto [upper_bound, stride] = analyze_range_bounds(*expr.bounds);
+
+        return range(std::move(value), std::move(upper_bound), std::move(stride));
     }
 
 private:
+    /** \brief Returns the upper bound and the stride of a range.
+     */
+    std::pair<result_type, result_type> analyze_range_bounds(const ast::range_bounds& bounds)
+    {
+        auto first_bound = bounds.first_bound.apply_visitor(*this);
+
+        if (bounds.second_bound)
+        {
+            auto upper_bound = bounds.second_bound->apply_visitor(*this);
+
+            return {std::move(upper_bound), std::move(first_bound)};
+        }
+
+        return {std::move(first_bound), integer_literal(1)};
+    }
+
+    /** \brief Combines the operations starting at pos with lhs using precedence climbing.
+     *
+     * All consecutive operations with a precedence of at least min_precedence are consumed.
+     * Operators with the same precedence are left-associative.
+     */
+    result_type analyze_operations(const std::vector<ast::operation>& operations, std::size_t& pos,
+                                   result_type lhs, int min_precedence)
+    {
+        while (pos < operations.size() &&
+               binary_operator_precedence(operations[pos].operator_id) >= min_precedence)
+        {
+            const auto& op = operations[pos];
+            ++pos;
+
+            auto precedence = binary_operator_precedence(op.operator_id);
+
+            auto rhs = op.operand.apply_visitor(*this);
+
+            while (pos < operations.size() &&
+                   binary_operator_precedence(operations[pos].operator_id) > precedence)
+            {
+                rhs = analyze_operations(operations, pos, std::move(rhs), precedence + 1);
+            }
+
+            lhs = binary_operator(translate_binary_operator(op.operator_id), std::move(lhs),
+                                  std::move(rhs));
+        }
+
+        return lhs;
+    }
+
     symbol_table* sym_table_;
 };
 
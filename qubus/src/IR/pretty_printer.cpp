@@ -41,6 +41,13 @@ enum class precedence_level
     qualifier = 7
 };
 
+/** \brief Returns the precedence level which binds one step tighter than the given one.
+ */
+precedence_level next_precedence_level(precedence_level level)
+{
+    return static_cast<precedence_level>(static_cast<int>(level) + 1);
+}
+
 const char* translate_binary_op_tag(binary_op_tag tag)
 {
     switch (tag)
@@ -223,9 +230,12 @@ carrot::block print(const expression& expr, precedence_level prec_level)
                    [&] {
                        auto new_prec_level = get_op_precedence_level(btag.get());
 
+                       // Binary operators are left-associative. Hence, a right operand with
+                       // the same precedence, as in a - (b - c), has to be bracketed.
                        return bracket(print(a.get(), new_prec_level)
                                           << text(" ") << text(translate_binary_op_tag(btag.get()))
-                                          << text(" ") << print(b.get(), new_prec_level),
+                                          << text(" ")
+                                          << print(b.get(), next_precedence_level(new_prec_level)),
                                       new_prec_level < prec_level);
                    })
             .case_(unary_operator(utag, a),
@@ -41,6 +41,21 @@ std::size_t subscription_expr::arity() const
     return indices_.size() + 1;
 }
 
+std::vector<std::unique_ptr<expression>> subscription_expr::release_children()
+{
+    std::vector<std::unique_ptr<expression>> children;
+    children.reserve(indices_.size() + 1);
+
+    children.push_back(std::move(indexed_expr_));
+
+    for (auto& index : indices_)
+    {
+        children.push_back(std::move(index));
+    }
+
+    return children;
+}
+
 std::unique_ptr<expression> subscription_expr::substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const
 {
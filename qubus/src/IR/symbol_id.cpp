@@ -1,84 +1,146 @@
 #include <qubus/IR/symbol_id.hpp>
 
-#include <boost/range/adaptor/sliced.hpp>
+#include <hpx/include/local_lcos.hpp>
+
 #include <boost/spirit/home/qi.hpp>
 
 #include <qubus/util/assert.hpp>
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 namespace qubus
 {
-symbol_id::symbol_id(const std::string& id)
+namespace
 {
-    namespace qi = boost::spirit::qi;
-    using qi::ascii::alpha;
-    using qi::ascii::alnum;
+struct components_hash
+{
+    std::size_t operator()(const std::vector<std::string>& components) const noexcept
+    {
+        std::size_t seed = 0;
 
-    auto first = id.cbegin();
-    auto last = id.cend();
+        for (const auto& component : components)
+        {
+            util::hash_combine(seed, std::string_view(component));
+        }
 
-    using iterator_type = decltype(first);
+        return seed;
+    }
+};
 
-    qi::rule<iterator_type, std::string()> qubus_id;
-    qubus_id %= qi::raw[alpha >> *(alnum | '_')];
+std::string join_components(const std::vector<std::string>& components)
+{
+    std::string result;
 
-    bool r = qi::parse(first, last, qubus_id % '.', this->components_);
+    for (auto iter = components.begin(), last = components.end(); iter != last; ++iter)
+    {
+        result += *iter;
 
-    if (!r || first != last)
-        throw symbol_id_parsing_error("Unable to parse symbol id.");
-}
+        if (iter != last - 1)
+        {
+            result += '.';
+        }
+    }
 
-symbol_id::symbol_id(std::vector<std::string> components_)
-: components_(std::move(components_))
-{
+    return result;
 }
 
-symbol_id symbol_id::get_prefix() const
+const detail::symbol_id_entry* intern_symbol_id(std::vector<std::string> components)
 {
-    if (components_.size() < 2)
-        return symbol_id();
+    // The entries are never destroyed, since symbol ids might be stored in objects with
+    // static storage duration.
+    static auto& symbol_table =
+        *new std::unordered_map<std::vector<std::string>, std::unique_ptr<detail::symbol_id_entry>,
+                                components_hash>();
+    static hpx::lcos::local::spinlock symbol_table_mutex;
 
-    std::vector<std::string> prefix_components;
+    {
+        std::lock_guard<hpx::lcos::local::spinlock> guard(symbol_table_mutex);
 
-    for (const auto& component : components_ | boost::adaptors::sliced(0, components_.size() - 1))
+        auto iter = symbol_table.find(components);
+
+        if (iter != symbol_table.end())
+            return iter->second.get();
+    }
+
+    const detail::symbol_id_entry* prefix = nullptr;
+
+    if (!components.empty())
     {
-        prefix_components.push_back(component);
+        prefix = intern_symbol_id(
+            std::vector<std::string>(components.begin(), components.end() - 1));
     }
 
-    return symbol_id(std::move(prefix_components));
+    auto hash = components_hash()(components);
+    auto string = join_components(components);
+
+    auto entry = std::make_unique<detail::symbol_id_entry>(
+        detail::symbol_id_entry{components, std::move(string), hash, prefix});
+
+    std::lock_guard<hpx::lcos::local::spinlock> guard(symbol_table_mutex);
+
+    // Another thread might have interned the same id in the meantime, in which case
+    // its entry is kept.
+    auto result = symbol_table.emplace(std::move(components), std::move(entry));
+
+    return result.first->second.get();
 }
 
-const std::string& symbol_id::suffix() const
+const detail::symbol_id_entry* get_empty_symbol_id()
 {
-    QUBUS_ASSERT(!components_.empty(), "Symbol ID has no valid suffix.");
+    static const detail::symbol_id_entry* empty_symbol_id = intern_symbol_id({});
 
-    return components_.back();
+    return empty_symbol_id;
+}
 }
 
-std::string symbol_id::string() const
+symbol_id::symbol_id() : entry_(get_empty_symbol_id())
 {
-    std::string result;
+}
 
-    for (auto iter = components_.begin(), last = components_.end(); iter != last; ++iter)
-    {
-        result += *iter;
+symbol_id::symbol_id(const std::string& id)
+{
+    namespace qi = boost::spirit::qi;
+    using qi::ascii::alpha;
+    using qi::ascii::alnum;
 
-        if (iter != last - 1)
-        {
-            result += '.';
-        }
-    }
+    auto first = id.cbegin();
+    auto last = id.cend();
 
-    return result;
+    using iterator_type = decltype(first);
+
+    qi::rule<iterator_type, std::string()> qubus_id;
+    qubus_id %= qi::raw[alpha >> *(alnum | '_')];
+
+    std::vector<std::string> components;
+
+    bool r = qi::parse(first, last, qubus_id % '.', components);
+
+    if (!r || first != last)
+        throw symbol_id_parsing_error("Unable to parse symbol id.");
+
+    entry_ = intern_symbol_id(std::move(components));
 }
 
-bool operator==(const symbol_id& lhs, const symbol_id& rhs)
+symbol_id::symbol_id(std::vector<std::string> components_)
+: entry_(intern_symbol_id(std::move(components_)))
 {
-    return lhs.components() == rhs.components();
 }
 
-bool operator!=(const symbol_id& lhs, const symbol_id& rhs)
+symbol_id symbol_id::get_prefix() const
 {
-    return !(lhs == rhs);
+    if (!entry_->prefix)
+        return *this;
+
+    return symbol_id(entry_->prefix);
+}
+
+const std::string& symbol_id::suffix() const
+{
+    QUBUS_ASSERT(!entry_->components.empty(), "Symbol ID has no valid suffix.");
+
+    return entry_->components.back();
 }
 
 std::ostream& operator<<(std::ostream& out, const symbol_id& value)
@@ -6,8 +6,11 @@
 #include <qubus/util/hash.hpp>
 #include <qubus/util/multi_method.hpp>
 
+#include <hpx/include/local_lcos.hpp>
+
 #include <algorithm>
 #include <mutex>
+#include <unordered_map>
 
 namespace qubus
 {
@@ -15,8 +18,10 @@ namespace qubus
 namespace
 {
 
-util::sparse_multi_method<bool(const util::virtual_<type>&, const util::virtual_<type>&)> type_eq =
-    {};
+bool type_eq_unknown(const types::unknown& /*unused*/, const types::unknown& /*unused*/)
+{
+    return true;
+}
 
 bool type_eq_double(const types::double_& /*unused*/, const types::double_& /*unused*/)
 {
@@ -43,6 +48,11 @@ bool type_eq_index(const types::index& /*unused*/, const types::index& /*unused*
     return true;
 }
 
+bool type_eq_multi_index(const types::multi_index& lhs, const types::multi_index& rhs)
+{
+    return lhs.rank() == rhs.rank();
+}
+
 bool type_eq_complex(const types::complex& lhs, const types::complex& rhs)
 {
     return lhs.real_type() == rhs.real_type();
@@ -66,7 +76,7 @@ bool type_eq_array_slice(const types::array_slice& lhs, const types::array_slice
 
 bool type_eq_struct(const types::struct_& lhs, const types::struct_& rhs)
 {
-    return lhs.id() == rhs.id();
+    return lhs.id() == rhs.id() && lhs.members() == rhs.members();
 }
 
 bool type_eq_default(const type& /*unused*/, const type& /*unused*/)
@@ -74,35 +84,106 @@ bool type_eq_default(const type& /*unused*/, const type& /*unused*/)
     return false;
 }
 
-void init_type_eq()
-{
-    type_eq.add_specialization(type_eq_double);
-    type_eq.add_specialization(type_eq_float);
-    type_eq.add_specialization(type_eq_integer);
-    type_eq.add_specialization(type_eq_bool);
-    type_eq.add_specialization(type_eq_index);
-    type_eq.add_specialization(type_eq_complex);
-    type_eq.add_specialization(type_eq_integer_range);
-    type_eq.add_specialization(type_eq_array);
-    type_eq.add_specialization(type_eq_array_slice);
-    type_eq.add_specialization(type_eq_struct);
+using type_eq_method =
+    util::sparse_multi_method<bool(const util::virtual_<type>&, const util::virtual_<type>&)>;
 
-    type_eq.set_fallback(type_eq_default);
+// Types might already be interned during static initialization, so the multi-method is
+// initialized on first use.
+const type_eq_method& get_type_eq()
+{
+    static type_eq_method type_eq;
+    static std::once_flag type_eq_init_flag;
+
+    std::call_once(type_eq_init_flag, [] {
+        type_eq.add_specialization(type_eq_unknown);
+        type_eq.add_specialization(type_eq_double);
+        type_eq.add_specialization(type_eq_float);
+        type_eq.add_specialization(type_eq_integer);
+        type_eq.add_specialization(type_eq_bool);
+        type_eq.add_specialization(type_eq_index);
+        type_eq.add_specialization(type_eq_multi_index);
+        type_eq.add_specialization(type_eq_complex);
+        type_eq.add_specialization(type_eq_integer_range);
+        type_eq.add_specialization(type_eq_array);
+        type_eq.add_specialization(type_eq_array_slice);
+        type_eq.add_specialization(type_eq_struct);
+
+        type_eq.set_fallback(type_eq_default);
+    });
+
+    return type_eq;
 }
 
-std::once_flag type_eq_init_flag = {};
-} // namespace
-
-bool operator==(const type& lhs, const type& rhs)
+std::size_t compute_hash(const type& value)
 {
-    std::call_once(type_eq_init_flag, init_type_eq);
+    std::size_t seed = 0;
+
+    util::hash_combine(seed, value.rtti());
+
+    // All nested types are already interned, so hashing them is cheap.
+    if (auto complex_type = value.try_as<types::complex>())
+    {
+        util::hash_combine(seed, complex_type->real_type());
+    }
+    else if (auto multi_index_type = value.try_as<types::multi_index>())
+    {
+        util::hash_combine(seed, multi_index_type->rank());
+    }
+    else if (auto array_type = value.try_as<types::array>())
+    {
+        util::hash_combine(seed, array_type->value_type());
+        util::hash_combine(seed, array_type->rank());
+    }
+    else if (auto array_slice_type = value.try_as<types::array_slice>())
+    {
+        util::hash_combine(seed, array_slice_type->value_type());
+        util::hash_combine(seed, array_slice_type->rank());
+    }
+    else if (auto struct_type = value.try_as<types::struct_>())
+    {
+        util::hash_combine(seed, struct_type->id());
+
+        for (const auto& member : *struct_type)
+        {
+            util::hash_combine(seed, member);
+        }
+    }
 
-    return type_eq(lhs, rhs);
+    return seed;
 }
+} // namespace
 
-bool operator!=(const type& lhs, const type& rhs)
+const type::type_interface* type::intern(std::unique_ptr<type_interface> candidate)
 {
-    return !(lhs == rhs);
+    // The canonical types are never destroyed, since handles to them might be stored in
+    // objects with static storage duration.
+    static auto& type_table =
+        *new std::unordered_multimap<std::size_t, std::unique_ptr<const type_interface>>();
+    static hpx::lcos::local::spinlock type_table_mutex;
+
+    const auto& type_eq = get_type_eq();
+
+    const type candidate_handle(candidate.get());
+
+    auto hash = compute_hash(candidate_handle);
+
+    std::lock_guard<hpx::lcos::local::spinlock> guard(type_table_mutex);
+
+    auto candidates = type_table.equal_range(hash);
+
+    for (auto iter = candidates.first; iter != candidates.second; ++iter)
+    {
+        if (type_eq(candidate_handle, type(iter->second.get())))
+            return iter->second.get();
+    }
+
+    candidate->hash_ = hash;
+
+    const type_interface* canonical_self = candidate.get();
+
+    type_table.emplace(hash, std::move(candidate));
+
+    return canonical_self;
 }
 
 namespace types
@@ -162,73 +243,6 @@ type value_type(const type& array_like)
 
 namespace std
 {
-std::size_t hash<qubus::type>::operator()(const qubus::type& value) const noexcept
-{
-    using namespace qubus;
-    using pattern::_;
-
-    pattern::variable<type> t;
-    pattern::variable<util::index_t> rank;
-
-    auto m = pattern::make_matcher<type, std::size_t>()
-                 .case_(pattern::double_t,
-                        [&] { return std::hash<std::type_index>()(typeid(types::double_)); })
-                 .case_(pattern::float_t,
-                        [&] { return std::hash<std::type_index>()(typeid(types::float_)); })
-                 .case_(pattern::integer_t,
-                        [&] { return std::hash<std::type_index>()(typeid(types::integer)); })
-                 .case_(pattern::index_t,
-                        [&] { return std::hash<std::type_index>()(typeid(types::index)); })
-                 .case_(pattern::complex_t(t),
-                        [&] {
-                            std::size_t seed = 0;
-
-                            util::hash_combine(seed, std::type_index(typeid(types::complex)));
-                            util::hash_combine(seed, t.get());
-
-                            return seed;
-                        })
-                 .case_(pattern::integer_range_t,
-                        [&] { return std::hash<std::type_index>()(typeid(types::integer_range)); })
-                 .case_(pattern::array_t(t, rank),
-                        [&] {
-                            std::size_t seed = 0;
-
-                            util::hash_combine(seed, std::type_index(typeid(types::array)));
-                            util::hash_combine(seed, t.get());
-                            util::hash_combine(seed, rank.get());
-
-                            return seed;
-                        })
-                 .case_(pattern::array_slice_t(t, rank),
-                        [&] {
-                            std::size_t seed = 0;
-
-                            util::hash_combine(seed, std::type_index(typeid(types::array_slice)));
-                            util::hash_combine(seed, t.get());
-                            util::hash_combine(seed, rank.get());
-
-                            return seed;
-                        })
-                 .case_(pattern::struct_t(_, _), [&](const type& self) {
-                     const auto& stype = self.as<types::struct_>();
-
-                     std::size_t seed = 0;
-
-                     util::hash_combine(seed, std::type_index(typeid(types::struct_)));
-                     util::hash_combine(seed, stype.id());
-
-                     for (const auto& member : stype)
-                     {
-                         util::hash_combine(seed, member);
-                     }
-
-                     return seed;
-                 });
-
-    return pattern::match(value, m);
-}
-
 std::size_t hash<qubus::types::struct_::member>::
 operator()(const qubus::types::struct_::member& value) const noexcept
 {
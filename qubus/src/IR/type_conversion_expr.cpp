@@ -44,6 +44,14 @@ std::size_t type_conversion_expr::arity() const
     return 1;
 }
 
+std::vector<std::unique_ptr<expression>> type_conversion_expr::release_children()
+{
+    std::vector<std::unique_ptr<expression>> children;
+    children.push_back(std::move(arg_));
+
+    return children;
+}
+
 std::unique_ptr<expression> type_conversion_expr::substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const
 {
@@ -48,6 +48,14 @@ std::size_t unary_operator_expr::arity() const
     return 1;
 }
 
+std::vector<std::unique_ptr<expression>> unary_operator_expr::release_children()
+{
+    std::vector<std::unique_ptr<expression>> children;
+    children.push_back(std::move(arg_));
+
+    return children;
+}
+
 std::unique_ptr<expression> unary_operator_expr::substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const
 {
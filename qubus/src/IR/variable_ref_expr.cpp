@@ -30,6 +30,11 @@ std::size_t variable_ref_expr::arity() const
     return 0;
 }
 
+std::vector<std::unique_ptr<expression>> variable_ref_expr::release_children()
+{
+    return {};
+}
+
 std::unique_ptr<expression> variable_ref_expr::substitute_subexpressions(
         std::vector<std::unique_ptr<expression>> new_children) const
 {
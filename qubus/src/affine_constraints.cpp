@@ -46,10 +46,17 @@ public:
         return 0;
     }
 
+    std::vector<std::unique_ptr<expression>> release_children() override
+    {
+        return {};
+    }
+
     std::unique_ptr<expression>
     substitute_subexpressions(std::vector<std::unique_ptr<expression>> new_children) const override
     {
-        return {};
+        QUBUS_ASSERT(new_children.empty(), "Leaf expressions have no children.");
+
+        return std::unique_ptr<expression>(clone());
     }
 
     template <typename Archive>
@@ -136,10 +143,17 @@ public:
         return 0;
     }
 
+    std::vector<std::unique_ptr<expression>> release_children() override
+    {
+        return {};
+    }
+
     std::unique_ptr<expression>
     substitute_subexpressions(std::vector<std::unique_ptr<expression>> new_children) const override
     {
-        return {};
+        QUBUS_ASSERT(new_children.empty(), "Leaf expressions have no children.");
+
+        return std::unique_ptr<expression>(clone());
     }
 
     template <typename Archive>
@@ -226,10 +240,17 @@ public:
         return 0;
     }
 
+    std::vector<std::unique_ptr<expression>> release_children() override
+    {
+        return {};
+    }
+
     std::unique_ptr<expression>
     substitute_subexpressions(std::vector<std::unique_ptr<expression>> new_children) const override
     {
-        return {};
+        QUBUS_ASSERT(new_children.empty(), "Leaf expressions have no children.");
+
+        return std::unique_ptr<expression>(clone());
     }
 
     template <typename Archive>
@@ -406,6 +406,16 @@ basic_alias_analysis_pass::run(const expression& QUBUS_UNUSED(root),
     return basic_alias_analysis_result();
 }
 
+basic_alias_analysis_result
+basic_alias_analysis_pass::relocate(const basic_alias_analysis_result& QUBUS_UNUSED(result),
+                                    const expression_relocation& QUBUS_UNUSED(relocation),
+                                    const expression& root, analysis_manager& manager,
+                                    pass_resource_manager& resource_manager) const
+{
+    // Only the memoized queries refer to the analyzed nodes, so we can start afresh.
+    return run(root, manager, resource_manager);
+}
+
 std::vector<analysis_id> basic_alias_analysis_pass::required_analyses() const
 {
     return {};
@@ -452,6 +462,17 @@ alias_analysis_result alias_analysis_pass::run(const expression& root, analysis_
                                  resource_manager.get_isl_ctx());
 }
 
+alias_analysis_result
+alias_analysis_pass::relocate(const alias_analysis_result& QUBUS_UNUSED(result),
+                              const expression_relocation& QUBUS_UNUSED(relocation),
+                              const expression& root, analysis_manager& manager,
+                              pass_resource_manager& resource_manager) const
+{
+    // Apart from the memoized queries, the result only consists of the aliasing rules, which
+    // are bound to the analyses of root again.
+    return run(root, manager, resource_manager);
+}
+
 std::vector<analysis_id> alias_analysis_pass::required_analyses() const
 {
     return {get_analysis_id<value_set_analysis_pass>(),
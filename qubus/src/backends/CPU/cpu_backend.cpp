@@ -14,6 +14,8 @@
 #include <qubus/backends/cpu/cpu_compiler.hpp>
 
 #include <qubus/IR/qir.hpp>
+#include <qubus/logging.hpp>
+#include <qubus/loop_optimizer.hpp>
 #include <qubus/pattern/IR.hpp>
 #include <qubus/pattern/core.hpp>
 
@@ -27,11 +29,16 @@
 
 #include <hpx/include/lcos.hpp>
 #include <hpx/include/threads.hpp>
+#include <hpx/lcos/local/promise.hpp>
 
+#include <boost/interprocess/sync/file_lock.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+#include <boost/interprocess/sync/sharable_lock.hpp>
 #include <boost/optional.hpp>
 #include <boost/signals2.hpp>
 
 #include <qubus/util/assert.hpp>
+#include <qubus/util/hash.hpp>
 #include <qubus/util/make_unique.hpp>
 #include <qubus/util/optional_ref.hpp>
 #include <qubus/util/unused.hpp>
@@ -39,11 +46,17 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
 #include <functional>
+#include <iomanip>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <sstream>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -87,15 +100,234 @@ extern "C" QUBUS_EXPORT void QUBUS_cpurt_dealloc_scratch_mem(cpu_runtime* runtim
     runtime->dealloc_scratch_mem(size);
 }
 
+/** \brief Identifies the build of this backend.
+ *
+ * The keys of the autotuning database are only meaningful for the build which computed them,
+ * see compute_autotuning_key.
+ */
+std::string get_autotuning_build_stamp()
+{
+    std::size_t stamp = 0;
+
+#ifdef __VERSION__
+    util::hash_combine(stamp, std::string(__VERSION__));
+#endif
+    util::hash_combine(stamp, std::string(__DATE__ " " __TIME__));
+
+    std::ostringstream stamp_str;
+
+    stamp_str << std::hex << std::setfill('0') << std::setw(16) << stamp;
+
+    return stamp_str.str();
+}
+
+/** \brief Persistent store of the tile sizes selected by the autotuner.
+ *
+ * Each line of the underlying file contains the build stamp of the writer and the key of a
+ * kernel followed by the selected tile sizes. An empty list of tile sizes refers to the sizes
+ * derived from the cache model. Entries written by a different build are ignored.
+ *
+ * The file is shared between processes. It is only ever appended to and all accesses are
+ * protected by a file lock.
+ */
+class autotuning_database
+{
+public:
+    autotuning_database(std::string filename_, std::string build_stamp_)
+    : filename_(std::move(filename_)), build_stamp_(std::move(build_stamp_))
+    {
+        reload();
+    }
+
+    boost::optional<std::vector<util::index_t>> lookup(const std::string& key) const
+    {
+        std::lock_guard<hpx::lcos::local::mutex> guard(database_mutex_);
+
+        if (auto tile_sizes = lookup_entry(key))
+            return tile_sizes;
+
+        // Another process might have tuned the kernel in the meantime.
+        reload();
+
+        return lookup_entry(key);
+    }
+
+    void store(const std::string& key, const std::vector<util::index_t>& tile_sizes)
+    {
+        std::lock_guard<hpx::lcos::local::mutex> guard(database_mutex_);
+
+        std::ofstream db(filename_, std::ios::app);
+
+        if (!db)
+        {
+            logger slg;
+
+            QUBUS_LOG(slg, warning) << "Unable to open the autotuning database " << filename_;
+
+            entries_[key] = tile_sizes;
+
+            return;
+        }
+
+        boost::interprocess::file_lock db_lock(filename_.c_str());
+        boost::interprocess::scoped_lock<boost::interprocess::file_lock> db_guard(db_lock);
+
+        std::ostringstream entry;
+
+        entry << build_stamp_ << " " << key;
+
+        for (auto tile_size : tile_sizes)
+        {
+            entry << " " << tile_size;
+        }
+
+        entry << "\n";
+
+        // Write the entry at once such that readers never observe partial lines.
+        db << entry.str() << std::flush;
+
+        entries_[key] = tile_sizes;
+    }
+
+private:
+    boost::optional<std::vector<util::index_t>> lookup_entry(const std::string& key) const
+    {
+        auto search_result = entries_.find(key);
+
+        if (search_result != entries_.end())
+        {
+            return search_result->second;
+        }
+        else
+        {
+            return boost::none;
+        }
+    }
+
+    void reload() const
+    {
+        std::ifstream db(filename_);
+
+        if (!db)
+            return;
+
+        boost::interprocess::file_lock db_lock(filename_.c_str());
+        boost::interprocess::sharable_lock<boost::interprocess::file_lock> db_guard(db_lock);
+
+        std::string line;
+
+        while (std::getline(db, line))
+        {
+            std::istringstream entry(line);
+
+            std::string build_stamp;
+            std::string key;
+
+            if (!(entry >> build_stamp >> key) || build_stamp != build_stamp_)
+                continue;
+
+            std::vector<util::index_t> tile_sizes;
+
+            util::index_t tile_size;
+
+            while (entry >> tile_size)
+            {
+                tile_sizes.push_back(tile_size);
+            }
+
+            entries_[key] = std::move(tile_sizes);
+        }
+    }
+
+    std::string filename_;
+    std::string build_stamp_;
+    mutable std::map<std::string, std::vector<util::index_t>> entries_;
+    mutable hpx::lcos::local::mutex database_mutex_;
+};
+
+/** \brief Returns the autotuning database of this process.
+ *
+ * The location of the database can be set with the environment variable QUBUS_AUTOTUNING_DB.
+ * It defaults to qubus_autotuning.db in the current working directory.
+ */
+autotuning_database& get_autotuning_database()
+{
+    static autotuning_database db(
+        [] {
+            if (const char* filename = std::getenv("QUBUS_AUTOTUNING_DB"))
+                return std::string(filename);
+
+            return std::string("qubus_autotuning.db");
+        }(),
+        get_autotuning_build_stamp());
+
+    return db;
+}
+
+/** \brief Computes a key identifying the code of a module independently of its id.
+ *
+ * The key is derived from the canonical hash of the functions and, hence, does not depend on
+ * the names of the variables or on the identities of the nodes.
+ *
+ * \note The canonical hash combines std::hash and std::type_index values, which are only stable
+ *       for the same binary. Keys are therefore stored together with the build stamp of the
+ *       backend, see get_autotuning_build_stamp.
+ */
+std::string compute_autotuning_key(const module& mod)
+{
+    std::size_t code_hash = 0;
+
+    for (const auto& function : mod.functions())
+    {
+        std::vector<variable_declaration> signature = function.params();
+        signature.push_back(function.result());
+
+        util::hash_combine(code_hash, function.name());
+        util::hash_combine(code_hash, canonical_hash(function.body(), signature));
+    }
+
+    std::ostringstream key;
+
+    key << std::hex << std::setfill('0') << std::setw(16) << code_hash;
+
+    return key.str();
+}
+
+std::unique_ptr<module> copy_module_with_id(const module& mod, symbol_id id)
+{
+    auto new_module = std::make_unique<module>(std::move(id));
+
+    new_module->add_types(mod.types());
+
+    for (const auto& function : mod.functions())
+    {
+        new_module->add_function(function.name(), function.params(), function.result(),
+                                 clone(function.body()));
+    }
+
+    for (const auto& pragma : mod.pragmas())
+    {
+        new_module->set_pragma(pragma.first, pragma.second);
+    }
+
+    return new_module;
+}
+
 class caching_cpu_comiler
 {
 public:
+    /** \brief Executes the given plan with the given entry point on the actual arguments
+     *         and returns the execution time.
+     */
+    using benchmark_function =
+        std::function<std::chrono::nanoseconds(const cpu_plan&, const symbol_id&)>;
+
     explicit caching_cpu_comiler(module_library mod_library_)
     : mod_library_(std::move(mod_library_))
     {
     }
 
-    const cpu_plan& compile(const symbol_id& func) const
+    const cpu_plan& compile(const symbol_id& func, const benchmark_function& benchmark) const
     {
         auto module_id = func.get_prefix();
 
@@ -105,32 +337,133 @@ public:
 
         if (pos != compilation_cache_.end())
         {
-            return *pos->second;
+            auto compilation = pos->second;
+
+            guard.unlock();
+
+            return *compilation.get();
         }
-        else
+
+        // Concurrent requests for the same module share a single compilation. The lock is
+        // released during the compilation such that other modules are not blocked by
+        // autotuning runs.
+        hpx::lcos::local::promise<std::shared_ptr<const cpu_plan>> compilation_promise;
+
+        hpx::shared_future<std::shared_ptr<const cpu_plan>> compilation =
+            compilation_promise.get_future();
+
+        compilation_cache_.emplace(module_id, compilation);
+
+        guard.unlock();
+
+        try
         {
             hpx::threads::executors::default_executor executor(hpx::threads::thread_stacksize_huge);
 
-            auto compilation =
+            auto plan =
                 hpx::async(executor,
-                           [module_id, this] {
-                               auto code = mod_library_.lookup(module_id).get();
+                           [module_id, &func, &benchmark, this] {
+                               // The compiler consumes the module, so we need a private copy of the cached one.
+                               auto code = clone(*mod_library_.lookup(module_id).get());
+
+                               if (is_loop_optimization_requested(*code) &&
+                                   is_loop_autotuning_requested(*code))
+                               {
+                                   return compile_autotuned(std::move(code), func, benchmark);
+                               }
+
+                               std::lock_guard<hpx::lcos::local::mutex> compiler_guard(
+                                   compiler_mutex_);
 
                                return underlying_compiler_.compile_computelet(std::move(code));
                            })
                     .get();
 
-            pos = compilation_cache_.emplace(module_id, std::move(compilation)).first;
-
-            return *pos->second;
+            compilation_promise.set_value(std::shared_ptr<const cpu_plan>(std::move(plan)));
+        }
+        catch (...)
+        {
+            compilation_promise.set_exception(std::current_exception());
         }
+
+        return *compilation.get();
     }
 
 private:
+    std::unique_ptr<cpu_plan> compile_computelet(std::unique_ptr<module> code,
+                                                 const std::vector<util::index_t>& tile_sizes) const
+    {
+        std::lock_guard<hpx::lcos::local::mutex> compiler_guard(compiler_mutex_);
+
+        return underlying_compiler_.compile_computelet(std::move(code), tile_sizes);
+    }
+
+    std::unique_ptr<cpu_plan> compile_autotuned(std::unique_ptr<module> code,
+                                                const symbol_id& func,
+                                                const benchmark_function& benchmark) const
+    {
+        auto& autotuning_db = get_autotuning_database();
+
+        auto key = compute_autotuning_key(*code);
+
+        if (auto tile_sizes = autotuning_db.lookup(key))
+            return compile_computelet(std::move(code), *tile_sizes);
+
+        auto candidates = get_tile_size_candidates();
+
+        std::size_t best_candidate = 0;
+        auto best_execution_time = std::chrono::nanoseconds::max();
+
+        for (std::size_t i = 0; i < candidates.size(); ++i)
+        {
+            // Every candidate is compiled as a separate module to avoid clashes in the JIT engine.
+            std::vector<std::string> components;
+
+            for (auto component : code->id().components())
+            {
+                components.emplace_back(component);
+            }
+
+            components.push_back("autotuning_candidate" + std::to_string(i));
+
+            symbol_id candidate_id(std::move(components));
+
+            symbol_id entry_point(candidate_id.string() + "." + func.suffix());
+
+            auto candidate =
+                compile_computelet(copy_module_with_id(*code, candidate_id), candidates[i]);
+
+            // The benchmarks run without holding any lock.
+            for (long int run = 0; run < number_of_benchmark_runs; ++run)
+            {
+                auto execution_time = benchmark(*candidate, entry_point);
+
+                if (execution_time < best_execution_time)
+                {
+                    best_candidate = i;
+                    best_execution_time = execution_time;
+                }
+            }
+        }
+
+        autotuning_db.store(key, candidates[best_candidate]);
+
+        logger slg;
+
+        QUBUS_LOG(slg, normal) << "Selected tile size candidate " << best_candidate << " for "
+                               << code->id();
+
+        return compile_computelet(std::move(code), candidates[best_candidate]);
+    }
+
+    static constexpr long int number_of_benchmark_runs = 3;
+
     module_library mod_library_;
     mutable cpu_compiler underlying_compiler_; // FIXME: Make the cpmpiler non-mutable.
-    mutable std::unordered_map<symbol_id, std::unique_ptr<cpu_plan>> compilation_cache_;
+    mutable std::unordered_map<symbol_id, hpx::shared_future<std::shared_ptr<const cpu_plan>>>
+        compilation_cache_;
     mutable hpx::lcos::local::mutex cache_mutex_;
+    mutable hpx::lcos::local::mutex compiler_mutex_;
 };
 
 class cpu_vpu : public vpu
@@ -147,11 +480,7 @@ public:
     virtual ~cpu_vpu() = default;
 
     [[nodiscard]] hpx::future<void> execute(const symbol_id& func, execution_context ctx) override {
-        const auto& compilation = compiler_.compile(func);
-
-        hpx::future<void> task_done = hpx::async([this, &compilation, func, ctx]() mutable {
-            auto task_start = std::chrono::steady_clock::now();
-
+        hpx::future<void> task_done = hpx::async([this, func, ctx]() mutable {
             std::vector<void*> task_args;
 
             std::vector<host_address_space::handle> pages;
@@ -165,15 +494,60 @@ public:
                 pages.push_back(std::move(page));
             }
 
+            std::vector<memory_block*> result_blocks;
+
             for (const auto& result : ctx.results())
             {
                 auto page = address_space_->resolve_object(result).get();
 
                 task_args.push_back(page.data().ptr());
+                result_blocks.push_back(&page.data());
 
                 pages.push_back(std::move(page));
             }
 
+            // The autotuner executes the kernel several times. Hence, we need to restore
+            // the original content of the results after each run.
+            std::vector<std::vector<char>> result_snapshots;
+
+            auto restore_results = [&result_blocks, &result_snapshots] {
+                for (std::size_t i = 0; i < result_snapshots.size(); ++i)
+                {
+                    std::memcpy(result_blocks[i]->ptr(), result_snapshots[i].data(),
+                                result_snapshots[i].size());
+                }
+            };
+
+            auto benchmark = [&](const cpu_plan& candidate, const symbol_id& entry_point) {
+                if (result_snapshots.empty())
+                {
+                    for (auto block : result_blocks)
+                    {
+                        auto data = static_cast<const char*>(block->ptr());
+
+                        result_snapshots.emplace_back(data, data + block->size());
+                    }
+                }
+
+                restore_results();
+
+                cpu_runtime runtime;
+
+                auto start = std::chrono::steady_clock::now();
+
+                candidate.execute(entry_point, task_args, runtime);
+
+                auto end = std::chrono::steady_clock::now();
+
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+            };
+
+            const auto& compilation = compiler_.compile(func, benchmark);
+
+            restore_results();
+
+            auto task_start = std::chrono::steady_clock::now();
+
             cpu_runtime runtime;
 
             compilation.execute(func, task_args, runtime);
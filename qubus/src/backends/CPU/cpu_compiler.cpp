@@ -1,5 +1,8 @@
 #include <qubus/backends/cpu/cpu_compiler.hpp>
 
+#include <qubus/dependence_analysis.hpp>
+#include <qubus/index_narrowing.hpp>
+#include <qubus/logging.hpp>
 #include <qubus/loop_optimizer.hpp>
 #include <qubus/make_implicit_conversions_explicit.hpp>
 
@@ -34,6 +37,7 @@
 #include <qubus/jit/llvm_environment.hpp>
 
 #include <cstdlib>
+#include <string>
 #include <utility>
 
 namespace qubus
@@ -61,8 +65,9 @@ std::string mangle_function_name(const symbol_id& func_name)
 class cpu_plan_impl final : public cpu_plan
 {
 public:
-    cpu_plan_impl(jit_engine& jit_engine_, std::unique_ptr<jit::module> module_)
-    : jit_engine_(&jit_engine_), module_(std::move(module_))
+    cpu_plan_impl(jit_engine& jit_engine_, std::unique_ptr<jit::module> module_,
+                  cpu_compilation_statistics statistics_)
+    : jit_engine_(&jit_engine_), module_(std::move(module_)), statistics_(std::move(statistics_))
     {
     }
 
@@ -80,16 +85,108 @@ public:
         address(args.data(), &runtime);
     }
 
+    const cpu_compilation_statistics& statistics() const override
+    {
+        return statistics_;
+    }
+
 private:
     jit_engine* jit_engine_; // TODO: Turn this into a shared ptr or at least a weak ptr.
     std::unique_ptr<jit::module> module_;
+    cpu_compilation_statistics statistics_;
 };
 
-std::unique_ptr<cpu_plan> compile(std::unique_ptr<module> program, jit::compiler& comp,
-                                  jit_engine& engine)
+void log_loop_optimization_report(const loop_optimization_report& report)
+{
+    logger slg;
+
+    if (report.has_been_optimized)
+    {
+        std::string tile_sizes;
+
+        for (auto tile_size : report.tile_sizes)
+        {
+            tile_sizes += " " + std::to_string(tile_size);
+        }
+
+        QUBUS_LOG(slg, normal) << "Optimized the loops of " << report.function_name
+                               << " using the tile sizes" << tile_sizes;
+
+        if (!report.micro_kernel_shape.empty())
+        {
+            std::string micro_kernel_shape;
+
+            for (auto extent : report.micro_kernel_shape)
+            {
+                micro_kernel_shape += " " + std::to_string(extent);
+            }
+
+            QUBUS_LOG(slg, normal) << "Computing the contraction in " << report.function_name
+                                   << " with packed operands and the micro-kernel"
+                                   << micro_kernel_shape;
+        }
+
+        if (report.fallback == loop_optimization_fallback::reduced_effort)
+        {
+            QUBUS_LOG(slg, warning) << "Exceeded the isl operation budget while optimizing "
+                                    << report.function_name
+                                    << ", falling back to a reduced optimization effort";
+        }
+    }
+    else if (report.fallback == loop_optimization_fallback::original_code)
+    {
+        QUBUS_LOG(slg, warning) << "Exceeded the isl operation budget while optimizing "
+                                << report.function_name << ", falling back to the original code";
+    }
+    else if (report.is_scop)
+    {
+        QUBUS_LOG(slg, warning) << "Failed to optimize the loops of " << report.function_name
+                                << ", falling back to the original code";
+    }
+    else
+    {
+        QUBUS_LOG(slg, normal) << "Skipped loop optimization of " << report.function_name
+                               << " since it does not contain a SCoP";
+    }
+}
+
+std::unique_ptr<cpu_plan> compile(std::unique_ptr<module> program,
+                                  const loop_optimizer_options& loop_opt_options,
+                                  jit::compiler& comp, jit_engine& engine)
 {
+    cpu_compilation_statistics statistics;
+
     program = make_implicit_conversions_explicit(*program);
 
+    if (is_loop_optimization_requested(*program))
+    {
+        program = optimize_loops(*program, loop_opt_options,
+                                 statistics.loop_optimization_reports);
+
+        for (const auto& report : statistics.loop_optimization_reports)
+        {
+            log_loop_optimization_report(report);
+        }
+
+        record_loop_optimization_reports(program->id(), statistics.loop_optimization_reports);
+    }
+    else
+    {
+        // The loop optimizer already relaxes the execution order of independent loops.
+        for (const auto& function : program->functions())
+        {
+            annotate_independent_loops(function);
+        }
+    }
+
+    if (is_index_narrowing_requested(*program))
+    {
+        for (const auto& function : program->functions())
+        {
+            annotate_narrow_indices(function);
+        }
+    }
+
     auto mod = jit::compile(std::move(program), comp);
 
 #if LLVM_VERSION_MAJOR >= 7
@@ -143,7 +240,7 @@ std::unique_ptr<cpu_plan> compile(std::unique_ptr<module> program, jit::compiler
 
     engine.add_module(std::move(the_module));
 
-    return util::make_unique<cpu_plan_impl>(engine, std::move(mod));
+    return util::make_unique<cpu_plan_impl>(engine, std::move(mod), std::move(statistics));
 }
 }
 
@@ -177,6 +274,10 @@ public:
 
         engine_ = std::make_unique<jit_engine>(std::move(TM));
 
+        loop_opt_options_.cache_sizes = get_host_data_cache_sizes();
+        loop_opt_options_.vector_register_size = get_host_vector_register_size();
+        loop_opt_options_.number_of_vector_registers = get_host_number_of_vector_registers();
+
 #if LLVM_USE_INTEL_JITEVENTS
 // TODO: Reenable this
 // llvm::JITEventListener* vtuneProfiler =
@@ -185,14 +286,20 @@ public:
 #endif
     }
 
-    std::unique_ptr<cpu_plan> compile_computelet(std::unique_ptr<module> program)
+    std::unique_ptr<cpu_plan> compile_computelet(std::unique_ptr<module> program,
+                                                 std::vector<util::index_t> tile_sizes)
     {
-        return compile(std::move(program), *comp_, *engine_);
+        auto loop_opt_options = loop_opt_options_;
+
+        loop_opt_options.tile_sizes = std::move(tile_sizes);
+
+        return compile(std::move(program), loop_opt_options, *comp_, *engine_);
     }
 
 private:
     std::unique_ptr<jit::compiler> comp_;
     std::unique_ptr<jit_engine> engine_;
+    loop_optimizer_options loop_opt_options_;
 };
 
 cpu_compiler::cpu_compiler() : impl_(std::make_unique<cpu_compiler_impl>())
@@ -201,6 +308,12 @@ cpu_compiler::cpu_compiler() : impl_(std::make_unique<cpu_compiler_impl>())
 
 std::unique_ptr<cpu_plan> cpu_compiler::compile_computelet(std::unique_ptr<module> program)
 {
-    return impl_->compile_computelet(std::move(program));
+    return impl_->compile_computelet(std::move(program), {});
+}
+
+std::unique_ptr<cpu_plan> cpu_compiler::compile_computelet(std::unique_ptr<module> program,
+                                                           std::vector<util::index_t> tile_sizes)
+{
+    return impl_->compile_computelet(std::move(program), std::move(tile_sizes));
 }
 }
@@ -61,7 +61,8 @@ public:
             auto compilation =
                 hpx::async(executor,
                            [module_id, this] {
-                               auto code = mod_library_.lookup(module_id).get();
+                               // The compiler consumes the module, so we need a private copy of the cached one.
+                               auto code = clone(*mod_library_.lookup(module_id).get());
 
                                return underlying_compiler_.compile_computelet(std::move(code));
                            })
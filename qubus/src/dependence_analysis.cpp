@@ -0,0 +1,603 @@
+#include <qubus/dependence_analysis.hpp>
+
+#include <qubus/affine_constraints.hpp>
+#include <qubus/task_invariants_analysis.hpp>
+
+#include <qubus/IR/qir.hpp>
+
+#include <qubus/pattern/IR.hpp>
+#include <qubus/pattern/core.hpp>
+
+#include <qubus/isl/constraint.hpp>
+#include <qubus/isl/map.hpp>
+#include <qubus/isl/set.hpp>
+#include <qubus/isl/space.hpp>
+
+#include <qubus/util/assert.hpp>
+#include <qubus/util/unused.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace qubus
+{
+
+dependence::dependence(variable_declaration variable, const expression& source,
+                       const expression& target, dependence_kind kind, bool is_carried,
+                       bool is_loop_independent,
+                       std::vector<boost::optional<util::index_t>> distance)
+: variable(std::move(variable)),
+  source(source),
+  target(target),
+  kind(kind),
+  is_carried(is_carried),
+  is_loop_independent(is_loop_independent),
+  distance(std::move(distance))
+{
+}
+
+loop_dependences::loop_dependences(std::vector<dependence> dependences_)
+: dependences_(std::move(dependences_))
+{
+}
+
+const std::vector<dependence>& loop_dependences::dependences() const
+{
+    return dependences_;
+}
+
+bool loop_dependences::carries_dependences() const
+{
+    return std::any_of(dependences_.begin(), dependences_.end(),
+                       [](const dependence& dep) { return dep.is_carried; });
+}
+
+dependence_analysis_result::dependence_analysis_result(
+    std::unordered_map<const expression*, loop_dependences> loop_table_)
+: loop_table_(std::move(loop_table_))
+{
+}
+
+util::optional_ref<const loop_dependences>
+dependence_analysis_result::get_dependences(const for_expr& loop) const
+{
+    auto search_result = loop_table_.find(&loop);
+
+    if (search_result != loop_table_.end())
+    {
+        return search_result->second;
+    }
+    else
+    {
+        return {};
+    }
+}
+
+bool dependence_analysis_result::carries_dependences(const for_expr& loop) const
+{
+    auto dependences = get_dependences(loop);
+
+    return !dependences || dependences->carries_dependences();
+}
+
+namespace
+{
+
+struct access_info
+{
+    access_info(variable_declaration variable, boost::optional<std::vector<affine_expr>> indices,
+                bool is_write)
+    : variable(std::move(variable)), indices(std::move(indices)), is_write(is_write)
+    {
+    }
+
+    variable_declaration variable;
+
+    // The indices are unknown if any of them is not an affine expression.
+    boost::optional<std::vector<affine_expr>> indices;
+
+    bool is_write;
+};
+
+struct statement_info
+{
+    statement_info(const expression& stmt, std::vector<variable_declaration> loops,
+                   std::vector<affine_constraint> domain)
+    : stmt(stmt), loops(std::move(loops)), domain(std::move(domain))
+    {
+    }
+
+    std::reference_wrapper<const expression> stmt;
+
+    // The loops enclosing the statement, starting with the analyzed loop.
+    std::vector<variable_declaration> loops;
+    std::vector<affine_constraint> domain;
+    std::vector<access_info> accesses;
+};
+
+void collect_accesses(const expression& expr, bool is_write, affine_expr_context& ctx,
+                      std::vector<access_info>& accesses)
+{
+    using pattern::_;
+
+    pattern::variable<const expression &> lhs, rhs;
+    pattern::variable<variable_declaration> decl;
+    pattern::variable<std::vector<std::reference_wrapper<expression>>> indices;
+
+    auto m =
+        pattern::make_matcher<expression, void>()
+            .case_(assign(lhs, rhs),
+                   [&] {
+                       collect_accesses(lhs.get(), true, ctx, accesses);
+                       collect_accesses(rhs.get(), false, ctx, accesses);
+                   })
+            .case_(plus_assign(lhs, rhs),
+                   [&] {
+                       collect_accesses(lhs.get(), true, ctx, accesses);
+                       collect_accesses(lhs.get(), false, ctx, accesses);
+                       collect_accesses(rhs.get(), false, ctx, accesses);
+                   })
+            .case_(local_variable_def(decl, rhs),
+                   [&] {
+                       accesses.emplace_back(decl.get(), std::vector<affine_expr>(), true);
+
+                       collect_accesses(rhs.get(), false, ctx, accesses);
+                   })
+            .case_(subscription(variable_ref(decl), indices),
+                   [&] {
+                       std::vector<affine_expr> affine_indices;
+
+                       for (const expression& index : indices.get())
+                       {
+                           if (auto affine_index = try_construct_affine_expr(index, ctx))
+                           {
+                               affine_indices.push_back(*std::move(affine_index));
+                           }
+
+                           collect_accesses(index, false, ctx, accesses);
+                       }
+
+                       if (affine_indices.size() == indices.get().size())
+                       {
+                           accesses.emplace_back(decl.get(), std::move(affine_indices),
+                                                 is_write);
+                       }
+                       else
+                       {
+                           accesses.emplace_back(decl.get(), boost::none, is_write);
+                       }
+                   })
+            .case_(variable_ref(decl),
+                   [&] {
+                       accesses.emplace_back(decl.get(), std::vector<affine_expr>(), is_write);
+                   })
+            // The shape of an array is never modified.
+            .case_(member_access(_, pattern::value("shape")), [] {})
+            .case_(_, [&](const expression& self) {
+                if (is_write)
+                {
+                    // Writes via other kinds of accesses might modify any element of the
+                    // underlying variables.
+                    auto write_matcher = pattern::make_matcher<expression, void>().case_(
+                        variable_ref(decl),
+                        [&] { accesses.emplace_back(decl.get(), boost::none, true); });
+
+                    pattern::for_each(self, write_matcher);
+                }
+
+                for (const auto& child : self.sub_expressions())
+                {
+                    collect_accesses(child, false, ctx, accesses);
+                }
+            });
+
+    pattern::match(expr, m);
+}
+
+void collect_statements(const expression& expr, std::vector<variable_declaration> loops,
+                        std::vector<affine_constraint> domain, affine_expr_context& ctx,
+                        std::vector<statement_info>& statements)
+{
+    using pattern::_;
+
+    pattern::variable<variable_declaration> idx;
+    pattern::variable<const expression &> a, b, c, d;
+    pattern::variable<util::optional_ref<const expression>> opt;
+    pattern::variable<std::vector<std::reference_wrapper<const expression>>> expressions;
+
+    // Constraints which can not be expressed as affine constraints are dropped. This only
+    // enlarges the modeled iteration domains and, hence, keeps the analysis conservative.
+    auto m =
+        pattern::make_matcher<expression, void>()
+            .case_(for_(idx, a, b, c, d),
+                   [&] {
+                       auto iterator = ctx.declare_variable(idx.get());
+
+                       auto lower_bound = try_construct_affine_expr(a.get(), ctx);
+                       auto upper_bound = try_construct_affine_expr(b.get(), ctx);
+                       auto increment = try_construct_affine_expr(c.get(), ctx);
+
+                       if (lower_bound)
+                       {
+                           domain.push_back(greater_equal(iterator, *lower_bound));
+                       }
+
+                       if (upper_bound)
+                       {
+                           domain.push_back(less(iterator, *upper_bound));
+                       }
+
+                       if (lower_bound && increment && is_const(*increment))
+                       {
+                           domain.push_back(equal_to((iterator - *lower_bound) % *increment,
+                                                     ctx.create_literal(0)));
+                       }
+
+                       loops.push_back(idx.get());
+
+                       collect_statements(d.get(), loops, domain, ctx, statements);
+                   })
+            .case_(if_(a, b, opt),
+                   [&] {
+                       auto condition = try_extract_affine_constraint(a.get(), ctx);
+
+                       auto then_domain = domain;
+
+                       if (condition)
+                       {
+                           then_domain.push_back(*condition);
+                       }
+
+                       collect_statements(b.get(), loops, std::move(then_domain), ctx,
+                                          statements);
+
+                       if (opt.get())
+                       {
+                           auto else_domain = domain;
+
+                           if (condition)
+                           {
+                               else_domain.push_back(!*condition);
+                           }
+
+                           collect_statements(*opt.get(), loops, std::move(else_domain), ctx,
+                                              statements);
+                       }
+                   })
+            .case_(compound(expressions),
+                   [&] {
+                       for (const auto& sub_expr : expressions.get())
+                       {
+                           collect_statements(sub_expr, loops, domain, ctx, statements);
+                       }
+                   })
+            .case_(_, [&](const expression& self) {
+                statements.emplace_back(self, loops, domain);
+
+                collect_accesses(self, false, ctx, statements.back().accesses);
+            });
+
+    pattern::match(expr, m);
+}
+
+int get_loop_position(const variable_declaration& loop, affine_expr_context& ctx,
+                      const isl::space& iteration_space)
+{
+    auto iterator = ctx.declare_variable(loop);
+
+    auto pos = iteration_space.find_dim_by_name(isl_dim_set, get_variable_name(iterator));
+
+    QUBUS_ASSERT(pos >= 0, "Invalid loop position.");
+
+    return pos;
+}
+
+isl::map get_access_function(const std::vector<affine_expr>& indices,
+                             const isl::space& iteration_space, isl::context& isl_ctx)
+{
+    if (indices.empty())
+    {
+        auto range = align_params(isl::set::universe(isl::space(isl_ctx, 0, 0)), iteration_space);
+
+        return make_map_from_domain_and_range(isl::set::universe(iteration_space),
+                                              std::move(range));
+    }
+
+    auto access_function = isl::map::from_affine_expr(indices.front().convert(isl_ctx));
+
+    for (std::size_t i = 1; i < indices.size(); ++i)
+    {
+        access_function = flat_range_product(
+            access_function, isl::map::from_affine_expr(indices[i].convert(isl_ctx)));
+    }
+
+    return access_function;
+}
+
+// Relates the instances of the source and the target accessing the same element.
+isl::map get_conflicting_instances(const access_info& source_access, const isl::set& source_domain,
+                                   const access_info& target_access, const isl::set& target_domain,
+                                   const isl::space& iteration_space, isl::context& isl_ctx)
+{
+    if (!source_access.indices || !target_access.indices ||
+        source_access.indices->size() != target_access.indices->size())
+    {
+        return make_map_from_domain_and_range(source_domain, target_domain);
+    }
+
+    auto source_function = get_access_function(*source_access.indices, iteration_space, isl_ctx);
+    auto target_function = get_access_function(*target_access.indices, iteration_space, isl_ctx);
+
+    auto conflicts = apply_range(std::move(source_function), reverse(std::move(target_function)));
+
+    return intersect_range(intersect_domain(std::move(conflicts), source_domain), target_domain);
+}
+
+// Relates the instances of the source to all instances of the target which are executed
+// later. The common loops are given by their positions in the iteration space.
+isl::map get_precedence_relation(const std::vector<int>& common_loops,
+                                 bool source_precedes_target, const isl::space& iteration_space)
+{
+    auto universe =
+        isl::map::universe(isl::space::from_domain_and_range(iteration_space, iteration_space));
+
+    auto precedence = isl::map::empty(universe.get_space());
+
+    auto equal_prefix = universe;
+
+    for (auto pos : common_loops)
+    {
+        auto later_iteration = equal_prefix;
+
+        later_iteration.add_constraint(isl::constraint::inequality(universe.get_space())
+                                           .set_coefficient(isl_dim_out, pos, 1)
+                                           .set_coefficient(isl_dim_in, pos, -1)
+                                           .set_constant(-1));
+
+        precedence = union_(std::move(precedence), std::move(later_iteration));
+
+        equal_prefix.add_constraint(isl::constraint::equality(universe.get_space())
+                                        .set_coefficient(isl_dim_out, pos, 1)
+                                        .set_coefficient(isl_dim_in, pos, -1));
+    }
+
+    if (source_precedes_target)
+    {
+        precedence = union_(std::move(precedence), std::move(equal_prefix));
+    }
+
+    return precedence;
+}
+
+boost::optional<dependence> compute_dependence(const statement_info& source,
+                                               const access_info& source_access,
+                                               const statement_info& target,
+                                               const access_info& target_access,
+                                               bool source_precedes_target,
+                                               affine_expr_context& ctx,
+                                               const isl::space& iteration_space,
+                                               isl::context& isl_ctx)
+{
+    std::vector<int> common_loops;
+
+    for (std::size_t i = 0; i < std::min(source.loops.size(), target.loops.size()); ++i)
+    {
+        if (source.loops[i] != target.loops[i])
+            break;
+
+        common_loops.push_back(get_loop_position(source.loops[i], ctx, iteration_space));
+    }
+
+    QUBUS_ASSERT(!common_loops.empty(), "All statements are enclosed by the analyzed loop.");
+
+    auto source_domain = isl::set::universe(iteration_space);
+
+    for (const auto& constraint : source.domain)
+    {
+        source_domain = intersect(std::move(source_domain), constraint.convert(isl_ctx));
+    }
+
+    auto target_domain = isl::set::universe(iteration_space);
+
+    for (const auto& constraint : target.domain)
+    {
+        target_domain = intersect(std::move(target_domain), constraint.convert(isl_ctx));
+    }
+
+    auto dependences =
+        intersect(get_conflicting_instances(source_access, source_domain, target_access,
+                                            target_domain, iteration_space, isl_ctx),
+                  get_precedence_relation(common_loops, source_precedes_target, iteration_space));
+
+    dependences = simplify(coalesce(std::move(dependences)));
+
+    if (is_empty(dependences))
+        return boost::none;
+
+    auto outermost_loop = common_loops.front();
+
+    auto carried_dependences = dependences;
+    carried_dependences.add_constraint(isl::constraint::inequality(dependences.get_space())
+                                           .set_coefficient(isl_dim_out, outermost_loop, 1)
+                                           .set_coefficient(isl_dim_in, outermost_loop, -1)
+                                           .set_constant(-1));
+
+    auto independent_dependences = dependences;
+    independent_dependences.add_constraint(isl::constraint::equality(dependences.get_space())
+                                               .set_coefficient(isl_dim_out, outermost_loop, 1)
+                                               .set_coefficient(isl_dim_in, outermost_loop, -1));
+
+    auto distances = detect_equalities(deltas(dependences));
+
+    std::vector<boost::optional<util::index_t>> distance;
+
+    for (auto pos : common_loops)
+    {
+        auto value = plain_get_val_if_fixed(distances, isl_dim_set, pos);
+
+        if (value.is_int())
+        {
+            distance.push_back(value.as_integer());
+        }
+        else
+        {
+            distance.push_back(boost::none);
+        }
+    }
+
+    auto kind = [&] {
+        if (source_access.is_write && target_access.is_write)
+            return dependence_kind::output;
+
+        return source_access.is_write ? dependence_kind::flow : dependence_kind::anti;
+    }();
+
+    return dependence(source_access.variable, source.stmt, target.stmt, kind,
+                      !is_empty(carried_dependences), !is_empty(independent_dependences),
+                      std::move(distance));
+}
+
+loop_dependences analyze_loop(const for_expr& loop,
+                              const task_invariants_analysis_result& task_invariants_analysis,
+                              isl::context& isl_ctx)
+{
+    affine_expr_context ctx([&loop, &task_invariants_analysis](const expression& expr) {
+        return task_invariants_analysis.is_invariant(expr, loop);
+    });
+
+    std::vector<statement_info> statements;
+
+    collect_statements(loop, {}, {}, ctx, statements);
+
+    // Variables defined within the loop are private to each iteration.
+    std::vector<variable_declaration> private_variables;
+
+    pattern::variable<variable_declaration> decl;
+
+    auto m = pattern::make_matcher<expression, void>().case_(
+        local_variable_def(decl, pattern::_), [&] { private_variables.push_back(decl.get()); });
+
+    pattern::for_each(loop, m);
+
+    // All variables have been declared, so the iteration space is complete.
+    auto iteration_space = ctx.construct_corresponding_space(isl_ctx);
+
+    std::vector<dependence> dependences;
+
+    for (std::size_t i = 0; i < statements.size(); ++i)
+    {
+        for (std::size_t j = 0; j < statements.size(); ++j)
+        {
+            for (const auto& source_access : statements[i].accesses)
+            {
+                for (const auto& target_access : statements[j].accesses)
+                {
+                    if (source_access.variable != target_access.variable)
+                        continue;
+
+                    if (std::find(private_variables.begin(), private_variables.end(),
+                                  source_access.variable) != private_variables.end())
+                        continue;
+
+                    if (!source_access.is_write && !target_access.is_write)
+                        continue;
+
+                    auto dep = compute_dependence(statements[i], source_access, statements[j],
+                                                  target_access, i < j, ctx, iteration_space,
+                                                  isl_ctx);
+
+                    if (dep)
+                    {
+                        dependences.push_back(*std::move(dep));
+                    }
+                }
+            }
+        }
+    }
+
+    return loop_dependences(std::move(dependences));
+}
+
+void analyze_loops(const expression& expr,
+                   const task_invariants_analysis_result& task_invariants_analysis,
+                   isl::context& isl_ctx,
+                   std::unordered_map<const expression*, loop_dependences>& loop_table)
+{
+    if (auto loop = expr.try_as<for_expr>())
+    {
+        loop_table.emplace(loop, analyze_loop(*loop, task_invariants_analysis, isl_ctx));
+    }
+
+    for (const auto& child : expr.sub_expressions())
+    {
+        analyze_loops(child, task_invariants_analysis, isl_ctx, loop_table);
+    }
+}
+}
+
+dependence_analysis_result
+dependence_analysis_pass::run(const expression& root, analysis_manager& manager,
+                              pass_resource_manager& resource_manager) const
+{
+    std::unordered_map<const expression*, loop_dependences> loop_table;
+
+    analyze_loops(root, manager.get_analysis<task_invariants_analysis_pass>(root),
+                  resource_manager.get_isl_ctx(), loop_table);
+
+    return dependence_analysis_result(std::move(loop_table));
+}
+
+dependence_analysis_result
+dependence_analysis_pass::relocate(const dependence_analysis_result& result,
+                                   const expression_relocation& relocation,
+                                   const expression& QUBUS_UNUSED(root),
+                                   analysis_manager& QUBUS_UNUSED(manager),
+                                   pass_resource_manager& QUBUS_UNUSED(resource_manager)) const
+{
+    std::unordered_map<const expression*, loop_dependences> loop_table;
+
+    for (const auto& loop_and_dependences : result.loop_table_)
+    {
+        std::vector<dependence> dependences;
+
+        for (const auto& dep : loop_and_dependences.second.dependences())
+        {
+            dependences.emplace_back(relocation.map(dep.variable), relocation.map(dep.source.get()),
+                                     relocation.map(dep.target.get()), dep.kind, dep.is_carried,
+                                     dep.is_loop_independent, dep.distance);
+        }
+
+        loop_table.emplace(&relocation.map(*loop_and_dependences.first),
+                           loop_dependences(std::move(dependences)));
+    }
+
+    return dependence_analysis_result(std::move(loop_table));
+}
+
+std::vector<analysis_id> dependence_analysis_pass::required_analyses() const
+{
+    return {get_analysis_id<task_invariants_analysis_pass>()};
+}
+
+QUBUS_REGISTER_ANALYSIS_PASS(dependence_analysis_pass);
+
+void annotate_independent_loops(const function& func)
+{
+    pass_resource_manager resource_manager;
+    analysis_manager analysis_man(resource_manager);
+
+    const auto& dependences = analysis_man.get_analysis<dependence_analysis_pass>(func.body());
+
+    auto m = pattern::make_matcher<expression, void>().case_(
+        pattern::_, [&](const expression& self) {
+            auto loop = self.try_as<for_expr>();
+
+            if (loop && !dependences.carries_dependences(*loop))
+            {
+                loop->annotations().add(independent_iterations_annotation, annotation(true));
+            }
+        });
+
+    pattern::for_each(func.body(), m);
+}
+}
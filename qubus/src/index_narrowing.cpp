@@ -0,0 +1,152 @@
+#include <qubus/index_narrowing.hpp>
+
+#include <qubus/value_range_analysis.hpp>
+
+#include <qubus/IR/qir.hpp>
+#include <qubus/IR/type_inference.hpp>
+
+#include <qubus/pattern/core.hpp>
+
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace qubus
+{
+
+namespace
+{
+constexpr util::index_t min_narrow_value = std::numeric_limits<std::int32_t>::min();
+constexpr util::index_t max_narrow_value = std::numeric_limits<std::int32_t>::max();
+
+/** \brief Returns the inclusive bounds of a value range if both of them are constant.
+ */
+boost::optional<std::pair<util::index_t, util::index_t>>
+get_constant_bounds(const boost::optional<value_range>& range)
+{
+    if (!range)
+        return boost::none;
+
+    auto lower_bound = range->lower_bound->try_as<integer_literal_expr>();
+    auto upper_bound = range->upper_bound->try_as<integer_literal_expr>();
+
+    if (!lower_bound || !upper_bound)
+        return boost::none;
+
+    // The upper bound of a value range is exclusive.
+    return std::make_pair(lower_bound->value(), upper_bound->value() - 1);
+}
+
+bool has_narrow_induction_variable(const for_expr& loop,
+                                   const value_range_analysis_result& value_ranges,
+                                   const expression& context)
+{
+    auto lower_bound =
+        get_constant_bounds(value_ranges.determine_value_range(loop.lower_bound(), context));
+    auto upper_bound =
+        get_constant_bounds(value_ranges.determine_value_range(loop.upper_bound(), context));
+    auto increment =
+        get_constant_bounds(value_ranges.determine_value_range(loop.increment(), context));
+
+    if (!lower_bound || !upper_bound || !increment)
+        return false;
+
+    if (lower_bound->first < min_narrow_value || upper_bound->first < min_narrow_value)
+        return false;
+
+    if (increment->first < 1 || increment->second > max_narrow_value ||
+        upper_bound->second > max_narrow_value)
+        return false;
+
+    // The last increment of the induction variable yields a value of at most
+    // upper_bound + increment - 1, which has to be representable, too.
+    return upper_bound->second + increment->second - 1 <= max_narrow_value;
+}
+
+/** \brief Checks if an array expression denotes an array passed to the function.
+ *
+ * The extents of these arrays can not change during the execution of the function and can
+ * therefore be checked once in front of a loop.
+ */
+bool is_invariant_array(const access_expr& array, const function& func)
+{
+    const access_expr* current_access = &array;
+
+    while (auto member_access = current_access->try_as<member_access_expr>())
+    {
+        current_access = &member_access->object();
+    }
+
+    auto direct_access = current_access->try_as<variable_ref_expr>();
+
+    if (!direct_access)
+        return false;
+
+    const auto& var = direct_access->declaration();
+
+    const auto& params = func.params();
+
+    return var == func.result() || std::find(params.begin(), params.end(), var) != params.end();
+}
+
+bool is_narrowable_gather_index(const subscription_expr& subscription, const function& func)
+{
+    if (subscription.arity() != 2)
+        return false;
+
+    const auto& index = subscription.child(1);
+
+    if (!index.try_as<subscription_expr>() || typeof_(index) != types::integer{})
+        return false;
+
+    auto indexed_type = typeof_(subscription.indexed_expr());
+
+    auto array_type = indexed_type.try_as<types::array>();
+
+    if (!array_type || array_type->rank() != 1)
+        return false;
+
+    return is_invariant_array(subscription.indexed_expr(), func);
+}
+}
+
+bool is_index_narrowing_requested(const module& mod)
+{
+    auto value = mod.lookup_pragma(narrow_indices_pragma);
+
+    return !value || *value != "false";
+}
+
+void annotate_narrow_indices(const function& func)
+{
+    pass_resource_manager resource_manager;
+    analysis_manager analysis_man(resource_manager);
+
+    const auto& value_ranges = analysis_man.get_analysis<value_range_analysis_pass>(func.body());
+
+    auto m = pattern::make_matcher<expression, void>().case_(
+        pattern::_, [&](const expression& self) {
+            if (auto loop = self.try_as<for_expr>())
+            {
+                if (has_narrow_induction_variable(*loop, value_ranges, func.body()))
+                {
+                    loop->annotations().add(narrow_induction_variable_annotation,
+                                            annotation(true));
+                }
+            }
+            else if (auto subscription = self.try_as<subscription_expr>())
+            {
+                if (is_narrowable_gather_index(*subscription, func))
+                {
+                    subscription->child(1).annotations().add(narrow_index_annotation,
+                                                             annotation(true));
+                }
+            }
+        });
+
+    pattern::for_each(func.body(), m);
+}
+}
@@ -127,7 +127,7 @@ ast_builder::ast_builder(isl_ast_build* handle_) : ast_builder_base(handle_)
 {
 }
 
-ast_builder::ast_builder(const context& ctx) : ast_builder_base(isl_ast_build_alloc(ctx.native_handle()))
+ast_builder::ast_builder(context_ref ctx) : ast_builder_base(isl_ast_build_alloc(ctx.native_handle()))
 {
 }
 
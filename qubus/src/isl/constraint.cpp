@@ -39,6 +39,13 @@ namespace isl
         return *this;
     }
 
+    constraint& constraint::set_constant(value val)
+    {
+        handle_ = isl_constraint_set_constant_val(handle_, val.release());
+
+        return *this;
+    }
+
     constraint& constraint::set_coefficient(isl_dim_type type, int pos, int value)
     {
         handle_ = isl_constraint_set_coefficient_si(handle_, type, pos, value);
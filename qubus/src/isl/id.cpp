@@ -26,12 +26,12 @@ id::id(isl_id* handle_) : handle_(handle_)
 {
 }
 
-id::id(const context& ctx, const std::string& name)
+id::id(context_ref ctx, const std::string& name)
 : handle_(isl_id_alloc(ctx.native_handle(), name.c_str(), nullptr))
 {
 }
 
-id::id(const context& ctx, const std::string& name, boost::any user_data)
+id::id(context_ref ctx, const std::string& name, boost::any user_data)
 : handle_(isl_id_alloc(ctx.native_handle(), name.c_str(), new boost::any(std::move(user_data))))
 {
     isl_id_set_free_user(handle_, user_free);
@@ -347,6 +347,16 @@ map reverse(map m)
     return map(isl_map_reverse(m.release()));
 }
 
+set deltas(map m)
+{
+    return set(isl_map_deltas(m.release()));
+}
+
+bool is_empty(const map& m)
+{
+    return isl_map_is_empty(m.native_handle()) != 0;
+}
+
 map coalesce(map m)
 {
     return map(isl_map_coalesce(m.release()));
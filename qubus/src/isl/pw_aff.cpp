@@ -76,5 +76,15 @@ map map_from_pw_aff(pw_aff fn)
     return map(isl_map_from_pw_aff(fn.release()));
 }
 
+pw_aff dim_min(set s, int pos)
+{
+    return pw_aff(isl_set_dim_min(s.release(), pos));
+}
+
+pw_aff dim_max(set s, int pos)
+{
+    return pw_aff(isl_set_dim_max(s.release(), pos));
+}
+
 }
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include <qubus/isl/schedule.hpp>
 
+#include <exception>
+
 namespace qubus
 {
 namespace isl
@@ -125,14 +127,32 @@ schedule get_schedule(const schedule_node& node)
 
 namespace
 {
+
+struct map_schedule_node_data
+{
+    std::function<schedule_node(schedule_node)>* callback;
+    std::exception_ptr error;
+};
+
 extern "C"
 {
 
 isl_schedule_node* QUBUS_isl_map_schedule_node_thunk(isl_schedule_node* node, void* user)
 {
-    auto& callback = *static_cast<std::function<schedule_node(schedule_node)>*>(user);
+    auto& data = *static_cast<map_schedule_node_data*>(user);
 
-    return callback(schedule_node(node)).release();
+    // Exceptions must not propagate through isl. Instead, we abort the traversal and
+    // rethrow the exception after isl has returned.
+    try
+    {
+        return (*data.callback)(schedule_node(node)).release();
+    }
+    catch (...)
+    {
+        data.error = std::current_exception();
+
+        return nullptr;
+    }
 }
 
 }
@@ -140,7 +160,15 @@ isl_schedule_node* QUBUS_isl_map_schedule_node_thunk(isl_schedule_node* node, vo
 
 schedule map_schedule_node(schedule s, std::function<schedule_node(schedule_node)> callback)
 {
-    return schedule(isl_schedule_map_schedule_node_bottom_up(s.release(), &QUBUS_isl_map_schedule_node_thunk, &callback));
+    map_schedule_node_data data{&callback, nullptr};
+
+    auto result = isl_schedule_map_schedule_node_bottom_up(
+        s.release(), &QUBUS_isl_map_schedule_node_thunk, &data);
+
+    if (data.error)
+        std::rethrow_exception(data.error);
+
+    return schedule(result);
 }
 
 }
@@ -57,6 +57,16 @@ schedule_node schedule_node::parent() const
     return schedule_node(isl_schedule_node_parent(isl_schedule_node_copy(handle_)));
 }
 
+context_ref schedule_node::get_ctx() const
+{
+    return context_ref(isl_schedule_node_get_ctx(handle_));
+}
+
+int schedule_node::get_schedule_depth() const
+{
+    return isl_schedule_node_get_schedule_depth(handle_);
+}
+
 union_map schedule_node::band_get_partial_schedule_union_map() const
 {
     return union_map(isl_schedule_node_band_get_partial_schedule_union_map(handle_));
@@ -72,6 +82,11 @@ bool schedule_node::band_is_permutable() const
     return isl_schedule_node_band_get_permutable(handle_)  != 0;
 }
 
+bool schedule_node::band_member_get_coincident(int pos) const
+{
+    return isl_schedule_node_band_member_get_coincident(handle_, pos) != 0;
+}
+
 void schedule_node::band_member_set_coincident(int pos, bool is_coincident)
 {
     handle_ = isl_schedule_node_band_member_set_coincident(handle_, pos, is_coincident ? 1 : 0);
@@ -208,6 +223,11 @@ schedule_node tile_band(schedule_node node, std::vector<long int> sizes)
     return schedule_node(isl_schedule_node_band_tile(node.release(), sizes_));
 }
 
+schedule_node delete_node(schedule_node node)
+{
+    return schedule_node(isl_schedule_node_delete(node.release()));
+}
+
 schedule_node graft_before(schedule_node node, schedule_node graft)
 {
     return schedule_node(isl_schedule_node_graft_before(node.release(), graft.release()));
@@ -299,6 +299,11 @@ bool is_empty(const set& s)
     return isl_set_is_empty(s.native_handle()) != 0;
 }
 
+value plain_get_val_if_fixed(const set& s, isl_dim_type type, unsigned int pos)
+{
+    return value(isl_set_plain_get_val_if_fixed(s.native_handle(), type, pos));
+}
+
 set get_params(set s)
 {
     return set(isl_set_params(s.release()));
@@ -10,9 +10,16 @@
 #include <qubus/IR/qir.hpp>
 #include <qubus/IR/type_inference.hpp>
 
+#include <qubus/util/assert.hpp>
+
+#include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/IR/Metadata.h>
 #include <llvm/IR/Type.h>
 
+#include <cstdint>
+#include <limits>
+
 namespace qubus
 {
 namespace jit
@@ -48,103 +55,154 @@ util::index_t get_rank(const type& array_type)
     return pattern::match(array_type, m);
 }
 
-llvm::Value* emit_array_access(llvm::Value* data, const std::vector<llvm::Value*>& shape,
-                               const std::vector<llvm::Value*>& indices, llvm_environment& env)
+std::vector<llvm::Value*> emit_row_major_strides(const std::vector<llvm::Value*>& shape,
+                                                 llvm::IRBuilder<>& builder, llvm_environment& env)
+{
+    llvm::Type* size_type = env.map_qubus_type(types::integer());
+
+    std::vector<llvm::Value*> strides(shape.size());
+
+    if (shape.empty())
+        return strides;
+
+    llvm::Value* stride = llvm::ConstantInt::get(size_type, 1);
+
+    for (std::size_t i = shape.size(); i-- > 0;)
+    {
+        strides[i] = stride;
+
+        if (i > 0)
+        {
+            stride = builder.CreateMul(stride, shape[i], "stride", true, true);
+        }
+    }
+
+    return strides;
+}
+
+llvm::Value* emit_linearized_index(const std::vector<llvm::Value*>& strides,
+                                   const std::vector<llvm::Value*>& indices, llvm_environment& env)
 {
+    QUBUS_ASSERT(strides.size() == indices.size(), "Expecting one stride per index.");
+
     auto& builder = env.builder();
 
     llvm::Type* size_type = env.map_qubus_type(types::integer());
 
     llvm::Value* linearized_index = llvm::ConstantInt::get(size_type, 0);
 
-    // for (std::size_t i = indices.size(); i-- > 0;)
-    for (std::size_t i = 0; i < indices.size(); i++)
+    // Every term only depends on a single index and a loop-invariant stride. This keeps the
+    // address an affine function of the induction variables and allows LLVM to strength-reduce
+    // row-major sweeps into pointer increments.
+    for (std::size_t i = 0; i < indices.size(); ++i)
     {
-        auto extent = shape[i];
+        auto offset = builder.CreateMul(indices[i], strides[i], "idx_mul", true, true);
 
-        linearized_index =
-            builder.CreateAdd(builder.CreateMul(extent, linearized_index, "idx_mul", true, true),
-                              indices[i], "idx_add", true, true);
+        linearized_index = builder.CreateAdd(linearized_index, offset, "idx_add", true, true);
     }
 
-    auto result = builder.CreateInBoundsGEP(data, linearized_index);
-
-    return result;
+    return linearized_index;
 }
 
-reference emit_array_access(const reference& data, const reference& shape,
-                            const std::vector<llvm::Value*>& indices, llvm_environment& env,
-                            compilation_context& ctx)
+std::vector<llvm::Value*> load_shape(const reference& shape, std::size_t rank,
+                                     llvm_environment& env, compilation_context& ctx,
+                                     bool is_invariant)
 {
     auto& builder = env.builder();
 
-    std::vector<llvm::Value*> shape_;
-    shape_.reserve(indices.size());
-
     auto shape_value_type = shape.datatype();
 
-    for (std::size_t i = 0; i < indices.size(); ++i)
+    std::vector<llvm::Value*> shape_;
+    shape_.reserve(rank);
+
+    for (std::size_t i = 0; i < rank; ++i)
     {
         auto extent_ptr = builder.CreateConstInBoundsGEP1_32(env.map_qubus_type(shape_value_type),
-                                                             shape.addr(), i);
+                                                             shape.addr(), i, "extent_ptr");
 
         auto extent =
             load_from_ref(reference(extent_ptr, shape.origin(), shape_value_type), env, ctx);
 
+        if (is_invariant)
+        {
+            extent->setMetadata(llvm::LLVMContext::MD_invariant_load,
+                                llvm::MDNode::get(env.ctx(), {}));
+        }
+
         shape_.push_back(extent);
     }
 
-    auto accessed_element = emit_array_access(data.addr(), shape_, indices, env);
-
-    auto data_value_type = data.datatype();
-
-    return reference(accessed_element, data.origin(), data_value_type);
+    return shape_;
 }
 
-std::unique_ptr<expression> reassociate_index_expression(const expression& expr)
+/** \brief Loads the row-major strides of an array.
+ *
+ *  If the array is passed as an argument to the current function, its shape can not change
+ *  during the execution of the function. In this case, the strides are computed once in the
+ *  entry block and reused by all subsequent accesses, independent of the loop nest in which
+ *  they occur.
+ */
+std::vector<llvm::Value*> load_array_strides(const reference& array, llvm_environment& env,
+                                             compilation_context& ctx)
 {
-    using pattern::_;
+    auto rank = get_rank(array.datatype());
 
-    util::index_t constant_term = 0;
+    auto int_type = env.map_qubus_type(types::integer{});
 
-    std::function<std::unique_ptr<expression>(const expression&)> collect_constant_terms =
-        [&](const expression& expr) {
-            pattern::variable<const expression&> lhs, rhs;
-            pattern::variable<util::index_t> value;
+    auto array_arg = llvm::dyn_cast<llvm::Argument>(array.addr());
 
-            auto m = pattern::matcher<expression, std::unique_ptr<expression>>()
-                         .case_(integer_literal(value) + rhs,
-                                [&] {
-                                    constant_term += value.get();
+    if (!array_arg)
+    {
+        auto shape_ptr = load_array_shape_ptr(array, env, ctx);
 
-                                    return collect_constant_terms(rhs.get());
-                                })
-                         .case_(lhs + integer_literal(value),
-                                [&] {
-                                    constant_term += value.get();
+        auto shape = load_shape(reference(shape_ptr, array.origin() / "shape", types::integer{}),
+                                rank, env, ctx, false);
 
-                                    return collect_constant_terms(lhs.get());
-                                })
-                         .case_(lhs + rhs,
-                                [&] {
-                                    return collect_constant_terms(lhs.get()) +
-                                           collect_constant_terms(rhs.get());
-                                })
-                         .case_(_, [&](const expression& self) { return clone(self); });
+        return emit_row_major_strides(shape, env.builder(), env);
+    }
 
-            return pattern::match(expr, m);
-        };
+    if (auto strides = ctx.lookup_hoisted_strides(array_arg))
+        return *strides;
 
-    auto simplified_expr = collect_constant_terms(expr);
+    auto& builder = env.builder();
 
-    if (constant_term != 0)
-    {
-        return std::move(simplified_expr) + qubus::integer_literal(constant_term);
-    }
-    else
-    {
-        return simplified_expr;
-    }
+    llvm::IRBuilderBase::InsertPointGuard guard(builder);
+
+    auto& entry_block = array_arg->getParent()->getEntryBlock();
+
+    builder.SetInsertPoint(&entry_block, entry_block.begin());
+
+    auto base_ptr = builder.CreateBitCast(array_arg, int_type->getPointerTo(0), "rank_ptr");
+
+    auto shape_ptr = builder.CreateConstInBoundsGEP1_32(int_type, base_ptr, 1, "shape_ptr");
+
+    auto shape = load_shape(reference(shape_ptr, array.origin() / "shape", types::integer{}),
+                            rank, env, ctx, true);
+
+    auto strides = emit_row_major_strides(shape, builder, env);
+
+    ctx.register_hoisted_strides(array_arg, strides);
+
+    return strides;
+}
+
+reference emit_array_access(const reference& data, const reference& shape,
+                            const std::vector<llvm::Value*>& indices, llvm_environment& env,
+                            compilation_context& ctx)
+{
+    auto& builder = env.builder();
+
+    auto shape_ = load_shape(shape, indices.size(), env, ctx, false);
+
+    auto strides = emit_row_major_strides(shape_, builder, env);
+
+    auto linearized_index = emit_linearized_index(strides, indices, env);
+
+    auto accessed_element = builder.CreateInBoundsGEP(data.addr(), linearized_index);
+
+    auto data_value_type = data.datatype();
+
+    return reference(accessed_element, data.origin(), data_value_type);
 }
 
 std::vector<llvm::Value*> permute_indices(const std::vector<llvm::Value*>& indices,
@@ -219,6 +277,37 @@ llvm::Value* load_array_shape_ptr(reference array, llvm_environment& env, compil
     return shape_ptr;
 }
 
+llvm::Value* emit_index_narrowing_guard(
+    const std::vector<std::reference_wrapper<const expression>>& indices, compiler& comp)
+{
+    auto& env = comp.get_module().env();
+    auto& ctx = comp.get_module().ctx();
+
+    auto& builder = env.builder();
+
+    auto int_type = env.map_qubus_type(types::integer{});
+
+    auto max_extent =
+        llvm::ConstantInt::get(int_type, std::numeric_limits<std::int32_t>::max(), true);
+
+    llvm::Value* guard = builder.getTrue();
+
+    for (const auto& index : indices)
+    {
+        const auto& subscription = index.get().parent()->as<subscription_expr>();
+
+        auto array = comp.compile(subscription.indexed_expr());
+
+        auto shape_ptr = load_array_shape_ptr(array, env, ctx);
+
+        auto extent = builder.CreateLoad(shape_ptr, "extent");
+
+        guard = builder.CreateAnd(guard, builder.CreateICmpSLE(extent, max_extent));
+    }
+
+    return guard;
+}
+
 reference extent(const expression& array_like, const expression& dim, compiler& comp)
 {
     using pattern::_;
@@ -299,34 +388,42 @@ reference emit_array_access(const expression& array,
     auto& env = comp.get_module().env();
     auto& ctx = comp.get_module().ctx();
 
-    std::unique_ptr<expression> linearized_index = integer_literal(0);
+    auto& builder = env.builder();
 
-    for (std::size_t i = 0; i < indices.size(); ++i)
-    {
-        std::vector<std::unique_ptr<expression>> args;
-        args.reserve(2);
-        args.push_back(clone(array));
-        args.push_back(integer_literal(i));
+    std::vector<llvm::Value*> indices_;
+    indices_.reserve(indices.size());
 
-        auto extent = intrinsic_function("extent", std::move(args));
+    for (const auto& index : indices)
+    {
+        auto index_ref = comp.compile(index);
 
-        linearized_index = std::move(extent) * std::move(linearized_index) + clone(indices[i]);
+        indices_.push_back(load_from_ref(index_ref, env, ctx));
     }
 
-    linearized_index = reassociate_index_expression(*linearized_index);
+    auto array_ = comp.compile(array);
 
-    auto linearized_index_ = comp.compile(*linearized_index);
+    llvm::Value* linearized_index;
 
-    auto& builder = env.builder();
+    if (indices.size() == 1 && ctx.is_index_narrowing_permitted(indices.front()))
+    {
+        // The offset of a GEP is sign-extended, so the narrowed index addresses the same
+        // element. Vectorized gathers can use 32-bit lanes for it, though.
+        linearized_index =
+            builder.CreateTrunc(indices_.front(), builder.getInt32Ty(), "narrow_idx");
+    }
+    else
+    {
+        auto strides = load_array_strides(array_, env, ctx);
 
-    auto array_ = comp.compile(array);
+        linearized_index = emit_linearized_index(strides, indices_, env);
+    }
 
     auto data = load_array_data_ptr(array_, env, ctx);
 
     auto data_value_type = get_value_type(array_.datatype());
 
     auto data_ref = reference(builder.CreateInBoundsGEP(env.map_qubus_type(data_value_type), data,
-                                                        load_from_ref(linearized_index_, env, ctx)),
+                                                        linearized_index),
                               array_.origin() / "data", data_value_type);
 
     return data_ref;
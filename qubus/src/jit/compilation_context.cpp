@@ -2,6 +2,8 @@
 
 #include <qubus/util/unused.hpp>
 
+#include <utility>
+
 namespace qubus
 {
 namespace jit
@@ -118,6 +120,42 @@ void compilation_context::wait_on_pending_tasks() const
     hpx::wait_all(pending_tasks_);
 }
 
+util::optional_ref<const std::vector<llvm::Value*>>
+compilation_context::lookup_hoisted_strides(llvm::Value* array) const
+{
+    auto search_result = hoisted_strides_.find(array);
+
+    if (search_result != hoisted_strides_.end())
+    {
+        return search_result->second;
+    }
+    else
+    {
+        return {};
+    }
+}
+
+void compilation_context::register_hoisted_strides(llvm::Value* array,
+                                                   std::vector<llvm::Value*> strides)
+{
+    hoisted_strides_[array] = std::move(strides);
+}
+
+bool compilation_context::is_index_narrowing_permitted(const expression& index) const
+{
+    return narrowable_indices_.count(&index) > 0;
+}
+
+void compilation_context::permit_index_narrowing(const expression& index)
+{
+    narrowable_indices_.insert(&index);
+}
+
+void compilation_context::revoke_index_narrowing(const expression& index)
+{
+    narrowable_indices_.erase(&index);
+}
+
 void compilation_context::answer_pending_global_alias_queries()
 {
     std::map<std::string, llvm::MDNode*> alias_scope_table;
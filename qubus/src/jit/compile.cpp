@@ -16,13 +16,42 @@
 #include <qubus/pattern/IR.hpp>
 #include <qubus/pattern/core.hpp>
 
+#include <functional>
 #include <iterator>
+#include <vector>
 
 namespace qubus
 {
 namespace jit
 {
 
+namespace
+{
+/** \brief Collects the data-dependent indices of a loop body which are marked for narrowing
+ *         but not yet narrowed by an enclosing loop.
+ */
+std::vector<std::reference_wrapper<const expression>>
+collect_narrowable_indices(const expression& body, const compilation_context& ctx)
+{
+    std::vector<std::reference_wrapper<const expression>> narrowable_indices;
+
+    auto m = pattern::make_matcher<expression, void>().case_(
+        pattern::_, [&](const expression& self) {
+            auto narrow_index = self.annotations().lookup(narrow_index_annotation);
+
+            if (narrow_index && narrow_index.as<bool>() &&
+                !ctx.is_index_narrowing_permitted(self))
+            {
+                narrowable_indices.push_back(self);
+            }
+        });
+
+    pattern::for_each(body, m);
+
+    return narrowable_indices;
+}
+}
+
 reference compile(const expression& expr, compiler& comp)
 {
     auto& env = comp.get_module().env();
@@ -82,8 +111,73 @@ reference compile(const expression& expr, compiler& comp)
                        auto lower_bound = load_from_ref(lower_bound_ptr, env, ctx);
                        auto upper_bound = load_from_ref(upper_bound_ptr, env, ctx);
 
-                       emit_loop(induction_var_ref, lower_bound, upper_bound, increment_value,
-                                 [&]() { comp.compile(d.get()); }, env, ctx);
+                       // Parallel loops are executed sequentially for now. The iterations of
+                       // unordered loops and of loops without carried dependences are
+                       // independent, so they are safe to vectorize.
+                       auto independent_iterations =
+                           expr.annotations().lookup(independent_iterations_annotation);
+
+                       bool vectorize =
+                           expr.as<for_expr>().order() == execution_order::unordered ||
+                           (independent_iterations && independent_iterations.as<bool>());
+
+                       auto narrow_induction_variable =
+                           expr.annotations().lookup(narrow_induction_variable_annotation);
+
+                       auto emit_loop_nest = [&] {
+                           if (narrow_induction_variable && narrow_induction_variable.as<bool>())
+                           {
+                               emit_narrow_loop(induction_var_ref, lower_bound, upper_bound,
+                                                increment_value,
+                                                [&]() { comp.compile(d.get()); }, env, ctx,
+                                                vectorize);
+                           }
+                           else
+                           {
+                               emit_loop(induction_var_ref, lower_bound, upper_bound,
+                                         increment_value, [&]() { comp.compile(d.get()); }, env,
+                                         ctx, vectorize);
+                           }
+                       };
+
+                       auto narrowable_indices =
+                           vectorize ? collect_narrowable_indices(d.get(), ctx)
+                                     : std::vector<std::reference_wrapper<const expression>>();
+
+                       if (narrowable_indices.empty())
+                       {
+                           emit_loop_nest();
+
+                           return reference();
+                       }
+
+                       // Version the loop on the extents of the arrays accessed through
+                       // data-dependent indices. Only the first version narrows these indices.
+                       auto guard = create_entry_block_alloca(
+                           env.get_current_function(), env.map_qubus_type(types::bool_()),
+                           nullptr, "narrowing_guard");
+
+                       auto guard_ref = reference(guard, access_path(), types::bool_());
+
+                       store_to_ref(guard_ref,
+                                    emit_index_narrowing_guard(narrowable_indices, comp), env,
+                                    ctx);
+
+                       emit_if_else(guard_ref,
+                                    [&] {
+                                        for (const auto& index : narrowable_indices)
+                                        {
+                                            ctx.permit_index_narrowing(index);
+                                        }
+
+                                        emit_loop_nest();
+
+                                        for (const auto& index : narrowable_indices)
+                                        {
+                                            ctx.revoke_index_narrowing(index);
+                                        }
+                                    },
+                                    emit_loop_nest, env, ctx);
 
                        return reference();
                    })
@@ -4,9 +4,11 @@
 
 #include <boost/range/iterator_range_core.hpp>
 
+#include <algorithm>
 #include <fstream>
 #include <regex>
 #include <map>
+#include <string>
 
 namespace qubus
 {
@@ -119,4 +121,114 @@ util::index_t get_prefered_alignment()
 
 #endif
 
+#if defined(__x86_64__) && defined(__linux__)
+
+std::vector<util::index_t> get_host_data_cache_sizes()
+{
+    std::map<long int, util::index_t> cache_sizes;
+
+    for (int index = 0;; ++index)
+    {
+        std::string cache_path = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index);
+
+        std::ifstream level_file(cache_path + "/level");
+        std::ifstream type_file(cache_path + "/type");
+        std::ifstream size_file(cache_path + "/size");
+
+        if (!level_file.is_open() || !type_file.is_open() || !size_file.is_open())
+            break;
+
+        long int level;
+        std::string type;
+        std::string size;
+
+        if (!(level_file >> level) || !(type_file >> type) || !(size_file >> size))
+            break;
+
+        if (type != "Data" && type != "Unified")
+            continue;
+
+        std::smatch results;
+
+        if (!std::regex_match(size, results, std::regex("(\\d+)([KMG]?)")))
+            continue;
+
+        util::index_t size_in_bytes = std::stol(results[1].str());
+
+        if (results[2] == "K")
+        {
+            size_in_bytes *= 1024;
+        }
+        else if (results[2] == "M")
+        {
+            size_in_bytes *= 1024 * 1024;
+        }
+        else if (results[2] == "G")
+        {
+            size_in_bytes *= 1024 * 1024 * 1024;
+        }
+
+        cache_sizes[level] = size_in_bytes;
+    }
+
+    std::vector<util::index_t> result;
+
+    for (const auto& entry : cache_sizes)
+    {
+        result.push_back(entry.second);
+    }
+
+    // Fall back to typical sizes if the cache hierarchy is not exposed.
+    if (result.empty())
+    {
+        result = {32 * 1024, 256 * 1024};
+    }
+
+    return result;
+}
+
+#else
+
+#error "get_host_data_cache_sizes is not implemented for this architecture."
+
+#endif
+
+#if defined(__x86_64__) && defined(__linux__)
+
+namespace
+{
+bool has_host_cpu_feature(const std::string& feature)
+{
+    auto features = get_host_cpu_features();
+
+    return std::find(features.begin(), features.end(), feature) != features.end();
+}
+}
+
+util::index_t get_host_vector_register_size()
+{
+    if (has_host_cpu_feature("avx512f"))
+        return 64;
+
+    if (has_host_cpu_feature("avx"))
+        return 32;
+
+    // SSE2 is part of x86-64.
+    return 16;
+}
+
+util::index_t get_host_number_of_vector_registers()
+{
+    if (has_host_cpu_feature("avx512f"))
+        return 32;
+
+    return 16;
+}
+
+#else
+
+#error "get_host_vector_register_size is not implemented for this architecture."
+
+#endif
+
 }
\ No newline at end of file
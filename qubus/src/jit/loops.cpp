@@ -1,19 +1,48 @@
 #include <qubus/jit/loops.hpp>
 
+#include <qubus/jit/entry_block_alloca.hpp>
 #include <qubus/jit/load_store.hpp>
 
+#include <llvm/IR/Constants.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/IR/Metadata.h>
 #include <llvm/IR/Value.h>
 #include <llvm/IR/BasicBlock.h>
 
+#include <llvm/ADT/SmallVector.h>
+
 namespace qubus
 {
 namespace jit
 {
 
+namespace
+{
+
+llvm::MDNode* create_vectorization_hint(llvm::LLVMContext& llvm_ctx)
+{
+    llvm::SmallVector<llvm::Metadata*, 2> loop_properties;
+
+    // The first operand of a loop id is a reference to itself.
+    auto placeholder = llvm::MDNode::getTemporary(llvm_ctx, llvm::None);
+    loop_properties.push_back(placeholder.get());
+
+    llvm::Metadata* enable_vectorization[] = {
+        llvm::MDString::get(llvm_ctx, "llvm.loop.vectorize.enable"),
+        llvm::ConstantAsMetadata::get(llvm::ConstantInt::getTrue(llvm_ctx))};
+
+    loop_properties.push_back(llvm::MDNode::get(llvm_ctx, enable_vectorization));
+
+    auto loop_id = llvm::MDNode::get(llvm_ctx, loop_properties);
+    loop_id->replaceOperandWith(0, loop_id);
+
+    return loop_id;
+}
+}
+
 void emit_loop(reference induction_variable, llvm::Value* lower_bound, llvm::Value* upper_bound,
                llvm::Value* increment, std::function<void()> body_emitter, llvm_environment& env,
-               compilation_context& ctx)
+               compilation_context& ctx, bool vectorize)
 {
     auto& builder_ = env.builder();
 
@@ -46,7 +75,12 @@ void emit_loop(reference induction_variable, llvm::Value* lower_bound, llvm::Val
                  builder_.CreateAdd(induction_variable_value2, increment, "", true, true), env,
                  ctx);
 
-    builder_.CreateBr(header);
+    auto latch = builder_.CreateBr(header);
+
+    if (vectorize)
+    {
+        latch->setMetadata(llvm::LLVMContext::MD_loop, create_vectorization_hint(env.ctx()));
+    }
 
     body = builder_.GetInsertBlock();
 
@@ -54,5 +88,36 @@ void emit_loop(reference induction_variable, llvm::Value* lower_bound, llvm::Val
 
     builder_.SetInsertPoint(exit);
 }
+
+void emit_narrow_loop(reference induction_variable, llvm::Value* lower_bound,
+                      llvm::Value* upper_bound, llvm::Value* increment,
+                      std::function<void()> body_emitter, llvm_environment& env,
+                      compilation_context& ctx, bool vectorize)
+{
+    auto& builder_ = env.builder();
+
+    llvm::Type* narrow_type = builder_.getInt32Ty();
+    llvm::Type* size_type = env.map_qubus_type(types::integer());
+
+    llvm::Value* counter =
+        create_entry_block_alloca(env.get_current_function(), narrow_type, nullptr, "ind32");
+
+    auto counter_ref = reference(counter, access_path(), types::integer());
+
+    auto narrow_lower_bound = builder_.CreateTrunc(lower_bound, narrow_type);
+    auto narrow_upper_bound = builder_.CreateTrunc(upper_bound, narrow_type);
+    auto narrow_increment = builder_.CreateTrunc(increment, narrow_type);
+
+    emit_loop(counter_ref, narrow_lower_bound, narrow_upper_bound, narrow_increment,
+              [&] {
+                  auto counter_value = load_from_ref(counter_ref, env, ctx);
+
+                  store_to_ref(induction_variable, builder_.CreateSExt(counter_value, size_type),
+                               env, ctx);
+
+                  body_emitter();
+              },
+              env, ctx, vectorize);
+}
 }
 }
\ No newline at end of file
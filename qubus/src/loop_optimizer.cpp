@@ -1,15 +1,14 @@
-#if 0
 #include <qubus/loop_optimizer.hpp>
 
-#include <qubus/lower_abstract_indices.hpp>
-
-#include <qubus/IR/pretty_printer.hpp>
-
-#include <qubus/IR/extract.hpp>
+#include <qubus/abi_info.hpp>
+#include <qubus/dependence_analysis.hpp>
+#include <qubus/exception.hpp>
+#include <qubus/pass_manager.hpp>
 
 #include <qubus/IR/qir.hpp>
 #include <qubus/pattern/IR.hpp>
 #include <qubus/pattern/core.hpp>
+#include <qubus/pattern/substitute.hpp>
 
 #include <qubus/isl/ast_builder.hpp>
 #include <qubus/isl/constraint.hpp>
@@ -17,39 +16,40 @@
 #include <qubus/isl/flow.hpp>
 #include <qubus/isl/map.hpp>
 #include <qubus/isl/multi_union_pw_affine_expr.hpp>
+#include <qubus/isl/pw_aff.hpp>
 #include <qubus/isl/pw_multi_aff.hpp>
 #include <qubus/isl/schedule.hpp>
 #include <qubus/isl/set.hpp>
 
+#include <qubus/util/assert.hpp>
+#include <qubus/util/cloning_ptr.hpp>
 #include <qubus/util/integers.hpp>
-#include <qubus/util/numeric/bisection.hpp>
-#include <qubus/util/numeric/polynomial.hpp>
 #include <qubus/util/unique_name_generator.hpp>
 #include <qubus/util/unused.hpp>
-#include <qubus/util/cloning_ptr.hpp>
+
+#include <isl/options.h>
 
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/optional.hpp>
 #include <boost/range/algorithm.hpp>
 #include <boost/variant.hpp>
 
-#include <cassert>
+#include <algorithm>
 #include <map>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
-#include <iostream>
-#include <qubus/IR/pretty_printer.hpp>
-#include <qubus/isl/printer.hpp>
-
 namespace qubus
 {
 
 namespace
 {
 
-isl::context isl_ctx;
-
 struct array_substitution
 {
     array_substitution(variable_declaration parent, std::unique_ptr<macro_expr> substitution)
@@ -61,14 +61,62 @@ struct array_substitution
     std::unique_ptr<macro_expr> substitution;
 };
 
+struct cache_info
+{
+    cache_info(variable_declaration parent, std::unique_ptr<macro_expr> substitution)
+    : parent(std::move(parent)), substitution(std::move(substitution))
+    {
+    }
+
+    variable_declaration parent;
+    util::cloning_ptr<macro_expr> substitution;
+};
+
+/** \brief Signals that a SCoP can not be optimized.
+ *
+ * The loop optimizer falls back to the original code if this exception is raised.
+ */
+class loop_optimization_error : public virtual exception, public virtual std::runtime_error
+{
+public:
+    explicit loop_optimization_error(const std::string& reason_)
+    : std::runtime_error("Loop optimization failed: " + reason_)
+    {
+    }
+};
+
+class isl_budget_exceeded_error : public virtual exception, public virtual std::runtime_error
+{
+public:
+    isl_budget_exceeded_error()
+    : std::runtime_error("The isl operation budget has been exceeded.")
+    {
+    }
+};
+
+/** \brief Throws if isl has stopped an operation since the operation budget has been exceeded.
+ *
+ * All isl objects created after the budget has been exceeded are invalid.
+ */
+void check_isl_budget(isl::context_ref isl_ctx)
+{
+    if (isl_ctx_last_error(isl_ctx.native_handle()) == isl_error_quota)
+        throw isl_budget_exceeded_error();
+}
+
 struct ast_converter_context
 {
-    explicit ast_converter_context(std::map<std::string, std::unique_ptr<expression>> symbol_table)
-    : symbol_table(std::move(symbol_table)), array_subs_scopes(1)
+    explicit ast_converter_context(std::map<std::string, std::unique_ptr<expression>> symbol_table,
+                                   std::map<std::string, cache_info> cache_table = {})
+    : symbol_table(std::move(symbol_table)),
+      cache_table(std::move(cache_table)),
+      array_subs_scopes(1)
     {
     }
 
     std::map<std::string, std::unique_ptr<expression>> symbol_table;
+    std::map<std::string, cache_info> cache_table;
+    std::map<std::string, execution_order> loop_orders;
     std::vector<array_substitution> array_substitutions;
     std::vector<std::vector<variable_declaration>> array_subs_scopes;
 };
@@ -107,12 +155,16 @@ isl::union_map pad_schedule_map(isl::union_map schedule_map)
 
 struct scop
 {
-    scop(isl::union_set domain, isl::set QUBUS_UNUSED(param_constraints), isl::union_map schedule,
+    scop(isl::context_ref isl_ctx, isl::union_set domain,
+         isl::set QUBUS_UNUSED(param_constraints), isl::union_map schedule,
          isl::union_map write_accesses, isl::union_map read_accesses,
          std::map<std::string, std::unique_ptr<expression>> symbol_table,
          std::map<std::string, variable_declaration> tensor_table)
-    : schedule(isl::schedule::from_domain(domain)), write_accesses(std::move(write_accesses)),
-      read_accesses(std::move(read_accesses)), symbol_table(std::move(symbol_table)),
+    : isl_ctx(isl_ctx), schedule(isl::schedule::from_domain(domain)),
+      write_accesses(std::move(write_accesses)),
+      read_accesses(std::move(read_accesses)),
+      dependences(isl::union_map::empty(isl::space(isl_ctx, 0, 0, 0))),
+      symbol_table(std::move(symbol_table)),
       tensor_table(std::move(tensor_table))
     {
         auto part_sched =
@@ -145,18 +197,26 @@ struct scop
         return unique_id;
     }
 
+    isl::context_ref isl_ctx;
+
     isl::schedule schedule;
 
     isl::union_map write_accesses;
     isl::union_map read_accesses;
 
+    /** \brief The dependences which constrain the schedule of the SCoP.
+     */
+    isl::union_map dependences;
+
     std::map<std::string, std::unique_ptr<expression>> symbol_table;
     std::map<std::string, variable_declaration> tensor_table;
+    std::map<std::string, cache_info> cache_table;
 };
 
 struct scop_ctx
 {
-    scop_ctx() : domain(isl::set::universe(isl::space(isl_ctx, 0, 0))), scatter_index{0}
+    explicit scop_ctx(isl::context_ref isl_ctx)
+    : domain(isl::set::universe(isl::space(isl_ctx, 0, 0))), scatter_index{0}
     {
     }
 
@@ -168,8 +228,9 @@ struct scop_ctx
 struct scop_info
 {
 public:
-    scop_info()
-    : param_constraints(isl::set::universe(isl::space(isl_ctx, 0))),
+    explicit scop_info(isl::context_ref isl_ctx)
+    : isl_ctx(isl_ctx),
+      param_constraints(isl::set::universe(isl::space(isl_ctx, 0))),
       domain(isl::union_set::empty(isl::space(isl_ctx, 0, 0))),
       schedule(isl::union_map::empty(isl::space(isl_ctx, 0, 0, 0))),
       write_accesses(isl::union_map::empty(isl::space(isl_ctx, 0, 0))),
@@ -224,6 +285,19 @@ public:
         return id;
     }
 
+    std::string add_parameter(const expression& expr)
+    {
+        // Structurally equal bounds have to be represented by the same parameter.
+        // Otherwise, isl is unable to prove that e.g. two loops have the same trip count.
+        for (const auto& symbol : symbol_table)
+        {
+            if (*symbol.second == expr)
+                return symbol.first;
+        }
+
+        return add_symbol(clone(expr));
+    }
+
     void add_partial_schedule(isl::set partial_domain, isl::map partial_schedule)
     {
         domain = isl::add_set(domain, partial_domain);
@@ -235,6 +309,8 @@ public:
         param_constraints = intersect_params(param_constraints, constraint);
     }
 
+    isl::context_ref isl_ctx;
+
     scop build_scop()
     {
         std::map<std::string, variable_declaration> reverse_tensor_table;
@@ -244,7 +320,7 @@ public:
             reverse_tensor_table.emplace(entry.second, entry.first);
         }
 
-        return scop(std::move(domain), std::move(param_constraints), std::move(schedule),
+        return scop(isl_ctx, std::move(domain), std::move(param_constraints), std::move(schedule),
                     std::move(write_accesses), std::move(read_accesses), std::move(symbol_table),
                     std::move(reverse_tensor_table));
     }
@@ -281,9 +357,9 @@ bound extract_bound(const expression& expr, scop_info& ctx)
     auto m = pattern::make_matcher<expression, bound>()
                  .case_(integer_literal(value), [&] { return bound(value.get()); })
                  .case_(a, [&] {
-                     auto name = ctx.add_symbol(clone(a.get()));
+                     auto name = ctx.add_parameter(a.get());
 
-                     isl::space s(isl_ctx, 1);
+                     isl::space s(ctx.isl_ctx, 1);
                      s.set_dim_name(isl_dim_param, 0, name);
 
                      auto param_constraint = isl::basic_set::universe(s);
@@ -303,13 +379,14 @@ bound extract_bound(const expression& expr, scop_info& ctx)
 struct local_domain_builder : boost::static_visitor<isl::basic_set>
 {
 public:
-    explicit local_domain_builder(std::string idx_name_) : idx_name_(idx_name_)
+    local_domain_builder(isl::context_ref isl_ctx_, std::string idx_name_)
+    : isl_ctx_(isl_ctx_), idx_name_(idx_name_)
     {
     }
 
-    isl::basic_set operator()(int lower_bound, int upper_bound) const
+    isl::basic_set operator()(util::index_t lower_bound, util::index_t upper_bound) const
     {
-        isl::space space(isl_ctx, 0, 1);
+        isl::space space(isl_ctx_, 0, 1);
 
         space.set_dim_name(isl_dim_set, 0, idx_name_);
 
@@ -317,11 +394,11 @@ public:
 
         auto lower_bound_constraint = isl::constraint::inequality(space)
                                           .set_coefficient(isl_dim_set, 0, 1)
-                                          .set_constant(lower_bound);
+                                          .set_constant(isl::value(isl_ctx_, -lower_bound));
 
         auto upper_bound_constraint = isl::constraint::inequality(space)
                                           .set_coefficient(isl_dim_set, 0, -1)
-                                          .set_constant(upper_bound - 1);
+                                          .set_constant(isl::value(isl_ctx_, upper_bound - 1));
 
         local_domain.add_constraint(lower_bound_constraint);
         local_domain.add_constraint(upper_bound_constraint);
@@ -329,9 +406,9 @@ public:
         return local_domain;
     }
 
-    isl::basic_set operator()(int lower_bound, const std::string& upper_bound) const
+    isl::basic_set operator()(util::index_t lower_bound, const std::string& upper_bound) const
     {
-        isl::space space(isl_ctx, 1, 1);
+        isl::space space(isl_ctx_, 1, 1);
 
         space.set_dim_name(isl_dim_param, 0, upper_bound);
 
@@ -341,7 +418,7 @@ public:
 
         auto lower_bound_constraint = isl::constraint::inequality(space)
                                           .set_coefficient(isl_dim_set, 0, 1)
-                                          .set_constant(lower_bound);
+                                          .set_constant(isl::value(isl_ctx_, -lower_bound));
 
         auto upper_bound_constraint = isl::constraint::inequality(space)
                                           .set_coefficient(isl_dim_set, 0, -1)
@@ -354,9 +431,9 @@ public:
         return local_domain;
     }
 
-    isl::basic_set operator()(const std::string& lower_bound, int upper_bound) const
+    isl::basic_set operator()(const std::string& lower_bound, util::index_t upper_bound) const
     {
-        isl::space space(isl_ctx, 1, 1);
+        isl::space space(isl_ctx_, 1, 1);
 
         space.set_dim_name(isl_dim_param, 0, lower_bound);
 
@@ -366,11 +443,11 @@ public:
 
         auto lower_bound_constraint = isl::constraint::inequality(space)
                                           .set_coefficient(isl_dim_set, 0, 1)
-                                          .set_coefficient(isl_dim_param, 0, 1);
+                                          .set_coefficient(isl_dim_param, 0, -1);
 
         auto upper_bound_constraint = isl::constraint::inequality(space)
                                           .set_coefficient(isl_dim_set, 0, -1)
-                                          .set_constant(upper_bound - 1);
+                                          .set_constant(isl::value(isl_ctx_, upper_bound - 1));
 
         local_domain.add_constraint(lower_bound_constraint);
         local_domain.add_constraint(upper_bound_constraint);
@@ -380,7 +457,7 @@ public:
 
     isl::basic_set operator()(const std::string& lower_bound, const std::string& upper_bound) const
     {
-        isl::space space(isl_ctx, 2, 1);
+        isl::space space(isl_ctx_, 2, 1);
 
         space.set_dim_name(isl_dim_param, 0, lower_bound);
         space.set_dim_name(isl_dim_param, 1, upper_bound);
@@ -391,7 +468,7 @@ public:
 
         auto lower_bound_constraint = isl::constraint::inequality(space)
                                           .set_coefficient(isl_dim_set, 0, 1)
-                                          .set_coefficient(isl_dim_param, 0, 1);
+                                          .set_coefficient(isl_dim_param, 0, -1);
 
         auto upper_bound_constraint = isl::constraint::inequality(space)
                                           .set_coefficient(isl_dim_set, 0, -1)
@@ -405,34 +482,297 @@ public:
     }
 
 private:
+    isl::context_ref isl_ctx_;
     std::string idx_name_;
 };
 
-bool is_scop(const expression& expr)
+bool is_loop_index(const expression& expr, const std::vector<variable_declaration>& loop_indices)
+{
+    if (auto ref = expr.try_as<variable_ref_expr>())
+    {
+        return std::find(loop_indices.begin(), loop_indices.end(), ref->declaration()) !=
+               loop_indices.end();
+    }
+
+    return false;
+}
+
+bool refers_to_loop_index(const expression& expr,
+                          const std::vector<variable_declaration>& loop_indices)
+{
+    pattern::variable<variable_declaration> decl;
+
+    bool result = false;
+
+    auto m = pattern::make_matcher<expression, void>().case_(variable_ref(decl), [&] {
+        if (std::find(loop_indices.begin(), loop_indices.end(), decl.get()) != loop_indices.end())
+        {
+            result = true;
+        }
+    });
+
+    pattern::for_each(expr, m);
+
+    return result;
+}
+
+/** \brief Affine function of the loop indices.
+ *
+ * The coefficients are indexed by the ids of the loop indices.
+ */
+struct affine_index
+{
+    std::map<util::handle, util::index_t> coefficients;
+    util::index_t constant = 0;
+};
+
+affine_index scale(affine_index index, util::index_t factor)
+{
+    for (auto& coefficient : index.coefficients)
+    {
+        coefficient.second *= factor;
+    }
+
+    index.constant *= factor;
+
+    return index;
+}
+
+affine_index add(affine_index lhs, const affine_index& rhs)
+{
+    for (const auto& coefficient : rhs.coefficients)
+    {
+        lhs.coefficients[coefficient.first] += coefficient.second;
+    }
+
+    lhs.constant += rhs.constant;
+
+    return lhs;
+}
+
+boost::optional<affine_index>
+extract_affine_index(const expression& expr, const std::vector<variable_declaration>& loop_indices)
+{
+    using pattern::_;
+
+    pattern::variable<const expression &> a, b;
+    pattern::variable<util::index_t> value;
+
+    auto extract = [&](const expression& operand) {
+        return extract_affine_index(operand, loop_indices);
+    };
+
+    auto m =
+        pattern::make_matcher<expression, boost::optional<affine_index>>()
+            .case_(variable_ref(_),
+                   [&]() -> boost::optional<affine_index> {
+                       if (!is_loop_index(expr, loop_indices))
+                           return boost::none;
+
+                       affine_index result;
+                       result.coefficients[expr.as<variable_ref_expr>().declaration().id()] = 1;
+
+                       return result;
+                   })
+            .case_(integer_literal(value),
+                   [&] {
+                       affine_index result;
+                       result.constant = value.get();
+
+                       return boost::make_optional(result);
+                   })
+            .case_(a + b,
+                   [&]() -> boost::optional<affine_index> {
+                       auto lhs = extract(a.get());
+                       auto rhs = extract(b.get());
+
+                       if (!lhs || !rhs)
+                           return boost::none;
+
+                       return add(*lhs, *rhs);
+                   })
+            .case_(a - b,
+                   [&]() -> boost::optional<affine_index> {
+                       auto lhs = extract(a.get());
+                       auto rhs = extract(b.get());
+
+                       if (!lhs || !rhs)
+                           return boost::none;
+
+                       return add(*lhs, scale(*rhs, -1));
+                   })
+            .case_(integer_literal(value) * a,
+                   [&]() -> boost::optional<affine_index> {
+                       auto arg = extract(a.get());
+
+                       if (!arg)
+                           return boost::none;
+
+                       return scale(*arg, value.get());
+                   })
+            .case_(a * integer_literal(value),
+                   [&]() -> boost::optional<affine_index> {
+                       auto arg = extract(a.get());
+
+                       if (!arg)
+                           return boost::none;
+
+                       return scale(*arg, value.get());
+                   })
+            .case_(-a,
+                   [&]() -> boost::optional<affine_index> {
+                       auto arg = extract(a.get());
+
+                       if (!arg)
+                           return boost::none;
+
+                       return scale(*arg, -1);
+                   })
+            .case_(_, [] { return boost::none; });
+
+    return pattern::match(expr, m);
+}
+
+// Only accesses of the form A[f(i, j, ...), ...], where all indices are affine functions of
+// the loop indices such as A[i, j - 1] or A[t + 1, 2 * i], are modeled by analyze_accesses.
+bool is_analyzable_access(const expression& expr,
+                          const std::vector<variable_declaration>& loop_indices)
 {
-    auto m = pattern::make_matcher<expression, bool>().case_(pattern::sparse_tensor(),
-                                                             [] { return true; });
+    using pattern::_;
+
+    pattern::variable<std::vector<std::reference_wrapper<expression>>> indices;
+
+    auto m = pattern::make_matcher<expression, bool>()
+                 .case_(subscription(variable_ref(_), indices),
+                        [&] {
+                            return std::all_of(
+                                indices.get().begin(), indices.get().end(),
+                                [&](const expression& index) {
+                                    return static_cast<bool>(
+                                        extract_affine_index(index, loop_indices));
+                                });
+                        })
+                 .case_(_, [] { return false; });
+
+    return pattern::match(expr, m);
+}
+
+bool is_scop_operand(const expression& expr, const std::vector<variable_declaration>& loop_indices)
+{
+    using pattern::_;
+
+    pattern::variable<const expression &> a, b;
+    pattern::variable<binary_op_tag> tag;
+    pattern::variable<std::vector<std::reference_wrapper<expression>>> args;
+
+    auto is_operand = [&](const expression& operand) {
+        return is_scop_operand(operand, loop_indices);
+    };
+
+    auto m = pattern::make_matcher<expression, bool>()
+                 .case_(subscription(_, _),
+                        [&] { return is_analyzable_access(expr, loop_indices); })
+                 .case_(binary_operator(tag, a, b),
+                        [&] {
+                            if (tag.get() == binary_op_tag::assign ||
+                                tag.get() == binary_op_tag::plus_assign)
+                                return false;
+
+                            return is_operand(a.get()) && is_operand(b.get());
+                        })
+                 .case_(unary_operator(_, a), [&] { return is_operand(a.get()); })
+                 .case_(type_conversion(_, a), [&] { return is_operand(a.get()); })
+                 .case_(intrinsic_function(_, args),
+                        [&] {
+                            return std::all_of(args.get().begin(), args.get().end(), is_operand);
+                        })
+                 .case_(variable_ref(_), [] { return true; })
+                 .case_(double_literal(_), [] { return true; })
+                 .case_(float_literal(_), [] { return true; })
+                 .case_(integer_literal(_), [] { return true; })
+                 .case_(bool_literal(_), [] { return true; })
+                 .case_(_, [] { return false; });
+
+    return pattern::match(expr, m);
+}
+
+bool is_scop_(const expression& expr, std::vector<variable_declaration> loop_indices,
+              long int& number_of_statements)
+{
+    using pattern::_;
+
+    pattern::variable<const expression &> a, b, c;
+    pattern::variable<variable_declaration> idx;
+    pattern::variable<std::vector<std::reference_wrapper<expression>>> subexprs;
+
+    auto is_bound = [&](const expression& bound) {
+        return is_scop_operand(bound, {}) && !refers_to_loop_index(bound, loop_indices);
+    };
+
+    auto m = pattern::make_matcher<expression, bool>()
+                 .case_(for_(idx, a, b, c),
+                        [&] {
+                            if (!is_bound(a.get()) || !is_bound(b.get()))
+                                return false;
+
+                            loop_indices.push_back(idx.get());
+
+                            return is_scop_(c.get(), loop_indices, number_of_statements);
+                        })
+                 .case_(compound(subexprs),
+                        [&] {
+                            return std::all_of(subexprs.get().begin(), subexprs.get().end(),
+                                               [&](const expression& sub_expr) {
+                                                   return is_scop_(sub_expr, loop_indices,
+                                                                   number_of_statements);
+                                               });
+                        })
+                 .case_(assign(a, b),
+                        [&] {
+                            ++number_of_statements;
+
+                            return is_analyzable_access(a.get(), loop_indices) &&
+                                   is_scop_operand(b.get(), loop_indices);
+                        })
+                 .case_(plus_assign(a, b),
+                        [&] {
+                            ++number_of_statements;
 
-    auto result = pattern::search(expr, m);
+                            return is_analyzable_access(a.get(), loop_indices) &&
+                                   is_scop_operand(b.get(), loop_indices);
+                        })
+                 .case_(_, [] { return false; });
 
-    return !result;
+    return pattern::match(expr, m);
 }
 
-isl::union_map analyze_accesses(const expression& expr, const isl::set& domain, scop_info& ctx)
+// Conservatively checks if expr is a static control part which can be represented exactly
+// by analyze_scop. Loop bounds have to be invariant in the SCoP and all statements have to be
+// (compound) assignments to array elements which are addressed by loop indices.
+bool is_scop(const expression& expr)
+{
+    long int number_of_statements = 0;
+
+    return is_scop_(expr, {}, number_of_statements) && number_of_statements > 0;
+}
+
+isl::union_map analyze_accesses(const expression& expr, const isl::set& domain,
+                                const std::vector<variable_declaration>& loop_indices,
+                                scop_info& ctx)
 {
     pattern::variable<variable_declaration> decl;
     pattern::variable<std::vector<std::reference_wrapper<expression>>> indices;
 
-    isl::space no_access_space(isl_ctx, 0, 0);
+    isl::space no_access_space(ctx.isl_ctx, 0, 0);
     isl::union_map accesses = isl::union_map::empty(no_access_space);
 
-    auto m =
-        pattern::make_matcher<expression, void>().case_(subscription(tensor(decl), indices), [&] {
+    auto m = pattern::make_matcher<expression, void>().case_(
+        subscription(variable_ref(decl), indices), [&] {
             auto tensor_name = ctx.map_tensor_to_name(decl.get());
 
             auto number_of_indices = indices.get().size();
 
-            isl::space access_space(isl_ctx, 0, number_of_indices);
+            isl::space access_space(ctx.isl_ctx, 0, number_of_indices);
 
             access_space.set_tuple_name(isl_dim_set, tensor_name);
 
@@ -442,15 +782,24 @@ isl::union_map analyze_accesses(const expression& expr, const isl::set& domain,
 
             for (std::size_t i = 0; i < number_of_indices; ++i)
             {
-                auto decl = indices.get()[i].get().as<variable_ref_expr>().declaration();
+                auto index = extract_affine_index(indices.get()[i], loop_indices);
 
-                const auto& idx_name = ctx.map_index_to_name(decl.id());
+                QUBUS_ASSERT(index, "Index is not an affine function of the loop indices.");
 
-                auto idx = domain.get_space().find_dim_by_name(isl_dim_set, idx_name);
+                auto c = isl::constraint::equality(access.get_space())
+                             .set_coefficient(isl_dim_out, i, 1)
+                             .set_constant(isl::value(ctx.isl_ctx, -index->constant));
+
+                for (const auto& coefficient : index->coefficients)
+                {
+                    const auto& idx_name = ctx.map_index_to_name(coefficient.first);
+
+                    auto idx = domain.get_space().find_dim_by_name(isl_dim_set, idx_name);
+
+                    c.set_coefficient(isl_dim_in, idx, -coefficient.second);
+                }
 
-                access.add_constraint(isl::constraint::equality(access.get_space())
-                                          .set_coefficient(isl_dim_out, i, 1)
-                                          .set_coefficient(isl_dim_in, idx, -1));
+                access.add_constraint(c);
             }
 
             accesses = add_map(accesses, access);
@@ -461,22 +810,28 @@ isl::union_map analyze_accesses(const expression& expr, const isl::set& domain,
     return accesses;
 }
 
-void analyze_tensor_accesses(const expression& expr, const isl::set& domain, scop_info& ctx)
+void analyze_tensor_accesses(const expression& expr, const isl::set& domain,
+                             const std::vector<variable_declaration>& loop_indices,
+                             scop_info& ctx)
 {
     pattern::variable<const expression &> lhs, rhs;
 
+    auto analyze = [&](const expression& expr) {
+        return analyze_accesses(expr, domain, loop_indices, ctx);
+    };
+
     auto m = pattern::make_matcher<expression, void>()
                  .case_(binary_operator(pattern::value(binary_op_tag::assign), lhs, rhs),
                         [&] {
-                            auto write_accesses = analyze_accesses(lhs.get(), domain, ctx);
-                            auto read_accesses = analyze_accesses(rhs.get(), domain, ctx);
+                            auto write_accesses = analyze(lhs.get());
+                            auto read_accesses = analyze(rhs.get());
 
                             ctx.add_write_accesses(write_accesses);
                             ctx.add_read_accesses(read_accesses);
                         })
                  .case_(binary_operator(pattern::value(binary_op_tag::plus_assign), lhs, rhs), [&] {
-                     auto readwrite_accesses = analyze_accesses(lhs.get(), domain, ctx);
-                     auto read_accesses = analyze_accesses(rhs.get(), domain, ctx);
+                     auto readwrite_accesses = analyze(lhs.get());
+                     auto read_accesses = analyze(rhs.get());
 
                      ctx.add_write_accesses(readwrite_accesses);
                      ctx.add_read_accesses(read_accesses);
@@ -504,8 +859,9 @@ void analyze_scop_(const expression& expr, scop_info& info, scop_ctx ctx)
                             std::string idx_name = info.map_index_to_name(idx.get().id());
                             ctx.indices.push_back(idx.get());
 
-                            auto local_domain = boost::apply_visitor(local_domain_builder(idx_name),
-                                                                     lower_bound, upper_bound);
+                            auto local_domain = boost::apply_visitor(
+                                local_domain_builder(info.isl_ctx, idx_name), lower_bound,
+                                upper_bound);
 
                             // add dimension to the global iteration space
                             ctx.domain = flat_product(ctx.domain, local_domain);
@@ -536,12 +892,13 @@ void analyze_scop_(const expression& expr, scop_info& info, scop_ctx ctx)
                      long int number_of_indices = domain.get_space().dim(isl_dim_set);
                      long int number_of_dimensions = 2 * number_of_indices + 1;
 
-                     assert(number_of_indices + 1 == util::to_uindex(ctx.scatter_index.size()));
+                     QUBUS_ASSERT(number_of_indices + 1 == util::to_uindex(ctx.scatter_index.size()),
+                                  "Mismatch between the loop depth and the scattering index.");
 
                      isl::set scattering_domain =
                          isl::set::universe(drop_all_dims(domain.get_space(), isl_dim_param));
 
-                     isl::space scattering_range_space(isl_ctx, 0, number_of_dimensions);
+                     isl::space scattering_range_space(info.isl_ctx, 0, number_of_dimensions);
                      scattering_range_space.set_tuple_name(isl_dim_set, "scattering");
 
                      isl::set scattering_range = isl::set::universe(scattering_range_space);
@@ -562,7 +919,7 @@ void analyze_scop_(const expression& expr, scop_info& info, scop_ctx ctx)
                                                        .set_coefficient(isl_dim_in, i, -1));
                      }
 
-                     analyze_tensor_accesses(a.get(), domain, info);
+                     analyze_tensor_accesses(a.get(), domain, ctx.indices, info);
 
                      info.add_partial_schedule(domain, scattering);
 
@@ -572,11 +929,11 @@ void analyze_scop_(const expression& expr, scop_info& info, scop_ctx ctx)
     pattern::match(expr, m);
 }
 
-scop analyze_scop(const expression& expr)
+scop analyze_scop(const expression& expr, isl::context_ref isl_ctx)
 {
-    scop_info info;
+    scop_info info(isl_ctx);
 
-    scop_ctx ctx;
+    scop_ctx ctx(isl_ctx);
 
     analyze_scop_(expr, info, ctx);
 
@@ -640,7 +997,7 @@ isl::map turn_dims_into_params(isl::map m, isl_dim_type type, int pos, int n)
     case isl_dim_out:
         return apply_range(m, dims_to_params);
     default:
-        throw 0; // TODO: Throw exception.
+        throw loop_optimization_error("Unsupported dimension type.");
     }
 }
 
@@ -674,15 +1031,15 @@ boost::optional<array_tile> deduce_tile(isl::map write_schedule, isl::map local_
     {
         auto outer_dim_name = "outer_dim" + std::to_string(i);
 
-        write_schedule.set_dim_id(isl_dim_in, i, isl::id(isl_ctx, outer_dim_name));
+        write_schedule.set_dim_id(isl_dim_in, i, isl::id(s.isl_ctx, outer_dim_name));
         parametrized_write_schedule.set_dim_id(isl_dim_param, i + write_schedule.dim(isl_dim_param),
-                                               isl::id(isl_ctx, outer_dim_name));
+                                               isl::id(s.isl_ctx, outer_dim_name));
     }
 
     auto iter_space_dim = local_access_schedule.dim(isl_dim_in);
 
     auto current_to_next_iter =
-        isl::map::universe(isl::space(isl_ctx, 0, iter_space_dim, iter_space_dim));
+        isl::map::universe(isl::space(s.isl_ctx, 0, iter_space_dim, iter_space_dim));
 
     for (int i = 0; i < iter_space_dim; ++i)
     {
@@ -705,7 +1062,14 @@ boost::optional<array_tile> deduce_tile(isl::map write_schedule, isl::map local_
 
     isl::schedule layout_schedule(constraints);
 
-    auto layout_transform = layout_schedule.get_map().get_maps()[0];
+    check_isl_budget(s.isl_ctx);
+
+    auto layout_transforms = layout_schedule.get_map().get_maps();
+
+    if (layout_transforms.empty())
+        return boost::none;
+
+    auto layout_transform = layout_transforms[0];
     layout_transform.set_tuple_name(isl_dim_out,
                                     write_schedule.get_tuple_name(isl_dim_out) + "_scratch");
 
@@ -726,9 +1090,11 @@ boost::optional<array_tile> deduce_tile(isl::map write_schedule, isl::map local_
             auto max = lexmax_pw_multi_aff(red_set)[0];
             auto min = lexmin_pw_multi_aff(red_set)[0];
 
+            check_isl_budget(s.isl_ctx);
+
             auto diff = max - min;
 
-            auto one = isl::pw_aff::from_val(diff.domain(), isl::value(isl_ctx, 1));
+            auto one = isl::pw_aff::from_val(diff.domain(), isl::value(s.isl_ctx, 1));
 
             auto local_sizes = set_from_pw_aff(diff + one);
 
@@ -739,6 +1105,8 @@ boost::optional<array_tile> deduce_tile(isl::map write_schedule, isl::map local_
             {
                 auto size = lexmax_pw_multi_aff(global_sizes)[0];
 
+                check_isl_budget(s.isl_ctx);
+
                 if (size.is_cst())
                 {
                     origin.push_back(min);
@@ -765,14 +1133,17 @@ boost::optional<array_tile> deduce_tile(isl::map write_schedule, isl::map local_
 
     for (const auto offset : origin)
     {
-        isl::space s(isl_ctx, 0, 1, 1);
+        isl::space offset_space(s.isl_ctx, 0, 1, 1);
 
         auto ident = isl::pw_multi_aff::from_map(
-            align_params(isl::map::identity(s), offset.domain().get_space()))[0];
+            align_params(isl::map::identity(offset_space), offset.domain().get_space()))[0];
         auto offset2 = isl::pw_multi_aff::from_map(
-            align_params(intersect_range(isl::map::universe(s), set_from_pw_aff(offset)),
+            align_params(intersect_range(isl::map::universe(offset_space),
+                                         set_from_pw_aff(offset)),
                          offset.domain().get_space()))[0];
 
+        check_isl_budget(s.isl_ctx);
+
         auto pos = ident - offset2;
 
         auto shift_transform = isl::map(isl_map_from_pw_aff(pos.release()));
@@ -829,7 +1200,7 @@ std::vector<array_tile> deduce_tiles(isl::schedule_node node, const scop& s)
         });
 
         if (iter == local_writes_schedules.end())
-            throw 0;
+            throw loop_optimization_error("No local schedule for write access.");
 
         if (auto tile = deduce_tile(schedule, *iter, true, s))
         {
@@ -849,7 +1220,7 @@ std::vector<array_tile> deduce_tiles(isl::schedule_node node, const scop& s)
         });
 
         if (iter == local_read_schedules.end())
-            throw 0;
+            throw loop_optimization_error("No local schedule for read access.");
 
         if (auto tile = deduce_tile(schedule, *iter, false, s))
         {
@@ -869,13 +1240,13 @@ enum class cache_copy_direction
 isl::schedule_node create_cache_copy(const array_tile& tile, variable_declaration cache_decl,
                                      cache_copy_direction direction, bool unroll_loops, scop& s)
 {
-    isl::ast_builder builder(isl_ctx);
+    isl::ast_builder builder(s.isl_ctx);
 
     const auto& map = tile.access_schedule;
 
     auto dim = map.dim(isl_dim_in) + map.dim(isl_dim_out);
 
-    isl::space ms(isl_ctx, 0, map.dim(isl_dim_out), dim);
+    isl::space ms(s.isl_ctx, 0, map.dim(isl_dim_out), dim);
     auto m = isl::basic_map::universe(ms);
 
     for (int i = map.dim(isl_dim_in); i < dim; ++i)
@@ -891,7 +1262,7 @@ isl::schedule_node create_cache_copy(const array_tile& tile, variable_declaratio
 
     for (int i = 0; i < dim; ++i)
     {
-        params.emplace_back(types::integer());
+        params.emplace_back("i" + std::to_string(i), types::integer());
     }
 
     std::map<std::string, std::unique_ptr<expression>> local_symbol_table;
@@ -952,7 +1323,7 @@ isl::schedule_node create_cache_copy(const array_tile& tile, variable_declaratio
         }
         else
         {
-            throw 0;
+            throw loop_optimization_error("Unknown copy direction.");
         }
     }();
 
@@ -976,7 +1347,7 @@ isl::schedule_node create_cache_copy(const array_tile& tile, variable_declaratio
 
     auto local_dim = extension.dim(isl_dim_out) - prefix_dim;
 
-    isl::space local_iter_space(isl_ctx, 0, local_dim);
+    isl::space local_iter_space(s.isl_ctx, 0, local_dim);
     auto s2 = isl::basic_set::universe(local_iter_space);
 
     auto copy_schedule = make_map_from_domain_and_range(extension.range(), s2);
@@ -1008,31 +1379,34 @@ isl::schedule_node create_cache_copy(const array_tile& tile, variable_declaratio
     return extension_root;
 }
 
-struct cache_info
+/** \brief Selects the arrays for which caches are introduced.
+ */
+enum class cache_selection
 {
-    cache_info(variable_declaration parent, std::unique_ptr<macro_expr> substitution)
-    : parent(std::move(parent)), substitution(std::move(substitution))
-    {
-    }
-
-    variable_declaration parent;
-    util::cloning_ptr<macro_expr> substitution;
+    all,
+    read_only,
+    mutable_only
 };
 
-isl::schedule_node create_caches(isl::schedule_node band_to_tile, bool unroll_loops, scop& s)
+isl::schedule_node create_caches(isl::schedule_node band_to_tile, bool unroll_loops,
+                                 cache_selection selection, scop& s)
 {
-    isl::ast_builder builder(isl_ctx);
+    isl::ast_builder builder(s.isl_ctx);
 
     auto tiles = deduce_tiles(band_to_tile, s);
 
+    check_isl_budget(s.isl_ctx);
+
     auto prefix_schedule = band_to_tile.get_prefix_schedule_union_map();
 
     auto subtree_schedule = band_to_tile.get_subtree_schedule_union_map();
 
     auto prefix_range = prefix_schedule.range().get_sets();
 
+    check_isl_budget(s.isl_ctx);
+
     if (prefix_range.size() != 1)
-        throw 0;
+        throw loop_optimization_error("Expected a single prefix schedule.");
 
     auto outer_dims = prefix_range[0];
 
@@ -1040,14 +1414,18 @@ isl::schedule_node create_caches(isl::schedule_node band_to_tile, bool unroll_lo
 
     for (const auto& tile : tiles)
     {
+        if ((selection == cache_selection::read_only && tile.is_mutable) ||
+            (selection == cache_selection::mutable_only && !tile.is_mutable))
+            continue;
+
         std::vector<variable_declaration> constr_params;
 
         for (int i = 0; i < outer_dim; ++i)
         {
-            constr_params.emplace_back(types::integer());
+            constr_params.emplace_back("o" + std::to_string(i), types::integer());
         }
 
-        variable_declaration cache_decl(tile.parent.var_type());
+        variable_declaration cache_decl(tile.parent.name() + "_cache", tile.parent.var_type());
 
         std::vector<std::unique_ptr<expression>> constr_args;
 
@@ -1087,7 +1465,7 @@ isl::schedule_node create_caches(isl::schedule_node band_to_tile, bool unroll_lo
 
         for (int i = 0; i < num_inner_indices; ++i)
         {
-            auto inner_index = variable_declaration(types::integer());
+            auto inner_index = variable_declaration("c" + std::to_string(i), types::integer());
 
             inner_indices.push_back(inner_index);
 
@@ -1104,17 +1482,16 @@ isl::schedule_node create_caches(isl::schedule_node band_to_tile, bool unroll_lo
         auto substitution =
             make_macro(constr_params, make_macro(inner_indices, std::move(transform_code)));
 
-        cache_info info(tile.parent, std::move(substitution));
-
         std::unique_ptr<expression> cache_constructor_code =
             make_macro(constr_params, std::move(cache_constr_code));
-        cache_constructor_code->annotations().add("qubus.cache_info", annotation(std::move(info)));
 
         auto cache_constr_id =
             s.add_symbol("qubus.construct_cache", std::move(cache_constructor_code));
 
+        s.cache_table.emplace(cache_constr_id, cache_info(tile.parent, std::move(substitution)));
+
         isl::basic_map cache_constr_map =
-            isl::basic_map::identity(isl::space(isl_ctx, 0, outer_dim, outer_dim));
+            isl::basic_map::identity(isl::space(s.isl_ctx, 0, outer_dim, outer_dim));
         cache_constr_map.set_tuple_name(isl_dim_out, cache_constr_id);
 
         auto construct_extension = intersect_domain(cache_constr_map, outer_dims);
@@ -1138,11 +1515,21 @@ isl::schedule_node create_caches(isl::schedule_node band_to_tile, bool unroll_lo
     return band_to_tile;
 }
 
-void separate_full_from_partial_tiles(isl::schedule_node& band, util::index_t top_level_tile_size)
+void separate_full_from_partial_tiles(isl::schedule_node& band,
+                                      const std::vector<util::index_t>& top_level_tile_shape)
 {
+    auto isl_ctx = band.get_ctx();
+
     auto prefix_schedule = band.get_prefix_schedule_union_map();
 
-    auto n_outer_dim = prefix_schedule.range().get_sets()[0].dim(isl_dim_set);
+    auto prefix_range = prefix_schedule.range().get_sets();
+
+    check_isl_budget(isl_ctx);
+
+    if (prefix_range.empty())
+        throw loop_optimization_error("Expected a prefix schedule.");
+
+    auto n_outer_dim = prefix_range[0].dim(isl_dim_set);
 
     auto subtree_schedule = band.get_subtree_schedule_union_map();
 
@@ -1156,7 +1543,7 @@ void separate_full_from_partial_tiles(isl::schedule_node& band, util::index_t to
         auto c = isl::constraint::equality(s)
                      .set_coefficient(isl_dim_in, j, -1)
                      .set_coefficient(isl_dim_out, j, 1)
-                     .set_constant(top_level_tile_size - 1);
+                     .set_constant(top_level_tile_shape[j] - 1);
 
         m.add_constraint(c);
     }
@@ -1188,7 +1575,392 @@ void separate_full_from_partial_tiles(isl::schedule_node& band, util::index_t to
     band.band_set_ast_build_options(option);
 }
 
-isl::schedule_node optimize_schedule_node(isl::schedule_node root, scop& s)
+struct array_footprint
+{
+    util::index_t element_size;
+    int rank;
+};
+
+util::index_t get_element_size(const type& value_type)
+{
+    if (auto array_type = value_type.try_as<types::array>())
+        return get_element_size(array_type->value_type());
+
+    if (auto slice_type = value_type.try_as<types::array_slice>())
+        return get_element_size(slice_type->value_type());
+
+    if (value_type.is_primitive())
+        return abi_info().get_size_of(value_type);
+
+    // Assume the size of a double for all other types.
+    return sizeof(double);
+}
+
+std::vector<array_footprint> compute_footprints(const isl::union_map& local_accesses,
+                                                const scop& s, int n_member)
+{
+    std::map<std::string, array_footprint> footprints;
+
+    for (const auto& access : local_accesses.get_maps())
+    {
+        auto array_id = access.get_tuple_name(isl_dim_out);
+
+        // Each dimension of the array is at most indexed by one member of the band.
+        int rank = std::min(access.dim(isl_dim_out), n_member);
+
+        auto search_result = s.tensor_table.find(array_id);
+
+        util::index_t element_size = search_result != s.tensor_table.end()
+                                         ? get_element_size(search_result->second.var_type())
+                                         : sizeof(double);
+
+        auto& footprint =
+            footprints.emplace(array_id, array_footprint{element_size, rank}).first->second;
+
+        footprint.rank = std::max(footprint.rank, rank);
+    }
+
+    std::vector<array_footprint> result;
+
+    for (const auto& footprint : footprints)
+    {
+        result.push_back(footprint.second);
+    }
+
+    return result;
+}
+
+constexpr util::index_t register_tile_size = 4;
+constexpr util::index_t max_tile_size = 1024;
+constexpr std::size_t max_number_of_cache_tile_levels = 2;
+
+util::index_t compute_max_tile_size(const std::vector<array_footprint>& footprints,
+                                    util::index_t capacity, util::index_t min_tile_size)
+{
+    auto footprint_of_tile = [&footprints](util::index_t tile_size) {
+        util::index_t footprint = 0;
+
+        for (const auto& array : footprints)
+        {
+            util::index_t number_of_elements = 1;
+
+            for (int i = 0; i < array.rank; ++i)
+            {
+                number_of_elements *= tile_size;
+            }
+
+            footprint += number_of_elements * array.element_size;
+        }
+
+        return footprint;
+    };
+
+    util::index_t tile_size = min_tile_size;
+
+    while (tile_size < max_tile_size && footprint_of_tile(tile_size + 1) <= capacity)
+    {
+        ++tile_size;
+    }
+
+    return tile_size;
+}
+
+/** \brief Chooses the tile sizes of a band, starting with the outermost tile level.
+ *
+ * The innermost level is a small register tile. Each further level is the largest tile
+ * whose footprint fits into half of the corresponding cache level, rounded down to a
+ * multiple of the next inner tile size. Shared last-level caches are not considered.
+ */
+std::vector<util::index_t> choose_tile_sizes(const std::vector<array_footprint>& footprints,
+                                             const loop_optimizer_options& options)
+{
+    if (!options.tile_sizes.empty())
+        return options.tile_sizes;
+
+    if (options.cache_sizes.empty())
+        return {100, 20, register_tile_size};
+
+    std::vector<util::index_t> tile_sizes = {register_tile_size};
+
+    auto number_of_cache_levels =
+        std::min(options.cache_sizes.size(), max_number_of_cache_tile_levels);
+
+    for (std::size_t level = 0; level < number_of_cache_levels; ++level)
+    {
+        auto inner_tile_size = tile_sizes.back();
+
+        auto tile_size =
+            compute_max_tile_size(footprints, options.cache_sizes[level] / 2, inner_tile_size);
+
+        tile_size = tile_size / inner_tile_size * inner_tile_size;
+
+        if (tile_size > inner_tile_size)
+        {
+            tile_sizes.push_back(tile_size);
+        }
+    }
+
+    std::reverse(tile_sizes.begin(), tile_sizes.end());
+
+    return tile_sizes;
+}
+
+constexpr const char* parallel_loop_mark = "qubus.parallel_loop.";
+constexpr const char* vectorizable_loop_mark = "qubus.vectorizable_loop.";
+
+/** \brief Marks the loop generated for the given member of the band.
+ *
+ * The loop is identified by the name of its iterator which isl derives from the schedule depth.
+ */
+isl::schedule_node mark_loop(isl::schedule_node band, int member, const std::string& mark)
+{
+    auto depth = band.get_schedule_depth() + member;
+
+    return insert_mark(band, isl::id(band.get_ctx(), mark + std::to_string(depth)))[0];
+}
+
+/** \brief Executes the iterations of a permutable band in wavefronts.
+ *
+ * The outermost member is replaced by the sum of the first two members. Since all dependences
+ * have non-negative distances in a permutable band, the iterations of the second member
+ * are independent within each wavefront.
+ */
+isl::schedule_node apply_wavefront(isl::schedule_node band)
+{
+    auto n_member = band.band_n_member();
+
+    isl::space wavefront_space(band.get_ctx(), 0, n_member, n_member);
+
+    auto wavefront = isl::basic_map::universe(wavefront_space);
+
+    wavefront.add_constraint(isl::constraint::equality(wavefront_space)
+                                 .set_coefficient(isl_dim_in, 0, 1)
+                                 .set_coefficient(isl_dim_in, 1, 1)
+                                 .set_coefficient(isl_dim_out, 0, -1));
+
+    for (int i = 1; i < n_member; ++i)
+    {
+        wavefront.add_constraint(isl::constraint::equality(wavefront_space)
+                                     .set_coefficient(isl_dim_in, i, 1)
+                                     .set_coefficient(isl_dim_out, i, -1));
+    }
+
+    auto wavefront_schedule =
+        apply_range(band.band_get_partial_schedule_union_map(), isl::union_map(wavefront));
+
+    auto node = isl::delete_node(band);
+
+    return isl::insert_partial_schedule(
+        node, isl::multi_union_pw_affine_expr::from_union_map(wavefront_schedule));
+}
+
+/** \brief Checks if the dependences of a band follow the pattern of a time-stepped stencil.
+ *
+ * All dependences between the iterations of the band need to have uniform distances, i.e.
+ * distances bounded by constants which do not depend on the parameters or the iteration. If
+ * none of the members is coincident, the outermost one carries dependences and plays the role
+ * of the time dimension. Other bands, like the ones of reductions, do not profit from a
+ * wavefront.
+ */
+bool has_stencil_dependences(const isl::schedule_node& band, const scop& s)
+{
+    auto partial_schedule = band.band_get_partial_schedule_union_map();
+
+    auto band_dependences =
+        apply_range(apply_domain(s.dependences, partial_schedule), partial_schedule);
+
+    auto dependences = band_dependences.get_maps();
+
+    if (dependences.empty())
+        return false;
+
+    for (const auto& dependence : dependences)
+    {
+        auto distances = deltas(dependence);
+
+        for (int i = 0; i < distances.dim(isl_dim_set); ++i)
+        {
+            if (!dim_min(distances, i).is_cst() || !dim_max(distances, i).is_cst())
+                return false;
+        }
+    }
+
+    return true;
+}
+
+boost::optional<int> find_outermost_coincident_member(const isl::schedule_node& band)
+{
+    for (int i = 0; i < band.band_n_member(); ++i)
+    {
+        if (band.band_member_get_coincident(i))
+            return i;
+    }
+
+    return boost::none;
+}
+
+/** \brief Checks if the statement is a contraction of the form C[i, j] += A[i, k] * B[k, j].
+ *
+ * The operands may be transposed. Returns the result of the contraction.
+ */
+boost::optional<variable_declaration> match_contraction(const expression& statement)
+{
+    using pattern::_;
+
+    pattern::variable<variable_declaration> c, c_i, c_j, a, a_i, a_j, b, b_i, b_j;
+
+    auto m =
+        pattern::make_matcher<expression, boost::optional<variable_declaration>>()
+            .case_(pattern::macro(
+                       _, plus_assign(subscription_n(variable_ref(c), variable_ref(c_i),
+                                                     variable_ref(c_j)),
+                                      subscription_n(variable_ref(a), variable_ref(a_i),
+                                                     variable_ref(a_j)) *
+                                          subscription_n(variable_ref(b), variable_ref(b_i),
+                                                         variable_ref(b_j)))),
+                   [&]() -> boost::optional<variable_declaration> {
+                       auto is_result_index = [&](const variable_declaration& idx) {
+                           return idx == c_i.get() || idx == c_j.get();
+                       };
+
+                       // Splits the indices of an operand into its result index and
+                       // its contracted index.
+                       auto split_indices = [&](const variable_declaration& first,
+                                                const variable_declaration& second)
+                           -> boost::optional<std::pair<variable_declaration,
+                                                        variable_declaration>> {
+                           if (is_result_index(first) && !is_result_index(second))
+                               return std::make_pair(first, second);
+
+                           if (!is_result_index(first) && is_result_index(second))
+                               return std::make_pair(second, first);
+
+                           return boost::none;
+                       };
+
+                       if (c_i.get() == c_j.get())
+                           return boost::none;
+
+                       auto a_indices = split_indices(a_i.get(), a_j.get());
+                       auto b_indices = split_indices(b_i.get(), b_j.get());
+
+                       if (!a_indices || !b_indices)
+                           return boost::none;
+
+                       if (a_indices->first == b_indices->first ||
+                           a_indices->second != b_indices->second)
+                           return boost::none;
+
+                       return c.get();
+                   })
+            .case_(_, [] { return boost::none; });
+
+    return pattern::match(statement, m);
+}
+
+/** \brief Assignment of the members of a band to the dimensions of a contraction.
+ */
+struct contraction_info
+{
+    int row_member;
+    int column_member;
+    int reduction_member;
+    util::index_t element_size;
+};
+
+/** \brief Checks if the band implements a single contraction.
+ *
+ * The reduction is carried by the only member which is not coincident. The innermost
+ * coincident member is assumed to address consecutive elements of the result.
+ */
+boost::optional<contraction_info> analyze_contraction(const isl::schedule_node& band,
+                                                      const scop& s)
+{
+    if (band.band_n_member() != 3)
+        return boost::none;
+
+    auto statements = band.get_domain().get_sets();
+
+    if (statements.size() != 1 || statements[0].dim(isl_dim_set) != 3)
+        return boost::none;
+
+    auto search_result = s.symbol_table.find(statements[0].get_tuple_name());
+
+    if (search_result == s.symbol_table.end())
+        return boost::none;
+
+    auto result = match_contraction(*search_result->second);
+
+    if (!result)
+        return boost::none;
+
+    std::vector<int> coincident_members;
+    std::vector<int> reduction_members;
+
+    for (int i = 0; i < band.band_n_member(); ++i)
+    {
+        if (band.band_member_get_coincident(i))
+        {
+            coincident_members.push_back(i);
+        }
+        else
+        {
+            reduction_members.push_back(i);
+        }
+    }
+
+    if (reduction_members.size() != 1)
+        return boost::none;
+
+    return contraction_info{coincident_members[0], coincident_members[1], reduction_members[0],
+                            get_element_size(result->var_type())};
+}
+
+/** \brief Chooses the register tile of a contraction (micro-kernel).
+ *
+ * Each row of the accumulator block occupies two vector registers. Apart from four registers
+ * for the elements of the operands, all vector registers hold the accumulator block. The
+ * reduction dimension is not unrolled.
+ */
+std::vector<util::index_t> choose_micro_kernel_shape(const contraction_info& contraction,
+                                                     const loop_optimizer_options& options)
+{
+    std::vector<util::index_t> shape(3);
+
+    shape[contraction.reduction_member] = 1;
+
+    if (options.vector_register_size == 0 || options.number_of_vector_registers <= 4)
+    {
+        shape[contraction.row_member] = register_tile_size;
+        shape[contraction.column_member] = register_tile_size;
+
+        return shape;
+    }
+
+    auto lanes =
+        std::max<util::index_t>(options.vector_register_size / contraction.element_size, 1);
+
+    shape[contraction.row_member] = (options.number_of_vector_registers - 4) / 2;
+    shape[contraction.column_member] = 2 * lanes;
+
+    return shape;
+}
+
+/** \brief The effort spent on the optimization of a SCoP.
+ *
+ * A reduced effort restricts the search space of the scheduler and omits the introduction
+ * of caches.
+ */
+enum class optimization_effort
+{
+    full,
+    reduced
+};
+
+isl::schedule_node optimize_schedule_node(isl::schedule_node root, scop& s,
+                                          const loop_optimizer_options& options,
+                                          optimization_effort effort,
+                                          loop_optimization_report& report)
 {
     if (root.get_type() == isl_schedule_node_band)
     {
@@ -1196,8 +1968,8 @@ isl::schedule_node optimize_schedule_node(isl::schedule_node root, scop& s)
         {
             if (root[0].get_type() == isl_schedule_node_leaf)
             {
-                isl_options_set_tile_shift_point_loops(isl_ctx.native_handle(), 0);
-                isl_options_set_tile_scale_tile_loops(isl_ctx.native_handle(), 1);
+                isl_options_set_tile_shift_point_loops(s.isl_ctx.native_handle(), 0);
+                isl_options_set_tile_scale_tile_loops(s.isl_ctx.native_handle(), 1);
 
                 if (root.band_n_member() > 1)
                 {
@@ -1210,27 +1982,104 @@ isl::schedule_node optimize_schedule_node(isl::schedule_node root, scop& s)
 
                     bool no_reuse = local_accesses.is_injective();
 
+                    check_isl_budget(s.isl_ctx);
+
                     if (!no_reuse)
                     {
-                        std::vector<util::index_t> tile_sizes = {100, 20, 4};
+                        auto footprints =
+                            compute_footprints(local_accesses, s, root.band_n_member());
+
+                        auto tile_sizes = choose_tile_sizes(footprints, options);
+
+                        report.tile_sizes = tile_sizes;
+
                         std::size_t num_tile_levels = tile_sizes.size();
 
+                        std::vector<std::vector<util::index_t>> tile_shapes;
+
+                        for (auto tile_size : tile_sizes)
+                        {
+                            tile_shapes.emplace_back(root.band_n_member(), tile_size);
+                        }
+
+                        boost::optional<contraction_info> contraction;
+
+                        if (effort == optimization_effort::full)
+                        {
+                            contraction = analyze_contraction(root, s);
+                        }
+
+                        // Contractions are computed by a register-blocked micro-kernel.
+                        // All outer tiles are multiples of the micro-kernel.
+                        if (contraction)
+                        {
+                            tile_shapes.back() = choose_micro_kernel_shape(*contraction, options);
+
+                            for (std::size_t level = num_tile_levels - 1; level-- > 0;)
+                            {
+                                for (int j = 0; j < root.band_n_member(); ++j)
+                                {
+                                    auto inner_size = tile_shapes[level + 1][j];
+
+                                    auto size = tile_shapes[level][j] / inner_size * inner_size;
+
+                                    tile_shapes[level][j] = std::max(inner_size, size);
+                                }
+                            }
+
+                            report.micro_kernel_shape = tile_shapes.back();
+                        }
+
                         isl::schedule_node band_to_tile = root;
 
                         for (std::size_t i = 0; i < num_tile_levels; ++i)
                         {
-                            std::vector<util::index_t> tile_shape(root.band_n_member(),
-                                                                  tile_sizes[i]);
-
-                            auto the_tile_band = tile_band(band_to_tile, tile_shape);
+                            auto the_tile_band = tile_band(band_to_tile, tile_shapes[i]);
 
                             if (i == 1)
                             {
-                                separate_full_from_partial_tiles(the_tile_band, tile_sizes[0]);
+                                separate_full_from_partial_tiles(the_tile_band, tile_shapes[0]);
                             }
 
                             bool unroll_loops = i == num_tile_levels - 1;
 
+                            auto n_member = the_tile_band.band_n_member();
+
+                            // The outermost coincident tile loop is executed in parallel.
+                            boost::optional<int> parallel_member;
+
+                            if (i == 0)
+                            {
+                                parallel_member = find_outermost_coincident_member(the_tile_band);
+
+                                // Tiles of skewed bands of time-stepped stencils are executed
+                                // in parallel wavefronts.
+                                if (!parallel_member && the_tile_band.band_n_member() > 1 &&
+                                    effort == optimization_effort::full &&
+                                    has_stencil_dependences(root, s))
+                                {
+                                    the_tile_band = apply_wavefront(the_tile_band);
+
+                                    parallel_member = 1;
+                                }
+
+                                if (parallel_member)
+                                {
+                                    the_tile_band = mark_loop(the_tile_band, *parallel_member,
+                                                              parallel_loop_mark);
+                                }
+                            }
+
+                            // The innermost loop which is not unrolled is a candidate for
+                            // vectorization if its iterations are independent.
+                            if (unroll_loops &&
+                                the_tile_band.band_member_get_coincident(n_member - 1) &&
+                                parallel_member != n_member - 1)
+                            {
+                                the_tile_band = mark_loop(the_tile_band, n_member - 1,
+                                                          vectorizable_loop_mark);
+                            }
+
                             band_to_tile = the_tile_band[0];
 
                             if (unroll_loops)
@@ -1242,12 +2091,29 @@ isl::schedule_node optimize_schedule_node(isl::schedule_node root, scop& s)
                                 }
                             }
 
-                            band_to_tile = insert_mark(band_to_tile, isl::id(isl_ctx, "task"))[0];
+                            band_to_tile =
+                                insert_mark(band_to_tile, isl::id(s.isl_ctx, "task"))[0];
+
+                            // The operands of a contraction are packed tile by tile into
+                            // contiguous scratch memory in the order of their use.
+                            if (contraction && i == 0 && num_tile_levels > 1)
+                            {
+                                band_to_tile = create_caches(band_to_tile, false,
+                                                             cache_selection::read_only, s);
+                            }
 
-                            if (i == num_tile_levels - 1)
+                            if (i == num_tile_levels - 1 && effort == optimization_effort::full)
                             {
-                                band_to_tile = create_caches(band_to_tile, unroll_loops, s);
+                                // The micro-kernel reads its operands from the packed tiles
+                                // and only keeps the accumulator block in a cache.
+                                auto selection = contraction ? cache_selection::mutable_only
+                                                             : cache_selection::all;
+
+                                band_to_tile =
+                                    create_caches(band_to_tile, unroll_loops, selection, s);
                             }
+
+                            check_isl_budget(s.isl_ctx);
                         }
 
                         return band_to_tile;
@@ -1260,24 +2126,27 @@ isl::schedule_node optimize_schedule_node(isl::schedule_node root, scop& s)
     return root;
 }
 
-scop optimize_scop(scop s)
+scop optimize_scop(scop s, const loop_optimizer_options& options, optimization_effort effort,
+                   loop_optimization_report& report)
 {
     isl::union_map schedule = s.schedule.get_map();
 
     isl::union_map read = s.read_accesses;
     isl::union_map write = s.write_accesses;
 
-    isl::union_map may_write = isl::union_map::empty(isl::space(isl_ctx, 0, 0, 0));
+    isl::union_map may_write = isl::union_map::empty(isl::space(s.isl_ctx, 0, 0, 0));
 
-    isl::union_map dummy = isl::union_map::empty(isl::space(isl_ctx, 0, 0, 0));
+    isl::union_map dummy = isl::union_map::empty(isl::space(s.isl_ctx, 0, 0, 0));
 
-    isl::union_map raw = isl::union_map::empty(isl::space(isl_ctx, 0, 0, 0));
-    isl::union_map waw = isl::union_map::empty(isl::space(isl_ctx, 0, 0, 0));
-    isl::union_map war = isl::union_map::empty(isl::space(isl_ctx, 0, 0, 0));
+    isl::union_map raw = isl::union_map::empty(isl::space(s.isl_ctx, 0, 0, 0));
+    isl::union_map waw = isl::union_map::empty(isl::space(s.isl_ctx, 0, 0, 0));
+    isl::union_map war = isl::union_map::empty(isl::space(s.isl_ctx, 0, 0, 0));
 
     isl::compute_flow(read, write, may_write, schedule, raw, dummy, dummy, dummy);
     isl::compute_flow(write, write, read, schedule, waw, war, dummy, dummy);
 
+    check_isl_budget(s.isl_ctx);
+
     isl::union_set domain = s.schedule.get_domain();
 
     isl::schedule_constraints sched_constraints(domain);
@@ -1285,25 +2154,50 @@ scop optimize_scop(scop s)
     isl::union_map validity = isl::union_(raw, isl::union_(waw, war));
     isl::union_map proximity = validity;
 
+    s.dependences = validity;
+
     sched_constraints.set_validity_constraints(validity);
     sched_constraints.set_proximity_constraints(proximity);
     sched_constraints.set_coincidence_constraints(validity);
 
-    isl_options_set_schedule_serialize_sccs(isl_ctx.native_handle(), 1);
-    isl_options_set_schedule_maximize_band_depth(isl_ctx.native_handle(), 1);
-    isl_options_set_schedule_max_coefficient(isl_ctx.native_handle(), 20);
-    isl_options_set_schedule_max_constant_term(isl_ctx.native_handle(), 20);
+    // Statements of a SCoP originating from different kernel statements should share
+    // their loops whenever the dependences permit it. Therefore, we only serialize the
+    // strongly connected components if we are asked to spend less effort.
+    // The incremental scheduler fuses the components greedily.
+    isl_options_set_schedule_serialize_sccs(s.isl_ctx.native_handle(),
+                                            effort == optimization_effort::reduced);
+    isl_options_set_schedule_whole_component(s.isl_ctx.native_handle(), 0);
+    isl_options_set_schedule_maximize_band_depth(s.isl_ctx.native_handle(), 1);
+
+    long int max_coefficient = effort == optimization_effort::full ? 20 : 1;
+
+    isl_options_set_schedule_max_coefficient(s.isl_ctx.native_handle(), max_coefficient);
+    isl_options_set_schedule_max_constant_term(s.isl_ctx.native_handle(), max_coefficient);
 
     isl::schedule sched(sched_constraints);
 
-    s.schedule = map_schedule_node(
-        sched, [&](isl::schedule_node node) { return optimize_schedule_node(node, s); });
+    check_isl_budget(s.isl_ctx);
 
-    // s.schedule.dump();
+    s.schedule = map_schedule_node(
+        sched, [&](isl::schedule_node node) {
+            return optimize_schedule_node(node, s, options, effort, report);
+        });
 
     return s;
 }
 
+std::unique_ptr<access_expr> as_access_expr(std::unique_ptr<expression> expr)
+{
+    auto access = dynamic_cast<access_expr*>(expr.get());
+
+    if (!access)
+        throw loop_optimization_error("Expected an access expression.");
+
+    expr.release();
+
+    return std::unique_ptr<access_expr>(access);
+}
+
 std::unique_ptr<expression> isl_ast_expr_to_kir(const isl::ast_expr& expr,
                                                 ast_converter_context& ctx)
 {
@@ -1338,8 +2232,7 @@ std::unique_ptr<expression> isl_ast_expr_to_kir(const isl::ast_expr& expr,
 
                 if (boost::starts_with(id, "qubus.construct_cache"))
                 {
-                    const auto& cinfo =
-                        macro.annotations().lookup("qubus.cache_info").as<const cache_info&>();
+                    const auto& cinfo = ctx.cache_table.at(id);
 
                     auto substitution = std::unique_ptr<macro_expr>(static_cast<macro_expr*>(
                         expand_macro(*cinfo.substitution, clone(indices)).release()));
@@ -1369,7 +2262,7 @@ std::unique_ptr<expression> isl_ast_expr_to_kir(const isl::ast_expr& expr,
                                                         clone(indices.get()));
                                 });
 
-                        code = pattern::substitute(*code, m);
+                        code = pattern::substitute(std::move(code), m);
                     }
 
                     return code;
@@ -1377,7 +2270,7 @@ std::unique_ptr<expression> isl_ast_expr_to_kir(const isl::ast_expr& expr,
             }
             catch (const std::bad_cast&)
             {
-                throw 0;
+                throw loop_optimization_error("Unexpected arguments in call expression.");
             }
         }
         case isl_ast_op_add:
@@ -1455,7 +2348,7 @@ std::unique_ptr<expression> isl_ast_expr_to_kir(const isl::ast_expr& expr,
                               isl_ast_expr_to_kir(expr.get_arg(1), ctx));
         case isl_ast_op_access:
         {
-            auto array = isl_ast_expr_to_kir(expr.get_arg(0), ctx);
+            auto array = as_access_expr(isl_ast_expr_to_kir(expr.get_arg(0), ctx));
 
             std::vector<std::unique_ptr<expression>> indices;
 
@@ -1467,17 +2360,33 @@ std::unique_ptr<expression> isl_ast_expr_to_kir(const isl::ast_expr& expr,
             return subscription(std::move(array), std::move(indices));
         }
         default:
-            throw 0; // TODO: unknown op type
+            throw loop_optimization_error("Unknown operation in isl AST expression.");
         };
     default:
-        throw 0; // TODO: unknown expr type
+        throw loop_optimization_error("Unknown isl AST expression type.");
     }
 }
 
-std::unique_ptr<expression> isl_ast_to_kir(const isl::ast_node& root, ast_converter_context& ctx)
+/** \brief Decodes a loop mark into the iterator name of the marked loop and its execution order.
+ */
+boost::optional<std::pair<std::string, execution_order>> parse_loop_mark(const std::string& mark)
 {
-    // static long int current_extracted_fn_id = 0;
+    auto get_iterator_name = [&mark](const std::string& prefix) {
+        return "c" + mark.substr(prefix.size());
+    };
+
+    if (boost::starts_with(mark, parallel_loop_mark))
+        return std::make_pair(get_iterator_name(parallel_loop_mark), execution_order::parallel);
 
+    if (boost::starts_with(mark, vectorizable_loop_mark))
+        return std::make_pair(get_iterator_name(vectorizable_loop_mark),
+                              execution_order::unordered);
+
+    return boost::none;
+}
+
+std::unique_ptr<expression> isl_ast_to_kir(const isl::ast_node& root, ast_converter_context& ctx)
+{
     auto& symbol_table = ctx.symbol_table;
 
     switch (root.type())
@@ -1492,10 +2401,14 @@ std::unique_ptr<expression> isl_ast_to_kir(const isl::ast_node& root, ast_conver
         auto iterator = root.for_get_iterator();
 
         if (iterator.type() != isl_ast_expr_id)
-            throw 0; // iterator has to be an id expr (might want to use an assert)
+            throw loop_optimization_error("Loop iterator is not an identifier.");
+
+        variable_declaration idx_decl(iterator.get_id().name(), types::integer());
+
+        auto order_search_result = ctx.loop_orders.find(iterator.get_id().name());
 
-        // TODO: add new index to the lookup table
-        variable_declaration idx_decl(types::integer{});
+        auto order = order_search_result != ctx.loop_orders.end() ? order_search_result->second
+                                                                  : execution_order::sequential;
 
         symbol_table.emplace(iterator.get_id().name(), var(idx_decl));
 
@@ -1522,7 +2435,7 @@ std::unique_ptr<expression> isl_ast_to_kir(const isl::ast_node& root, ast_conver
             case isl_ast_op_lt:
                 return isl_ast_expr_to_kir(cond.get_arg(1), ctx);
             default:
-                throw 0; // unexpected expr in cond
+                throw loop_optimization_error("Unexpected loop condition.");
             }
         }();
 
@@ -1543,8 +2456,9 @@ std::unique_ptr<expression> isl_ast_to_kir(const isl::ast_node& root, ast_conver
 
         symbol_table.erase(iterator.get_id().name());
 
-        return for_(std::move(idx_decl), std::move(lower_bound), std::move(upper_bound),
-                    std::move(increment), std::move(body));
+        return std::make_unique<for_expr>(order, std::move(idx_decl), std::move(lower_bound),
+                                          std::move(upper_bound), std::move(increment),
+                                          std::move(body));
     }
     case isl_ast_node_block:
     {
@@ -1582,138 +2496,320 @@ std::unique_ptr<expression> isl_ast_to_kir(const isl::ast_node& root, ast_conver
     };
     case isl_ast_node_mark:
     {
-        auto mark_id = root.mark_get_id();
+        auto mark = root.mark_get_id().name();
 
-        // TODO: Reenable this after fixing the resulting performance problems.
-        /*if (mark_id.name() == "task")
+        auto marked_loop = parse_loop_mark(mark);
+
+        if (marked_loop)
         {
-            auto body = isl_ast_to_kir(root.mark_get_node(), ctx);
+            ctx.loop_orders.insert(*marked_loop);
+        }
 
-            return extract_expr_as_function(body, "extracted_fn_" +
-                                                      std::to_string(current_extracted_fn_id++));
-        }*/
+        // TODO: Extract the subtrees marked as "task" into separate tasks.
+        auto marked_code = isl_ast_to_kir(root.mark_get_node(), ctx);
+
+        if (marked_loop)
+        {
+            ctx.loop_orders.erase(marked_loop->first);
+        }
 
-        return isl_ast_to_kir(root.mark_get_node(), ctx);
+        return marked_code;
     }
     default:
-        throw 0; // TODO: Unknown node type
+        throw loop_optimization_error("Unknown isl AST node type.");
     }
 }
 
 std::unique_ptr<expression> generate_code_from_scop(const scop& s)
 {
-    /*auto constr_map1 = isl::union_map(isl_ctx, "[A, C] -> { [i0, i1, i2, i3] -> [0,i0, i1, i2, i3]
-    : i0 + 300 < A and i1 + 300 < C }");
+    isl_options_set_ast_build_atomic_upper_bound(s.isl_ctx.native_handle(), 1);
 
-    auto comp = isl::set(isl_set_complement(isl::set(isl_ctx, "[A, C] -> { [i0, i1, i2, i3] : i0 +
-    300 < A and i1 + 300 < C }").release()));
+    isl::ast_builder builder(s.isl_ctx);
 
-    auto constr_map2 = isl::union_map(isl_ctx, "[A, C] -> { [i0, i1, i2, i3] -> [1,i0, i1, i2, i3] :
-    i0 >= -300 + A or (i0 <= -301 + A and i1 >= -300 + C) }");
+    auto ast = builder.build_node_from_schedule(s.schedule);
 
-    isl_set_dump(comp.native_handle());
+    check_isl_budget(s.isl_ctx);
 
-    auto new_schedule_full =
-    isl::union_map(isl_union_map_apply_range(isl::union_map(new_schedule).release(),
-    constr_map1.release()));
-    auto new_schedule_partial =
-    isl::union_map(isl_union_map_apply_range(isl::union_map(new_schedule).release(),
-    constr_map2.release()));
+    std::map<std::string, std::unique_ptr<expression>> symbol_table;
+    for (const auto& symbol : s.symbol_table)
+    {
+        symbol_table.emplace(symbol.first, clone(*symbol.second));
+    }
 
-    new_schedule = union_(new_schedule_full, new_schedule_partial);*/
+    ast_converter_context ctx(std::move(symbol_table), s.cache_table);
 
-    isl_options_set_ast_build_atomic_upper_bound(isl_ctx.native_handle(), 1);
+    return isl_ast_to_kir(ast, ctx);
+}
 
-    isl::ast_builder builder(isl_ctx);
+std::unique_ptr<expression> optimize_scop_within_budget(const expression& expr,
+                                                        const loop_optimizer_options& options,
+                                                        optimization_effort effort,
+                                                        isl::context_ref isl_ctx,
+                                                        loop_optimization_report& report)
+{
+    isl_ctx_reset_error(isl_ctx.native_handle());
+    isl_ctx_reset_operations(isl_ctx.native_handle());
 
-    /*isl_union_map_dump(new_schedule.native_handle());
+    auto optimized_scop = optimize_scop(analyze_scop(expr, isl_ctx), options, effort, report);
 
-    isl::union_set domain(isl_ctx, "[N] -> { I[i,j,k] : 0 < i,j,k <= N; J[i,j,k] : 0 < i,j,k <=
-    N}");
+    return generate_code_from_scop(optimized_scop);
+}
 
-    isl::basic_map access1(isl_ctx, "[N] -> { I[i,j,k] -> C[i,j] : 0 < i,j,k <= N }");
-    isl::basic_map access2(isl_ctx, "[N] -> { J[i,j,k] -> C[i,j] : 0 < i,j,k <= N }");
+std::unique_ptr<expression> optimize_scop_with_fallbacks(const expression& expr,
+                                                         const loop_optimizer_options& options,
+                                                         isl::context_ref isl_ctx,
+                                                         loop_optimization_report& report)
+{
+    report.is_scop = true;
+    ++report.number_of_scops;
 
-    isl::union_map sched(isl_ctx, "[N] -> { I[i,j,k] -> [1,i,j,k] : exists e0 = floor((j)/2) : j =
-    2e0 and 0 < i,j,k <= N ; J[i,j,k] -> [2,i,j,k] : exists e0 = floor((j)/2) : j = 2e0 and 0 <
-    i,j,k <= N}");
+    // The original code is always a valid fallback.
+    try
+    {
+        auto optimized_code = [&] {
+            try
+            {
+                return optimize_scop_within_budget(expr, options, optimization_effort::full,
+                                                   isl_ctx, report);
+            }
+            catch (const isl_budget_exceeded_error&)
+            {
+                report.fallback =
+                    std::max(report.fallback, loop_optimization_fallback::reduced_effort);
 
-    auto transformed_access1 = apply_domain(access1, sched);
-    auto transformed_access2 = apply_domain(access2, sched);
+                return optimize_scop_within_budget(expr, options, optimization_effort::reduced,
+                                                   isl_ctx, report);
+            }
+        }();
 
-    auto time_domain = apply(domain, sched);
+        report.has_been_optimized = true;
 
-    isl_union_set_dump(time_domain.native_handle());
+        return optimized_code;
+    }
+    catch (const isl_budget_exceeded_error&)
+    {
+        report.fallback = loop_optimization_fallback::original_code;
 
-    isl_union_map_dump(transformed_access1.native_handle());
-    isl_union_map_dump(transformed_access2.native_handle());
+        return clone(expr);
+    }
+    catch (const loop_optimization_error&)
+    {
+        report.fallback = loop_optimization_fallback::original_code;
 
-    auto accesses1 = apply(time_domain, transformed_access1);
-    auto accesses2 = apply(time_domain, transformed_access2);
+        return clone(expr);
+    }
+}
 
-    isl_union_set_dump(accesses1.native_handle());
-    isl_union_set_dump(accesses2.native_handle());
+// Optimizing statements which are not part of any loop is pointless.
+bool contains_loop(const std::vector<std::reference_wrapper<const expression>>& statements)
+{
+    return std::any_of(statements.begin(), statements.end(), [](const expression& statement) {
+        return statement.try_as<for_expr>() != nullptr;
+    });
+}
 
-    auto aliases = intersect(accesses1, accesses2);
+std::unique_ptr<expression> detect_and_optimize_scops(const expression& expr,
+                                                      const loop_optimizer_options& options,
+                                                      isl::context_ref isl_ctx,
+                                                      const dependence_analysis_result& dependences,
+                                                      loop_optimization_report& report)
+{
+    if (is_scop(expr))
+        return optimize_scop_with_fallbacks(expr, options, isl_ctx, report);
 
-    isl_union_set_dump(aliases.native_handle());*/
+    pattern::variable<std::vector<std::reference_wrapper<expression>>> subexprs;
 
-    /*builder.set_before_each_for([&](isl::ast_builder_ref QUBUS_UNUSED(builder))
-                                {
-                                    return isl::id(isl_ctx, "test");
-                                });*/
+    auto m =
+        pattern::make_matcher<expression, std::unique_ptr<expression>>()
+            .case_(pattern::sequenced_tasks(subexprs),
+                   [&] {
+                       // Maximal runs of consecutive statements which form a SCoP are optimized
+                       // as a whole such that the scheduler is able to fuse their loops.
+                       std::vector<std::unique_ptr<expression>> new_subexprs;
+                       std::vector<std::reference_wrapper<const expression>> current_scop;
+
+                       auto finish_scop = [&] {
+                           if (current_scop.empty())
+                               return;
+
+                           if (!contains_loop(current_scop))
+                           {
+                               for (const expression& statement : current_scop)
+                               {
+                                   new_subexprs.push_back(clone(statement));
+                               }
+                           }
+                           else if (current_scop.size() == 1)
+                           {
+                               new_subexprs.push_back(optimize_scop_with_fallbacks(
+                                   current_scop.front(), options, isl_ctx, report));
+                           }
+                           else
+                           {
+                               std::vector<std::unique_ptr<expression>> statements;
+
+                               for (const expression& statement : current_scop)
+                               {
+                                   statements.push_back(clone(statement));
+                               }
+
+                               auto scop_code = sequenced_tasks(std::move(statements));
+
+                               new_subexprs.push_back(optimize_scop_with_fallbacks(
+                                   *scop_code, options, isl_ctx, report));
+                           }
+
+                           current_scop.clear();
+                       };
+
+                       for (const expression& sub_expr : subexprs.get())
+                       {
+                           if (is_scop(sub_expr))
+                           {
+                               current_scop.push_back(sub_expr);
+                           }
+                           else
+                           {
+                               finish_scop();
+
+                               new_subexprs.push_back(detect_and_optimize_scops(
+                                   sub_expr, options, isl_ctx, dependences, report));
+                           }
+                       }
+
+                       finish_scop();
+
+                       return sequenced_tasks(std::move(new_subexprs));
+                   })
+            .case_(pattern::_, [&] {
+                std::vector<std::unique_ptr<expression>> new_children;
+
+                for (const auto& child : expr.sub_expressions())
+                {
+                    new_children.push_back(detect_and_optimize_scops(child, options, isl_ctx,
+                                                                     dependences, report));
+                }
 
-    isl::printer printer(isl_ctx);
+                // The iterations of loops outside of any SCoP can still be executed in any
+                // order if they do not depend on each other.
+                auto loop = expr.try_as<for_expr>();
 
-    auto ast = builder.build_node_from_schedule(s.schedule);
+                if (loop && loop->order() == execution_order::sequential &&
+                    !dependences.carries_dependences(*loop))
+                {
+                    ++report.number_of_independent_loops;
 
-    // printer.print(ast);
+                    return std::unique_ptr<expression>(std::make_unique<for_expr>(
+                        execution_order::unordered, loop->loop_index(),
+                        std::move(new_children[0]), std::move(new_children[1]),
+                        std::move(new_children[2]), std::move(new_children[3])));
+                }
 
-    std::map<std::string, std::unique_ptr<expression>> symbol_table;
-    for (const auto& symbol : s.symbol_table)
-    {
-        symbol_table.emplace(symbol.first, clone(*symbol.second));
-    }
+                return expr.substitute_subexpressions(std::move(new_children));
+            });
 
-    ast_converter_context ctx(std::move(symbol_table));
+    return pattern::match(expr, m);
+}
+}
 
-    return isl_ast_to_kir(ast, ctx);
+bool is_loop_optimization_requested(const module& mod)
+{
+    auto value = mod.lookup_pragma(optimize_loops_pragma);
+
+    return value && *value == "true";
 }
 
-std::unique_ptr<expression> detect_and_optimize_scops(const expression& expr)
+bool is_loop_autotuning_requested(const module& mod)
 {
-    if (is_scop(expr))
-    {
-        auto lowered_expr = lower_abstract_indices(expr);
+    auto value = mod.lookup_pragma(autotune_loops_pragma);
 
-        auto optimized_scop = optimize_scop(analyze_scop(*lowered_expr));
+    return value && *value == "true";
+}
+
+std::vector<std::vector<util::index_t>> get_tile_size_candidates()
+{
+    return {{}, {32, 8, 4}, {64, 16, 4}, {128, 32, 4}, {256, 64, 8}};
+}
 
-        return generate_code_from_scop(optimized_scop);
+std::unique_ptr<module> optimize_loops(const module& mod, const loop_optimizer_options& options,
+                                       std::vector<loop_optimization_report>& reports)
+{
+    // isl contexts are not thread-safe. Each invocation uses its own context such that
+    // several modules can be optimized concurrently.
+    isl::context isl_ctx;
+
+    isl_ctx_set_max_operations(isl_ctx.native_handle(), options.max_isl_operations);
+    isl_options_set_on_error(isl_ctx.native_handle(), ISL_ON_ERROR_CONTINUE);
+
+    auto optimized_module = std::make_unique<module>(mod.id());
+
+    optimized_module->add_types(mod.types());
+
+    for (const auto& pragma : mod.pragmas())
+    {
+        optimized_module->set_pragma(pragma.first, pragma.second);
     }
-    else
+
+    for (const auto& function : mod.functions())
     {
-        return clone(expr);
+        loop_optimization_report report;
+        report.function_name = function.full_name();
+
+        pass_resource_manager resource_manager;
+        analysis_manager analysis_man(resource_manager);
+
+        const auto& dependences =
+            analysis_man.get_analysis<dependence_analysis_pass>(function.body());
+
+        auto new_body =
+            detect_and_optimize_scops(function.body(), options, isl_ctx, dependences, report);
+
+        optimized_module->add_function(function.name(), function.params(), function.result(),
+                                       std::move(new_body));
+
+        reports.push_back(std::move(report));
     }
-}
+
+    return optimized_module;
 }
 
-function_declaration optimize_loops(function_declaration decl)
+namespace
+{
+struct loop_optimization_report_table
 {
-    auto new_body = detect_and_optimize_scops(decl.body());
+    std::mutex mutex;
+    std::unordered_map<symbol_id, std::vector<loop_optimization_report>> reports;
+};
 
-    decl.substitute_body(std::move(new_body));
+loop_optimization_report_table& get_loop_optimization_report_table()
+{
+    static loop_optimization_report_table table;
 
-    return decl;
+    return table;
 }
 }
-#else
-#include <qubus/loop_optimizer.hpp>
 
-namespace qubus
+void record_loop_optimization_reports(const symbol_id& module_id,
+                                      std::vector<loop_optimization_report> reports)
 {
-std::unique_ptr<function> optimize_loops(const function& decl)
+    auto& table = get_loop_optimization_report_table();
+
+    std::lock_guard<std::mutex> guard(table.mutex);
+
+    table.reports[module_id] = std::move(reports);
+}
+
+std::vector<loop_optimization_report> get_loop_optimization_reports(const symbol_id& module_id)
 {
-    throw 0;
+    auto& table = get_loop_optimization_report_table();
+
+    std::lock_guard<std::mutex> guard(table.mutex);
+
+    auto search_result = table.reports.find(module_id);
+
+    if (search_result != table.reports.end())
+        return search_result->second;
+
+    return {};
 }
 }
-#endif
\ No newline at end of file
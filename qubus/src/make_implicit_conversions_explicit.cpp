@@ -96,6 +96,11 @@ std::unique_ptr<module> make_implicit_conversions_explicit(const module& mod)
 
     optimized_module->add_types(mod.types());
 
+    for (const auto& pragma : mod.pragmas())
+    {
+        optimized_module->set_pragma(pragma.first, pragma.second);
+    }
+
     for (const auto& function : mod.functions())
     {
         auto new_body = make_implicit_conversions_explicit(function.body());
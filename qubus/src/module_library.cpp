@@ -1,6 +1,198 @@
 #include <qubus/module_library.hpp>
 
+#include <hpx/include/apply.hpp>
+#include <hpx/include/runtime.hpp>
+
+#include <boost/range/size.hpp>
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <utility>
+#include <vector>
+
+namespace qubus
+{
+namespace
+{
+/** \brief The modules of a library which are available on this locality without contacting
+ *         the library.
+ *
+ * Only the most recently used modules are kept to bound the memory consumption of
+ * long-running applications. Evicted modules are fetched again on demand.
+ */
+class module_cache
+{
+public:
+    using cached_module = hpx::shared_future<std::shared_ptr<const module>>;
+
+    cached_module lookup_or_fetch(const symbol_id& id, const hpx::id_type& library)
+    {
+        std::lock_guard<hpx::lcos::local::mutex> guard(cache_mutex_);
+
+        if (auto cached = find(id))
+            return *cached;
+
+        // Concurrent lookups of the same module share a single request.
+        cached_module fetched_module =
+            hpx::async<module_library_server::lookup_action>(library, id)
+                .then([](hpx::future<std::unique_ptr<module>> result) {
+                    return std::shared_ptr<const module>(result.get());
+                });
+
+        emplace(id, fetched_module);
+
+        return fetched_module;
+    }
+
+    void insert(std::shared_ptr<const module> m)
+    {
+        std::lock_guard<hpx::lcos::local::mutex> guard(cache_mutex_);
+
+        auto id = m->id();
+
+        evict_entry(id);
+
+        emplace(std::move(id), hpx::make_ready_future(std::move(m)));
+    }
+
+    /** \brief Returns the module if it is already available, and a null pointer otherwise.
+     */
+    std::shared_ptr<const module> try_lookup(const symbol_id& id)
+    {
+        std::lock_guard<hpx::lcos::local::mutex> guard(cache_mutex_);
+
+        auto cached = find(id);
+
+        if (cached && cached->is_ready() && cached->has_value())
+            return cached->get();
+
+        return nullptr;
+    }
+
+    void evict(const symbol_id& id)
+    {
+        std::lock_guard<hpx::lcos::local::mutex> guard(cache_mutex_);
+
+        evict_entry(id);
+    }
+
+    static constexpr std::size_t max_number_of_modules = 1024;
+
+private:
+    using entry_list = std::list<std::pair<symbol_id, cached_module>>;
+
+    /** \brief Looks up a module and marks it as the most recently used one.
+     */
+    const cached_module* find(const symbol_id& id)
+    {
+        auto search_result = index_.find(id);
+
+        if (search_result == index_.end())
+            return nullptr;
+
+        entries_.splice(entries_.begin(), entries_, search_result->second);
+
+        return &search_result->second->second;
+    }
+
+    void emplace(symbol_id id, cached_module m)
+    {
+        if (entries_.size() >= max_number_of_modules)
+        {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+
+        entries_.emplace_front(id, std::move(m));
+        index_.emplace(std::move(id), entries_.begin());
+    }
+
+    void evict_entry(const symbol_id& id)
+    {
+        auto search_result = index_.find(id);
+
+        if (search_result == index_.end())
+            return;
+
+        entries_.erase(search_result->second);
+        index_.erase(search_result);
+    }
+
+    // The entries are ordered from the most to the least recently used one.
+    entry_list entries_;
+    std::unordered_map<symbol_id, entry_list::iterator> index_;
+    hpx::lcos::local::mutex cache_mutex_;
+};
+
+/** \brief Returns the module cache of the given library on this locality.
+ *
+ * Each library has its own cache since different libraries might contain different modules
+ * with the same id.
+ */
+module_cache& get_module_cache(const hpx::id_type& library)
+{
+    static std::map<hpx::id_type, std::unique_ptr<module_cache>> caches;
+    static hpx::lcos::local::mutex caches_mutex;
+
+    std::lock_guard<hpx::lcos::local::mutex> guard(caches_mutex);
+
+    auto& cache = caches[library];
+
+    if (!cache)
+    {
+        cache = std::make_unique<module_cache>();
+    }
+
+    return *cache;
+}
+
+std::vector<variable_declaration> free_variables(const function& func)
+{
+    auto variables = func.params();
+    variables.push_back(func.result());
+
+    return variables;
+}
+
+/** \brief Checks if two modules only differ in the choice of their variables.
+ */
+bool are_equivalent(const module& lhs, const module& rhs)
+{
+    if (lhs.pragmas() != rhs.pragmas())
+        return false;
+
+    if (boost::size(lhs.functions()) != boost::size(rhs.functions()))
+        return false;
+
+    for (const auto& lhs_func : lhs.functions())
+    {
+        auto rhs_func = std::find_if(rhs.functions().begin(), rhs.functions().end(),
+                                     [&lhs_func](const function& func) {
+                                         return func.name() == lhs_func.name();
+                                     });
+
+        if (rhs_func == rhs.functions().end())
+            return false;
+
+        if (!alpha_equivalent(lhs_func.body(), free_variables(lhs_func), (*rhs_func).body(),
+                              free_variables(*rhs_func)))
+            return false;
+    }
+
+    return true;
+}
+} // namespace
+
+void prefetch_module(hpx::id_type library, std::unique_ptr<module> m)
+{
+    get_module_cache(library).insert(std::move(m));
+}
+} // namespace qubus
+
+HPX_PLAIN_ACTION(qubus::prefetch_module, qubus_prefetch_module_action);
 
 using server_type = hpx::components::component<qubus::module_library_server>;
 HPX_REGISTER_COMPONENT(server_type, qubus_module_library_server);
@@ -8,6 +200,9 @@ HPX_REGISTER_COMPONENT(server_type, qubus_module_library_server);
 typedef qubus::module_library_server::add_action add_action;
 HPX_REGISTER_ACTION(add_action, qubus_module_library_server_add_action);
 
+typedef qubus::module_library_server::add_if_absent_action add_if_absent_action;
+HPX_REGISTER_ACTION(add_if_absent_action, qubus_module_library_server_add_if_absent_action);
+
 typedef qubus::module_library_server::lookup_action lookup_action;
 HPX_REGISTER_ACTION(lookup_action, qubus_module_library_server_lookup_action);
 
@@ -26,18 +221,64 @@ missing_module_error::missing_module_error(symbol_id module_id_)
 {
 }
 
+conflicting_module_error::conflicting_module_error(symbol_id module_id_)
+: std::runtime_error("The module " + module_id_.string() +
+                     " differs from an existing module with the same id."),
+  module_id_(std::move(module_id_))
+{
+}
+
 void module_library_server::add(std::unique_ptr<module> m)
 {
     auto id = m->id();
 
-    auto [pos, has_been_added] = module_index_.emplace(id, std::move(m));
-
-    if (!has_been_added)
+    if (try_add(std::move(m)))
         throw duplicate_module_error(id);
 }
 
+void module_library_server::add_if_absent(std::unique_ptr<module> m)
+{
+    std::shared_ptr<const module> new_module = std::move(m);
+
+    if (auto existing_module = try_add(new_module))
+    {
+        if (!are_equivalent(*existing_module, *new_module))
+            throw conflicting_module_error(new_module->id());
+    }
+}
+
+std::shared_ptr<const module>
+module_library_server::try_add(std::shared_ptr<const module> shared_module)
+{
+    auto id = shared_module->id();
+
+    {
+        std::lock_guard<hpx::lcos::local::mutex> guard(module_index_mutex_);
+
+        auto [pos, has_been_added] = module_index_.emplace(id, shared_module);
+
+        if (!has_been_added)
+            return pos->second;
+    }
+
+    // Distribute the module right away such that its first execution on a remote locality
+    // does not have to wait for the module to be transferred.
+    auto library = this->get_unmanaged_id();
+
+    for (const auto& locality : hpx::find_remote_localities())
+    {
+        hpx::apply<qubus_prefetch_module_action>(locality, library, clone(*shared_module));
+    }
+
+    get_module_cache(library).insert(std::move(shared_module));
+
+    return nullptr;
+}
+
 std::unique_ptr<module> module_library_server::lookup(const symbol_id& id) const
 {
+    std::lock_guard<hpx::lcos::local::mutex> guard(module_index_mutex_);
+
     auto search_result = module_index_.find(id);
 
     if (search_result != module_index_.end())
@@ -63,8 +304,38 @@ hpx::future<void> module_library::add(std::unique_ptr<module> m) const
     return hpx::async<module_library_server::add_action>(this->get_id(), std::move(m));
 }
 
-hpx::future<std::unique_ptr<module>> module_library::lookup(const symbol_id& id) const
+hpx::future<void> module_library::add_if_absent(std::unique_ptr<module> m) const
+{
+    if (auto cached_module = get_module_cache(this->get_id()).try_lookup(m->id()))
+    {
+        if (!are_equivalent(*cached_module, *m))
+            return hpx::make_exceptional_future<void>(conflicting_module_error(m->id()));
+
+        return hpx::make_ready_future();
+    }
+
+    return hpx::async<module_library_server::add_if_absent_action>(this->get_id(), std::move(m));
+}
+
+hpx::future<std::shared_ptr<const module>> module_library::lookup(const symbol_id& id) const
 {
-    return hpx::async<module_library_server::lookup_action>(this->get_id(), id);
+    auto library = this->get_id();
+
+    auto fetched_module = get_module_cache(library).lookup_or_fetch(id, library);
+
+    return fetched_module.then(
+        [id, library](hpx::shared_future<std::shared_ptr<const module>> result) {
+            try
+            {
+                return result.get();
+            }
+            catch (...)
+            {
+                // The module might still be added later on, so failed lookups are not cached.
+                get_module_cache(library).evict(id);
+
+                throw;
+            }
+        });
 }
 }
\ No newline at end of file
@@ -1,13 +1,242 @@
 #include <qubus/pass_manager.hpp>
 
+#include <qubus/IR/expression_arena.hpp>
+
+#include <iterator>
+
 namespace qubus
 {
 
+namespace
+{
+void collect_nodes(const expression& expr, std::unordered_set<const expression*>& nodes)
+{
+    nodes.insert(&expr);
+
+    for (const auto& sub_expr : expr.sub_expressions())
+    {
+        collect_nodes(sub_expr, nodes);
+    }
+}
+
+void map_nodes(const expression& source, const expression& target,
+               std::unordered_map<const expression*, const expression*>& node_table)
+{
+    QUBUS_ASSERT(source.arity() == target.arity(), "The expressions need to be alpha-equivalent.");
+
+    node_table.emplace(&source, &target);
+
+    for (std::size_t i = 0; i < source.arity(); ++i)
+    {
+        map_nodes(source.child(i), target.child(i), node_table);
+    }
+}
+}
+
+expression_relocation::expression_relocation(const expression& source_,
+                                             const expression& target_)
+{
+    map_nodes(source_, target_, node_table_);
+
+    auto source_variables = canonical_variables(source_);
+    auto target_variables = canonical_variables(target_);
+
+    QUBUS_ASSERT(source_variables.size() == target_variables.size(),
+                 "The expressions need to be alpha-equivalent.");
+
+    for (std::size_t i = 0; i < source_variables.size(); ++i)
+    {
+        variable_table_.emplace(source_variables[i].id(), target_variables[i]);
+    }
+}
+
+const expression& expression_relocation::map(const expression& node) const
+{
+    auto search_result = node_table_.find(&node);
+
+    QUBUS_ASSERT(search_result != node_table_.end(),
+                 "The node is not part of the relocated expression.");
+
+    return *search_result->second;
+}
+
+variable_declaration expression_relocation::map(const variable_declaration& var) const
+{
+    auto search_result = variable_table_.find(var.id());
+
+    if (search_result != variable_table_.end())
+        return search_result->second;
+
+    return var;
+}
+
+preserved_analyses_info preserved_analyses_info::all()
+{
+    preserved_analyses_info info;
+
+    info.preserves_all_ = true;
+
+    return info;
+}
+
+void preserved_analyses_info::preserve(analysis_id id)
+{
+    preserved_analyses_.push_back(std::move(id));
+}
+
+bool preserved_analyses_info::is_preserved(const analysis_id& id) const
+{
+    return preserves_all_ ||
+           std::find(preserved_analyses_.begin(), preserved_analyses_.end(), id) !=
+               preserved_analyses_.end();
+}
+
+void preserved_analyses_info::mark_modified(const expression& subtree)
+{
+    modified_subtrees_.push_back(&subtree);
+}
+
+const std::vector<const expression*>& preserved_analyses_info::modified_subtrees() const
+{
+    return modified_subtrees_;
+}
+
 isl::context& pass_resource_manager::get_isl_ctx()
 {
     return isl_ctx_;
 }
 
+analysis_cache::entry::entry(std::size_t hash_, const analysis_pass& pass_,
+                             const expression& expr_, const analysis_result& result_)
+: hash_(hash_),
+  id_(pass_.id()),
+  expr_(clone(expr_)),
+  manager_(std::make_unique<analysis_manager>(resource_manager_, false))
+{
+    // The result is relocated onto the private copy since the analyzed expression might be
+    // destroyed before the entry. Results of other analyses, which the relocated result might
+    // depend on, are computed for the copy on demand.
+    expression_relocation relocation(expr_, *this->expr_);
+
+    this->result_ = pass_.relocate(result_, relocation, *this->expr_, *manager_, resource_manager_);
+}
+
+analysis_cache::entry::~entry() = default;
+
+std::size_t analysis_cache::entry::hash() const
+{
+    return hash_;
+}
+
+const analysis_id& analysis_cache::entry::id() const
+{
+    return id_;
+}
+
+const expression& analysis_cache::entry::expr() const
+{
+    return *expr_;
+}
+
+const analysis_result& analysis_cache::entry::result() const
+{
+    return result_;
+}
+
+std::shared_ptr<const analysis_cache::entry> analysis_cache::lookup(const analysis_id& id,
+                                                                   const expression& expr) const
+{
+    return lookup(id, expr, canonical_hash(expr, {}));
+}
+
+std::shared_ptr<const analysis_cache::entry>
+analysis_cache::lookup(const analysis_id& id, const expression& expr, std::size_t hash) const
+{
+    std::lock_guard<std::mutex> guard(entries_mutex_);
+
+    auto candidates = index_.equal_range(hash);
+
+    for (auto iter = candidates.first; iter != candidates.second; ++iter)
+    {
+        const auto& candidate = *iter->second;
+
+        if (candidate->id() == id && alpha_equivalent(candidate->expr(), {}, expr, {}))
+        {
+            entries_.splice(entries_.begin(), entries_, iter->second);
+
+            return candidate;
+        }
+    }
+
+    return nullptr;
+}
+
+void analysis_cache::insert(const analysis_pass& pass, const expression& expr,
+                            const analysis_result& result)
+{
+    insert(pass, expr, canonical_hash(expr, {}), result);
+}
+
+void analysis_cache::insert(const analysis_pass& pass, const expression& expr, std::size_t hash,
+                            const analysis_result& result)
+{
+    std::shared_ptr<const entry> new_entry;
+
+    {
+        // The entry might outlive an arena active in this thread.
+        expression_arena_suspension arena_suspension;
+
+        new_entry = std::make_shared<const entry>(hash, pass, expr, result);
+    }
+
+    std::lock_guard<std::mutex> guard(entries_mutex_);
+
+    // Bound the memory consumption of long-running applications.
+    if (entries_.size() >= max_number_of_entries)
+    {
+        auto least_recently_used = std::prev(entries_.end());
+
+        auto candidates = index_.equal_range((*least_recently_used)->hash());
+
+        for (auto iter = candidates.first; iter != candidates.second; ++iter)
+        {
+            if (iter->second == least_recently_used)
+            {
+                index_.erase(iter);
+                break;
+            }
+        }
+
+        entries_.erase(least_recently_used);
+    }
+
+    entries_.push_front(std::move(new_entry));
+
+    index_.emplace(hash, entries_.begin());
+}
+
+std::size_t analysis_cache::size() const
+{
+    std::lock_guard<std::mutex> guard(entries_mutex_);
+
+    return entries_.size();
+}
+
+void analysis_cache::clear()
+{
+    std::lock_guard<std::mutex> guard(entries_mutex_);
+
+    index_.clear();
+    entries_.clear();
+}
+
+analysis_cache& analysis_cache::get_instance()
+{
+    static analysis_cache instance;
+
+    return instance;
+}
+
 std::vector<analysis_pass> analysis_pass_registry::construct_all_passes() const
 {
     std::lock_guard<std::mutex> guard(analysis_pass_table_mutex_);
@@ -45,15 +274,79 @@ const analysis_pass& analysis_node::pass() const
     return pass_;
 }
 
+std::shared_ptr<const analysis_result> analysis_node::run_pass(const expression& expr)
+{
+    if (!pass_.is_relocatable() || !manager_.get().uses_analysis_cache())
+        return std::make_shared<analysis_result>(pass_.run(expr, manager_, *resource_manager_));
+
+    auto& cache = analysis_cache::get_instance();
+
+    auto hash = canonical_hash(expr, {});
+
+    if (auto entry = cache.lookup(pass_.id(), expr, hash))
+    {
+        expression_relocation relocation(entry->expr(), expr);
+
+        return std::make_shared<analysis_result>(
+            pass_.relocate(entry->result(), relocation, expr, manager_, *resource_manager_));
+    }
+
+    auto result =
+        std::make_shared<analysis_result>(pass_.run(expr, manager_, *resource_manager_));
+
+    cache.insert(pass_, expr, hash, *result);
+
+    return result;
+}
+
 void analysis_node::invalidate()
 {
+    cached_results_.clear();
+
     for (const auto& dependent : dependents_)
     {
         dependent->invalidate();
     }
 }
 
-analysis_manager::analysis_manager(pass_resource_manager& resource_manager_)
+void analysis_node::invalidate(const std::unordered_set<const expression*>& roots)
+{
+    for (auto iter = cached_results_.begin(); iter != cached_results_.end();)
+    {
+        if (roots.count(iter->first) > 0)
+        {
+            iter = cached_results_.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+
+    for (const auto& dependent : dependents_)
+    {
+        dependent->invalidate(roots);
+    }
+}
+
+void analysis_node::discard_dead_results(const std::unordered_set<const expression*>& live_nodes)
+{
+    for (auto iter = cached_results_.begin(); iter != cached_results_.end();)
+    {
+        if (live_nodes.count(iter->first) == 0)
+        {
+            iter = cached_results_.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+analysis_manager::analysis_manager(pass_resource_manager& resource_manager_,
+                                   bool use_analysis_cache_)
+: use_analysis_cache_(use_analysis_cache_)
 {
     auto passes = analysis_pass_registry::get_instance().construct_all_passes();
 
@@ -86,16 +379,47 @@ analysis_manager::analysis_manager(pass_resource_manager& resource_manager_)
     }
 }
 
+bool analysis_manager::uses_analysis_cache() const
+{
+    return use_analysis_cache_;
+}
+
 void analysis_manager::invalidate(const preserved_analyses_info& preserved_analyses)
 {
-    for (auto& id_and_node : analysis_table_)
+    const auto& modified_subtrees = preserved_analyses.modified_subtrees();
+
+    if (modified_subtrees.empty())
+    {
+        for (auto& id_and_node : analysis_table_)
+        {
+            if (!preserved_analyses.is_preserved(id_and_node.first))
+            {
+                id_and_node.second->invalidate();
+            }
+        }
+
+        return;
+    }
+
+    // The results for a modified subtree, for all of its descendants and for all of its
+    // ancestors are affected by the modification. Results of disjoint subtrees remain valid.
+    std::unordered_set<const expression*> affected_roots;
+
+    for (auto subtree : modified_subtrees)
     {
-        auto search_result =
-            std::find(preserved_analyses.begin(), preserved_analyses.end(), id_and_node.first);
+        collect_nodes(*subtree, affected_roots);
 
-        if (search_result == preserved_analyses.end())
+        for (auto ancestor = subtree->parent(); ancestor; ancestor = ancestor->parent())
         {
-            analysis_table_.at(id_and_node.first)->invalidate();
+            affected_roots.insert(ancestor);
+        }
+    }
+
+    for (auto& id_and_node : analysis_table_)
+    {
+        if (!preserved_analyses.is_preserved(id_and_node.first))
+        {
+            id_and_node.second->invalidate(affected_roots);
         }
     }
 }
@@ -108,6 +432,18 @@ void analysis_manager::invalidate()
     }
 }
 
+void analysis_manager::discard_results_outside_of(const expression& root)
+{
+    std::unordered_set<const expression*> live_nodes;
+
+    collect_nodes(root, live_nodes);
+
+    for (auto& id_and_node : analysis_table_)
+    {
+        id_and_node.second->discard_dead_results(live_nodes);
+    }
+}
+
 pass_manager::pass_manager() : analysis_man_(resource_manager_)
 {
 }
@@ -119,6 +455,8 @@ preserved_analyses_info pass_manager::run(function& fun)
         auto preserved_analyses = transformation.run(fun, analysis_man_);
 
         analysis_man_.invalidate(preserved_analyses);
+
+        analysis_man_.discard_results_outside_of(fun.body());
     }
 
     return {};
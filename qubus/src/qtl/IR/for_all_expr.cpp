@@ -74,6 +74,16 @@ std::size_t for_all_expr::arity() const
     return 1;
 }
 
+std::vector<std::unique_ptr<expression>> for_all_expr::release_children()
+{
+    std::vector<std::unique_ptr<expression>> children;
+    children.reserve(1);
+
+    children.push_back(std::move(body_));
+
+    return children;
+}
+
 std::unique_ptr<expression>
 for_all_expr::substitute_subexpressions(std::vector<std::unique_ptr<expression>> new_children) const
 {
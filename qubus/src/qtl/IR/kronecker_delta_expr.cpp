@@ -59,6 +59,17 @@ std::size_t kronecker_delta_expr::arity() const
     return 2;
 }
 
+std::vector<std::unique_ptr<expression>> kronecker_delta_expr::release_children()
+{
+    std::vector<std::unique_ptr<expression>> children;
+    children.reserve(2);
+
+    children.push_back(std::move(first_index_));
+    children.push_back(std::move(second_index_));
+
+    return children;
+}
+
 std::unique_ptr<expression> kronecker_delta_expr::substitute_subexpressions(
     std::vector<std::unique_ptr<expression>> new_children) const
 {
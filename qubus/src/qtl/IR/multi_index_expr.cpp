@@ -38,6 +38,11 @@ std::size_t multi_index_expr::arity() const
     return 0;
 }
 
+std::vector<std::unique_ptr<expression>> multi_index_expr::release_children()
+{
+    return {};
+}
+
 std::unique_ptr<expression>
 multi_index_expr::substitute_subexpressions(std::vector<std::unique_ptr<expression>> new_children) const
 {
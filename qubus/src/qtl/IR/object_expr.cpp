@@ -31,6 +31,11 @@ std::size_t object_expr::arity() const
     return 0;
 }
 
+std::vector<std::unique_ptr<expression>> object_expr::release_children()
+{
+    return {};
+}
+
 std::unique_ptr<expression>
 object_expr::substitute_subexpressions(std::vector<std::unique_ptr<expression>> new_children) const
 {
@@ -73,6 +73,16 @@ std::size_t sum_expr::arity() const
     return 1;
 }
 
+std::vector<std::unique_ptr<expression>> sum_expr::release_children()
+{
+    std::vector<std::unique_ptr<expression>> children;
+    children.reserve(1);
+
+    children.push_back(std::move(body_));
+
+    return children;
+}
+
 std::unique_ptr<expression>
 sum_expr::substitute_subexpressions(std::vector<std::unique_ptr<expression>> new_children) const
 {
@@ -10,11 +10,25 @@
 #include <qubus/qtl/sparse_patterns.hpp>
 
 #include <qubus/IR/compound_expr.hpp>
+#include <qubus/IR/expression_arena.hpp>
+#include <qubus/IR/function.hpp>
+#include <qubus/IR/module.hpp>
+
+#include <qubus/loop_optimizer.hpp>
+#include <qubus/pass_manager.hpp>
+
+#include <qubus/util/unused.hpp>
 
 #include <boost/range/adaptor/reversed.hpp>
 
 #include <algorithm>
 #include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace qubus
 {
@@ -24,6 +38,72 @@ namespace qtl
 namespace
 {
 std::atomic<kernel*> current_kernel{nullptr};
+
+/** \brief Applies a rewrite to each computation of a kernel.
+ *
+ * The body of the transformed function is a sequence of the computations. Computations which
+ * are not changed by the rewrite are kept, such that only the results of the analyses of the
+ * rewritten computations and of the body itself are invalidated.
+ */
+class computation_rewrite_pass
+{
+public:
+    explicit computation_rewrite_pass(
+        std::function<std::unique_ptr<expression>(const expression&)> rewrite_)
+    : rewrite_(std::move(rewrite_))
+    {
+    }
+
+    preserved_analyses_info run(function& fun, analysis_manager& QUBUS_UNUSED(manager)) const
+    {
+        const auto& body = fun.body();
+
+        std::vector<std::unique_ptr<expression>> rewritten_computations;
+        rewritten_computations.reserve(body.arity());
+
+        bool is_modified = false;
+
+        for (const auto& computation : body.sub_expressions())
+        {
+            auto rewritten_computation = rewrite_(computation);
+
+            if (*rewritten_computation != computation)
+            {
+                rewritten_computations.push_back(std::move(rewritten_computation));
+
+                is_modified = true;
+            }
+            else
+            {
+                rewritten_computations.push_back(nullptr);
+            }
+        }
+
+        if (!is_modified)
+            return preserved_analyses_info::all();
+
+        auto computations = fun.release_body()->release_children();
+
+        preserved_analyses_info preserved_analyses;
+
+        for (std::size_t i = 0; i < computations.size(); ++i)
+        {
+            if (rewritten_computations[i])
+            {
+                computations[i] = std::move(rewritten_computations[i]);
+
+                preserved_analyses.mark_modified(*computations[i]);
+            }
+        }
+
+        fun.substitute_body(sequenced_tasks(std::move(computations)));
+
+        return preserved_analyses;
+    }
+
+private:
+    std::function<std::unique_ptr<expression>(const expression&)> rewrite_;
+};
 }
 
 namespace this_kernel
@@ -50,30 +130,70 @@ void construct(kernel& new_kernel, std::function<void()> constructor)
 }
 }
 
-void kernel::translate_kernel(std::vector<variable_declaration> params)
+void kernel::translate_kernel(std::vector<variable_declaration> params,
+                              const kernel_options& options)
 {
     std::vector<std::tuple<variable_declaration, object>> parameter_map;
 
+    // The object extraction queries the types of the objects and might therefore suspend
+    // the current HPX thread, which can be resumed on another OS thread. Since the active
+    // arena is a property of the OS thread, the extraction has to run outside of it.
     for (auto& expr : computations_)
     {
         expr = extract_objects(*expr, parameter_map);
+    }
+
+    {
+        // Every pass creates a new version of the code. The intermediate versions are
+        // allocated from an arena and released in bulk once the translation is complete.
+        // Only pure, non-blocking rewrites may be performed while the arena is active.
+        expression_arena arena;
+
+        {
+            expression_arena_scope arena_scope(arena);
 
-        expr = legalize_expression(*expr);
+            module pipeline_module(symbol_id("qtl_pipeline"));
 
-        expr = expand_multi_indices(*expr);
+            function pipeline(pipeline_module, "pipeline", {},
+                              variable_declaration("result", types::unknown{}),
+                              sequenced_tasks(std::move(computations_)));
 
-        expr = fold_kronecker_deltas(*expr);
+            pass_manager pass_man;
 
-        expr = optimize_sparse_patterns(*expr);
+            pass_man.add_transformation(computation_rewrite_pass(legalize_expression));
+            pass_man.add_transformation(computation_rewrite_pass(expand_multi_indices));
+            pass_man.add_transformation(computation_rewrite_pass(fold_kronecker_deltas));
+            pass_man.add_transformation(computation_rewrite_pass(optimize_sparse_patterns));
+            pass_man.add_transformation(computation_rewrite_pass(lower_top_level_sums));
+            pass_man.add_transformation(computation_rewrite_pass(lower_abstract_indices));
 
-        expr = lower_top_level_sums(*expr);
+            pass_man.run(pipeline);
 
-        expr = lower_abstract_indices(*expr);
+            computations_ = pipeline.release_body()->release_children();
+        }
+
+        // The translated code outlives the arena.
+        for (auto& expr : computations_)
+        {
+            expr = clone(*expr);
+        }
     }
 
     auto root_task = sequenced_tasks(std::move(computations_));
 
-    auto mod = wrap_code_in_task(std::move(root_task));
+    std::map<std::string, std::string> pragmas;
+
+    if (options.optimize_loops)
+    {
+        pragmas.emplace(optimize_loops_pragma, "true");
+    }
+
+    if (options.autotune_loops)
+    {
+        pragmas.emplace(autotune_loops_pragma, "true");
+    }
+
+    auto mod = wrap_code_in_task(std::move(root_task), pragmas);
 
     const auto& entry = mod->lookup_function("entry");
 
@@ -102,7 +222,8 @@ void kernel::translate_kernel(std::vector<variable_declaration> params)
                  "Wrong number of arguments mappings.");
     QUBUS_ASSERT(mutable_argument_map_.size() == 1, "Wrong number of arguments mappings.");
 
-    get_runtime().get_module_library().add(std::move(mod)).get();
+    // Equivalent kernels share their module and therefore also the compiled code.
+    get_runtime().get_module_library().add_if_absent(std::move(mod)).get();
 }
 
 }
@@ -108,7 +108,7 @@ std::unique_ptr<expression> legalize_expression(const expression& expr)
     auto m3 = ::qubus::pattern::make_matcher<expression, std::unique_ptr<expression>>().case_(
         pattern::captured_multi_index(idx, _), [&] { return var(idx.get()); });
 
-    root = ::qubus::pattern::substitute(*root, m3);
+    root = ::qubus::pattern::substitute(std::move(root), m3);
 
     return root;
 }
@@ -175,7 +175,7 @@ std::unique_ptr<expression> generate_computational_part(
         subscription(pattern::sparse_tensor(qubus::pattern::value(the_sparse_tensor)), _),
         [&] { return subscription(std::move(val), clone(*sparse_idx)); });
 
-    current_expr = qubus::pattern::substitute(*current_expr, m3);
+    current_expr = qubus::pattern::substitute(std::move(current_expr), m3);
 
     auto sparse_index = subscription(std::move(col), clone(*sparse_idx));
     auto innermost_dense_index = var(i) + var(ii);
@@ -186,7 +186,7 @@ std::unique_ptr<expression> generate_computational_part(
     auto m4 = qubus::pattern::make_matcher<expression, std::unique_ptr<expression>>().case_(
         index(idx), [&] { return clone(*index_map.at(idx.get())); });
 
-    current_expr = qubus::pattern::substitute(*current_expr, m4);
+    current_expr = qubus::pattern::substitute(std::move(current_expr), m4);
 
     std::vector<std::unique_ptr<expression>> macro_args;
     macro_args.reserve(1);
@@ -3,8 +3,10 @@
 #include <qubus/variable_access_analysis.hpp>
 
 #include <qubus/util/assert.hpp>
+#include <qubus/util/hash.hpp>
 
-#include <algorithm>
+#include <iomanip>
+#include <sstream>
 #include <vector>
 
 namespace qubus
@@ -12,56 +14,45 @@ namespace qubus
 namespace qtl
 {
 
-namespace
-{
-template <typename Range, typename T>
-bool contains(const Range& range, const T& value)
-{
-    return std::find(range.begin(), range.end(), value) != range.end();
-}
-}
-
-std::unique_ptr<module> wrap_code_in_task(std::unique_ptr<expression> expr)
+std::unique_ptr<module> wrap_code_in_task(std::unique_ptr<expression> expr,
+                                          const std::map<std::string, std::string>& pragmas)
 {
     pass_resource_manager resource_man;
     analysis_manager analysis_man(resource_man);
 
-    variable_access_analysis analysis;
+    // Structurally equal tasks share the result via the analysis cache.
+    const auto& usage = analysis_man.get_analysis<variable_usage_analysis>(*expr);
 
-    auto result = analysis.run(*expr, analysis_man, resource_man);
+    std::vector<variable_declaration> mutable_params = usage.written_variables();
+    std::vector<variable_declaration> immutable_params = usage.read_variables();
 
-    auto access_set = result.query_accesses_for_location(*expr);
+    QUBUS_ASSERT(mutable_params.size() == 1, "Only one mutable param is currently allowed.");
 
-    std::vector<variable_declaration> mutable_params;
+    std::vector<variable_declaration> signature = immutable_params;
+    signature.push_back(mutable_params[0]);
 
-    for (const auto& access : access_set.get_write_accesses())
-    {
-        if (!contains(mutable_params, access.variable()))
-        {
-            mutable_params.push_back(access.variable());
-        }
-    }
-
-    std::vector<variable_declaration> immutable_params;
+    auto code_hash = canonical_hash(*expr, signature);
 
-    for (const auto& access : access_set.get_read_accesses())
+    for (const auto& pragma : pragmas)
     {
-        if (!contains(mutable_params, access.variable()) &&
-            !contains(immutable_params, access.variable()))
-        {
-            immutable_params.push_back(access.variable());
-        }
+        util::hash_combine(code_hash, pragma.first);
+        util::hash_combine(code_hash, pragma.second);
     }
 
-    QUBUS_ASSERT(mutable_params.size() == 1, "Only one mutable param is currently allowed.");
+    std::ostringstream module_name;
 
-    static long int counter = 0;
+    module_name << "kernel_" << std::hex << std::setfill('0') << std::setw(16) << code_hash;
 
-    auto mod = std::make_unique<module>(symbol_id("dummy" + std::to_string(counter++)));
+    auto mod = std::make_unique<module>(symbol_id(module_name.str()));
 
     mod->add_function("entry", std::move(immutable_params), std::move(mutable_params[0]),
                       std::move(expr));
 
+    for (const auto& pragma : pragmas)
+    {
+        mod->set_pragma(pragma.first, pragma.second);
+    }
+
     return mod;
 }
 }
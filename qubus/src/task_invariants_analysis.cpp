@@ -6,6 +6,7 @@
 #include <qubus/pattern/core.hpp>
 
 #include <qubus/util/assert.hpp>
+#include <qubus/util/unused.hpp>
 
 namespace qubus
 {
@@ -114,6 +115,16 @@ task_invariants_analysis_pass::run(const expression& root, analysis_manager& man
     return task_invariants_analysis_result(manager.get_analysis<basic_alias_analysis_pass>(root));
 }
 
+task_invariants_analysis_result
+task_invariants_analysis_pass::relocate(const task_invariants_analysis_result& QUBUS_UNUSED(result),
+                                        const expression_relocation& QUBUS_UNUSED(relocation),
+                                        const expression& root, analysis_manager& manager,
+                                        pass_resource_manager& resource_manager) const
+{
+    // The result only refers to other analyses, which are requested for root again.
+    return run(root, manager, resource_manager);
+}
+
 std::vector<analysis_id> task_invariants_analysis_pass::required_analyses() const
 {
     return {get_analysis_id<basic_alias_analysis_pass>()};
@@ -5,6 +5,8 @@
 #include <qubus/isl/ast_builder.hpp>
 #include <qubus/isl/map.hpp>
 
+#include <qubus/util/unused.hpp>
+
 #include <utility>
 
 namespace qubus
@@ -105,6 +107,16 @@ value_range_analysis_pass::run(const expression& root, analysis_manager& manager
                                        resource_manager);
 }
 
+value_range_analysis_result
+value_range_analysis_pass::relocate(const value_range_analysis_result& QUBUS_UNUSED(result),
+                                    const expression_relocation& QUBUS_UNUSED(relocation),
+                                    const expression& root, analysis_manager& manager,
+                                    pass_resource_manager& resource_manager) const
+{
+    // The result only refers to other analyses, which are requested for root again.
+    return run(root, manager, resource_manager);
+}
+
 std::vector<analysis_id> value_range_analysis_pass::required_analyses() const
 {
     return {get_analysis_id<value_set_analysis_pass>()};
@@ -5,6 +5,7 @@
 #include <boost/range/adaptor/transformed.hpp>
 
 #include <qubus/util/assert.hpp>
+#include <qubus/util/unused.hpp>
 
 namespace qubus
 {
@@ -111,6 +112,16 @@ value_set_analysis_pass::run(const expression& root, analysis_manager& manager,
                                      resource_manager.get_isl_ctx());
 }
 
+value_set_analysis_result
+value_set_analysis_pass::relocate(const value_set_analysis_result& QUBUS_UNUSED(result),
+                                  const expression_relocation& QUBUS_UNUSED(relocation),
+                                  const expression& root, analysis_manager& manager,
+                                  pass_resource_manager& resource_manager) const
+{
+    // The result only refers to other analyses, which are requested for root again.
+    return run(root, manager, resource_manager);
+}
+
 std::vector<analysis_id> value_set_analysis_pass::required_analyses() const
 {
     return {get_analysis_id<axiom_analysis_pass>()};
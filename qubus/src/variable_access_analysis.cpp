@@ -6,6 +6,7 @@
 #include <qubus/util/assert.hpp>
 #include <qubus/util/optional_ref.hpp>
 #include <qubus/util/unreachable.hpp>
+#include <qubus/util/unused.hpp>
 
 #include <algorithm>
 #include <stack>
@@ -58,6 +59,19 @@ decompose_access(const access_expr& access)
 
     QUBUS_UNREACHABLE_BECAUSE("'access' is of an unknown access type.");
 }
+
+access relocate_access(const access& acc, const expression_relocation& relocation)
+{
+    std::vector<std::reference_wrapper<const access_qualifier_expr>> qualifiers;
+    qualifiers.reserve(acc.qualifiers().size());
+
+    for (const auto& qualifier : acc.qualifiers())
+    {
+        qualifiers.push_back(relocation.map(qualifier.get()));
+    }
+
+    return access(relocation.map(acc.base()), std::move(qualifiers));
+}
 }
 
 access::access(const access_expr& access_) : access(decompose_access(access_))
@@ -184,6 +198,37 @@ public:
         return subsets_ | boost::adaptors::indirected;
     }
 
+    std::unique_ptr<access_set_node> relocate(const expression_relocation& relocation) const
+    {
+        std::vector<access> read_accesses;
+        read_accesses.reserve(local_read_accesses_.size());
+
+        for (const auto& acc : local_read_accesses_)
+        {
+            read_accesses.push_back(relocate_access(acc, relocation));
+        }
+
+        std::vector<access> write_accesses;
+        write_accesses.reserve(local_write_accesses_.size());
+
+        for (const auto& acc : local_write_accesses_)
+        {
+            write_accesses.push_back(relocate_access(acc, relocation));
+        }
+
+        std::vector<std::unique_ptr<access_set_node>> subsets;
+        subsets.reserve(subsets_.size());
+
+        for (const auto& subset : subsets_)
+        {
+            subsets.push_back(subset->relocate(relocation));
+        }
+
+        return std::make_unique<access_set_node>(relocation.map(location()),
+                                                 std::move(read_accesses),
+                                                 std::move(write_accesses), std::move(subsets));
+    }
+
 private:
     std::reference_wrapper<const expression> location_;
 
@@ -222,6 +267,11 @@ public:
         add_set_to_index(*this->global_access_set_);
     }
 
+    const access_set_node& global_access_set() const
+    {
+        return *global_access_set_;
+    }
+
     access_set query_accesses_for_location(const expression& location, access_kind kind) const
     {
         auto search_result = location_index_.find(&location);
@@ -426,10 +476,103 @@ variable_access_analysis::run(const expression& root, analysis_manager& manager,
     return variable_access_analyis_result(std::move(access_index));
 }
 
+variable_access_analyis_result
+variable_access_analysis::relocate(const variable_access_analyis_result& result,
+                                   const expression_relocation& relocation,
+                                   const expression& QUBUS_UNUSED(root),
+                                   analysis_manager& QUBUS_UNUSED(manager),
+                                   pass_resource_manager& QUBUS_UNUSED(resource_manager)) const
+{
+    auto global_access_set = result.access_index_->global_access_set().relocate(relocation);
+
+    auto access_index = std::make_unique<variable_access_index>(std::move(global_access_set));
+
+    return variable_access_analyis_result(std::move(access_index));
+}
+
 std::vector<analysis_id> variable_access_analysis::required_analyses() const
 {
     return {};
 }
 
 QUBUS_REGISTER_ANALYSIS_PASS(variable_access_analysis);
+
+variable_usage_analysis_result::variable_usage_analysis_result(
+    std::vector<variable_declaration> read_variables_,
+    std::vector<variable_declaration> written_variables_)
+: read_variables_(std::move(read_variables_)), written_variables_(std::move(written_variables_))
+{
+}
+
+namespace
+{
+bool contains(const std::vector<variable_declaration>& variables,
+              const variable_declaration& variable)
+{
+    return std::find(variables.begin(), variables.end(), variable) != variables.end();
+}
+}
+
+variable_usage_analysis_result
+variable_usage_analysis::run(const expression& root, analysis_manager& manager,
+                             pass_resource_manager& resource_manager) const
+{
+    const auto& accesses = manager.get_analysis<variable_access_analysis>(root);
+
+    auto access_set = accesses.query_accesses_for_location(root);
+
+    std::vector<variable_declaration> written_variables;
+
+    for (const auto& access : access_set.get_write_accesses())
+    {
+        if (!contains(written_variables, access.variable()))
+        {
+            written_variables.push_back(access.variable());
+        }
+    }
+
+    std::vector<variable_declaration> read_variables;
+
+    for (const auto& access : access_set.get_read_accesses())
+    {
+        if (!contains(written_variables, access.variable()) &&
+            !contains(read_variables, access.variable()))
+        {
+            read_variables.push_back(access.variable());
+        }
+    }
+
+    return variable_usage_analysis_result(std::move(read_variables),
+                                          std::move(written_variables));
+}
+
+variable_usage_analysis_result
+variable_usage_analysis::relocate(const variable_usage_analysis_result& result,
+                                  const expression_relocation& relocation,
+                                  const expression& QUBUS_UNUSED(root),
+                                  analysis_manager& QUBUS_UNUSED(manager),
+                                  pass_resource_manager& QUBUS_UNUSED(resource_manager)) const
+{
+    auto relocate_variables = [&relocation](const std::vector<variable_declaration>& variables) {
+        std::vector<variable_declaration> relocated_variables;
+        relocated_variables.reserve(variables.size());
+
+        for (const auto& var : variables)
+        {
+            relocated_variables.push_back(relocation.map(var));
+        }
+
+        return relocated_variables;
+    };
+
+    return variable_usage_analysis_result(relocate_variables(result.read_variables()),
+                                          relocate_variables(result.written_variables()));
+}
+
+std::vector<analysis_id> variable_usage_analysis::required_analyses() const
+{
+    return {get_analysis_id<variable_access_analysis>()};
+}
+
+QUBUS_REGISTER_ANALYSIS_PASS(variable_usage_analysis);
 }
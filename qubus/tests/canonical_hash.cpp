@@ -0,0 +1,153 @@
+#include <qubus/IR/qir.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+std::unique_ptr<qubus::expression> make_copy_loop(const qubus::variable_declaration& i,
+                                                  const qubus::variable_declaration& A,
+                                                  const qubus::variable_declaration& B)
+{
+    using namespace qubus;
+
+    return for_(i, integer_literal(0), integer_literal(10),
+                assign(subscription(variable_ref(A), variable_ref(i)),
+                       subscription(variable_ref(B), variable_ref(i))));
+}
+}
+
+TEST(canonical_hash, independent_of_variable_identities)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+    variable_declaration A("A", types::array(types::double_{}, 1));
+    variable_declaration B("B", types::array(types::double_{}, 1));
+
+    variable_declaration j("j", types::integer{});
+    variable_declaration C("C", types::array(types::double_{}, 1));
+    variable_declaration D("D", types::array(types::double_{}, 1));
+
+    auto lhs = make_copy_loop(i, A, B);
+    auto rhs = make_copy_loop(j, C, D);
+
+    EXPECT_EQ(canonical_hash(*lhs, {B, A}), canonical_hash(*rhs, {D, C}));
+}
+
+TEST(canonical_hash, depends_on_the_order_of_the_free_variables)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+    variable_declaration A("A", types::array(types::double_{}, 1));
+    variable_declaration B("B", types::array(types::double_{}, 1));
+
+    auto expr = make_copy_loop(i, A, B);
+
+    EXPECT_NE(canonical_hash(*expr, {B, A}), canonical_hash(*expr, {A, B}));
+}
+
+TEST(canonical_hash, depends_on_the_variable_types)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+    variable_declaration A("A", types::array(types::double_{}, 1));
+    variable_declaration B("B", types::array(types::double_{}, 1));
+
+    variable_declaration C("C", types::array(types::float_{}, 1));
+    variable_declaration D("D", types::array(types::float_{}, 1));
+
+    auto lhs = make_copy_loop(i, A, B);
+    auto rhs = make_copy_loop(i, C, D);
+
+    EXPECT_NE(canonical_hash(*lhs, {B, A}), canonical_hash(*rhs, {D, C}));
+}
+
+TEST(alpha_equivalent, renamed_variables_are_equivalent)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+    variable_declaration A("A", types::array(types::double_{}, 1));
+    variable_declaration B("B", types::array(types::double_{}, 1));
+
+    variable_declaration j("j", types::integer{});
+    variable_declaration C("C", types::array(types::double_{}, 1));
+    variable_declaration D("D", types::array(types::double_{}, 1));
+
+    auto lhs = make_copy_loop(i, A, B);
+    auto rhs = make_copy_loop(j, C, D);
+
+    EXPECT_TRUE(alpha_equivalent(*lhs, {B, A}, *rhs, {D, C}));
+    EXPECT_FALSE(alpha_equivalent(*lhs, {B, A}, *rhs, {C, D}));
+    EXPECT_FALSE(alpha_equivalent(*lhs, {B, A}, *rhs, {D}));
+}
+
+TEST(alpha_equivalent, variables_have_to_correspond_one_to_one)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+    variable_declaration A("A", types::array(types::double_{}, 1));
+    variable_declaration B("B", types::array(types::double_{}, 1));
+
+    auto copy = make_copy_loop(i, A, B);
+    auto self_copy = make_copy_loop(i, A, A);
+
+    EXPECT_FALSE(alpha_equivalent(*copy, {}, *self_copy, {}));
+    EXPECT_FALSE(alpha_equivalent(*self_copy, {}, *copy, {}));
+}
+
+TEST(alpha_equivalent, detects_structural_differences)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+    variable_declaration A("A", types::array(types::double_{}, 1));
+    variable_declaration B("B", types::array(types::double_{}, 1));
+
+    auto lhs = make_copy_loop(i, A, B);
+    auto rhs = for_(i, integer_literal(0), integer_literal(11),
+                    assign(subscription(variable_ref(A), variable_ref(i)),
+                           subscription(variable_ref(B), variable_ref(i))));
+
+    EXPECT_FALSE(alpha_equivalent(*lhs, {B, A}, *rhs, {B, A}));
+    EXPECT_TRUE(alpha_equivalent(*lhs, {B, A}, *lhs, {B, A}));
+}
+
+TEST(alpha_equivalent, detects_differences_of_node_properties)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+    variable_declaration x("x", types::double_{});
+    variable_declaration y("y", types::float_{});
+
+    auto make_call = [](const std::string& name, const variable_declaration& arg) {
+        std::vector<std::unique_ptr<expression>> args;
+        args.push_back(variable_ref(arg));
+
+        return intrinsic_function(name, std::move(args));
+    };
+
+    std::vector<std::pair<std::unique_ptr<expression>, std::unique_ptr<expression>>> pairs;
+
+    pairs.emplace_back(variable_ref(x) + double_literal(1), variable_ref(x) - double_literal(1));
+    pairs.emplace_back(variable_ref(x) + double_literal(1), variable_ref(x) + double_literal(2));
+    pairs.emplace_back(make_call("sqrt", x), make_call("exp", x));
+    pairs.emplace_back(make_call("sqrt", x), make_call("sqrt", y));
+    pairs.emplace_back(for_(i, integer_literal(0), integer_literal(10), variable_ref(x)),
+                       parallel_for(i, integer_literal(0), integer_literal(10), variable_ref(x)));
+
+    for (const auto& pair : pairs)
+    {
+        EXPECT_FALSE(alpha_equivalent(*pair.first, {}, *pair.second, {}));
+        EXPECT_TRUE(alpha_equivalent(*pair.first, {}, *pair.first, {}));
+    }
+}
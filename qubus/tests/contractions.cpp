@@ -2,14 +2,25 @@
 
 #include <qubus/qtl/all.hpp>
 
+#include <qubus/loop_optimizer.hpp>
+
 #include <hpx/hpx_init.hpp>
 
 #include <qubus/util/unused.hpp>
 
+#include <algorithm>
 #include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
 #include <vector>
 
+#include <unistd.h>
+
 #include <gtest/gtest.h>
 
 TEST(contractions, simple_contraction)
@@ -102,6 +113,310 @@ TEST(contractions, simple_contraction)
     ASSERT_NEAR(error, 0.0, 1e-12);
 }
 
+namespace
+{
+std::string autotuning_database_path;
+
+/** \brief Reads the tile sizes recorded in the autotuning database.
+ */
+std::vector<std::vector<qubus::util::index_t>> read_recorded_tile_sizes()
+{
+    std::vector<std::vector<qubus::util::index_t>> recorded_tile_sizes;
+
+    std::ifstream db(autotuning_database_path);
+
+    std::string line;
+
+    while (std::getline(db, line))
+    {
+        std::istringstream entry(line);
+
+        std::string build_stamp;
+        std::string key;
+
+        if (!(entry >> build_stamp >> key))
+            continue;
+
+        std::vector<qubus::util::index_t> tile_sizes;
+
+        qubus::util::index_t tile_size;
+
+        while (entry >> tile_size)
+        {
+            tile_sizes.push_back(tile_size);
+        }
+
+        recorded_tile_sizes.push_back(std::move(tile_sizes));
+    }
+
+    return recorded_tile_sizes;
+}
+
+qubus::qtl::kernel_options make_loop_optimization_options(bool autotune_loops)
+{
+    qubus::qtl::kernel_options options;
+    options.optimize_loops = true;
+    options.autotune_loops = autotune_loops;
+
+    return options;
+}
+
+/** \brief Checks that the contraction has been computed by a register-blocked micro-kernel.
+ */
+void expect_micro_kernel(const qubus::qtl::kernel& contraction)
+{
+    auto reports =
+        qubus::get_loop_optimization_reports(contraction.entry_point().get_prefix());
+
+    ASSERT_EQ(reports.size(), 1u);
+    EXPECT_TRUE(reports[0].is_scop);
+    EXPECT_TRUE(reports[0].has_been_optimized);
+
+    // The micro-kernel shape is only chosen if the statement has been matched as a contraction.
+    EXPECT_EQ(reports[0].micro_kernel_shape.size(), 3u);
+}
+
+/** \brief Checks that all tile size candidates have been benchmarked and that the selected
+ *         candidate has been recorded in the autotuning database.
+ */
+void expect_autotuned(const qubus::qtl::kernel& contraction)
+{
+    auto module_id = contraction.entry_point().get_prefix();
+
+    auto reports = qubus::get_loop_optimization_reports(module_id);
+
+    ASSERT_EQ(reports.size(), 1u);
+
+    auto candidates = qubus::get_tile_size_candidates();
+    auto recorded_tile_sizes = read_recorded_tile_sizes();
+
+    bool is_selection_recorded = false;
+
+    for (std::size_t i = 0; i < candidates.size(); ++i)
+    {
+        // Each candidate is compiled as a separate module right before it is benchmarked.
+        auto candidate_reports = qubus::get_loop_optimization_reports(qubus::symbol_id(
+            module_id.string() + ".autotuning_candidate" + std::to_string(i)));
+
+        ASSERT_EQ(candidate_reports.size(), 1u);
+
+        if (!candidates[i].empty())
+        {
+            EXPECT_EQ(candidate_reports[0].tile_sizes, candidates[i]);
+        }
+
+        if (candidate_reports[0].tile_sizes == reports[0].tile_sizes &&
+            std::find(recorded_tile_sizes.begin(), recorded_tile_sizes.end(), candidates[i]) !=
+                recorded_tile_sizes.end())
+        {
+            is_selection_recorded = true;
+        }
+    }
+
+    EXPECT_TRUE(is_selection_recorded);
+}
+}
+
+/** \brief Contractions of the shape M x K times K x N whose extents are, in general, not multiples
+ *         of the tile sizes.
+ *
+ * Each shape is computed with the tile sizes of the cache model as well as with autotuned tile
+ * sizes.
+ */
+class loop_optimized_contractions
+: public ::testing::TestWithParam<
+      std::tuple<std::tuple<long int, long int, long int>, qubus::qtl::kernel_options>>
+{
+};
+
+INSTANTIATE_TEST_CASE_P(
+    shapes, loop_optimized_contractions,
+    ::testing::Combine(::testing::Values(std::make_tuple(1l, 1l, 1l), std::make_tuple(5l, 7l, 3l),
+                                         std::make_tuple(6l, 8l, 16l),
+                                         std::make_tuple(97l, 61l, 131l),
+                                         std::make_tuple(150l, 150l, 150l),
+                                         std::make_tuple(250l, 33l, 19l)),
+                       ::testing::Values(make_loop_optimization_options(false),
+                                         make_loop_optimization_options(true))));
+
+TEST_P(loop_optimized_contractions, matrix_multiplication)
+{
+    using namespace qubus;
+    using namespace qtl;
+
+    const auto& [shape, options] = GetParam();
+
+    auto [M, K, N] = shape;
+
+    std::vector<double> A2(M * K);
+    std::vector<double> B2(K * N);
+    std::vector<double> C2(M * N, 0.0);
+
+    std::random_device rd;
+
+    std::mt19937 gen(rd());
+
+    std::uniform_real_distribution<double> dist(-10.0, 10.0);
+
+    tensor<double, 2> A(M, K);
+    tensor<double, 2> B(K, N);
+    tensor<double, 2> C(M, N);
+
+    {
+        auto A_view = get_view(A, qubus::writable, qubus::arch::host).get();
+
+        for (long int i = 0; i < M; ++i)
+        {
+            for (long int k = 0; k < K; ++k)
+            {
+                A2[i * K + k] = dist(gen);
+                A_view(i, k) = A2[i * K + k];
+            }
+        }
+
+        auto B_view = get_view(B, qubus::writable, qubus::arch::host).get();
+
+        for (long int k = 0; k < K; ++k)
+        {
+            for (long int j = 0; j < N; ++j)
+            {
+                B2[k * N + j] = dist(gen);
+                B_view(k, j) = B2[k * N + j];
+            }
+        }
+    }
+
+    kernel matrix_multiplication(
+        [A, B, C] {
+            qtl::index i, j, k;
+
+            C(i, j) = sum(k, A(i, k) * B(k, j));
+        },
+        options);
+
+    matrix_multiplication();
+
+    expect_micro_kernel(matrix_multiplication);
+
+    if (options.autotune_loops)
+    {
+        expect_autotuned(matrix_multiplication);
+    }
+
+    for (long int i = 0; i < M; ++i)
+    {
+        for (long int j = 0; j < N; ++j)
+        {
+            for (long int k = 0; k < K; ++k)
+            {
+                C2[i * N + j] += A2[i * K + k] * B2[k * N + j];
+            }
+        }
+    }
+
+    {
+        auto C_view = get_view(C, qubus::immutable, qubus::arch::host).get();
+
+        for (long int i = 0; i < M; ++i)
+        {
+            for (long int j = 0; j < N; ++j)
+            {
+                ASSERT_NEAR(C_view(i, j), C2[i * N + j], 1e-10 * K * 100.0)
+                    << "at (" << i << ", " << j << ")";
+            }
+        }
+    }
+}
+
+TEST_P(loop_optimized_contractions, contraction_with_transposed_operands)
+{
+    using namespace qubus;
+    using namespace qtl;
+
+    const auto& [shape, options] = GetParam();
+
+    auto [M, K, N] = shape;
+
+    std::vector<double> A2(K * M);
+    std::vector<double> B2(N * K);
+    std::vector<double> C2(M * N, 0.0);
+
+    std::random_device rd;
+
+    std::mt19937 gen(rd());
+
+    std::uniform_real_distribution<double> dist(-10.0, 10.0);
+
+    tensor<double, 2> A(K, M);
+    tensor<double, 2> B(N, K);
+    tensor<double, 2> C(M, N);
+
+    {
+        auto A_view = get_view(A, qubus::writable, qubus::arch::host).get();
+
+        for (long int k = 0; k < K; ++k)
+        {
+            for (long int i = 0; i < M; ++i)
+            {
+                A2[k * M + i] = dist(gen);
+                A_view(k, i) = A2[k * M + i];
+            }
+        }
+
+        auto B_view = get_view(B, qubus::writable, qubus::arch::host).get();
+
+        for (long int j = 0; j < N; ++j)
+        {
+            for (long int k = 0; k < K; ++k)
+            {
+                B2[j * K + k] = dist(gen);
+                B_view(j, k) = B2[j * K + k];
+            }
+        }
+    }
+
+    kernel contraction(
+        [A, B, C] {
+            qtl::index i, j, k;
+
+            C(i, j) = sum(k, A(k, i) * B(j, k));
+        },
+        options);
+
+    contraction();
+
+    expect_micro_kernel(contraction);
+
+    if (options.autotune_loops)
+    {
+        expect_autotuned(contraction);
+    }
+
+    for (long int i = 0; i < M; ++i)
+    {
+        for (long int j = 0; j < N; ++j)
+        {
+            for (long int k = 0; k < K; ++k)
+            {
+                C2[i * N + j] += A2[k * M + i] * B2[j * K + k];
+            }
+        }
+    }
+
+    {
+        auto C_view = get_view(C, qubus::immutable, qubus::arch::host).get();
+
+        for (long int i = 0; i < M; ++i)
+        {
+            for (long int j = 0; j < N; ++j)
+            {
+                ASSERT_NEAR(C_view(i, j), C2[i * N + j], 1e-10 * K * 100.0)
+                    << "at (" << i << ", " << j << ")";
+            }
+        }
+    }
+}
+
 TEST(contractions, complex_matrix_multiplication)
 {
     using namespace qubus;
@@ -478,5 +793,23 @@ int main(int argc, char** argv)
 
     qubus::setup(rp);
 
-    return hpx::init();
+    // Tune the kernels from scratch and do not leave a database behind.
+    char autotuning_database_template[] = "/tmp/qubus_autotuning_XXXXXX";
+
+    int autotuning_database_fd = mkstemp(autotuning_database_template);
+
+    if (autotuning_database_fd == -1)
+        return EXIT_FAILURE;
+
+    close(autotuning_database_fd);
+
+    autotuning_database_path = autotuning_database_template;
+
+    setenv("QUBUS_AUTOTUNING_DB", autotuning_database_path.c_str(), 1);
+
+    auto result = hpx::init();
+
+    std::remove(autotuning_database_path.c_str());
+
+    return result;
 }
\ No newline at end of file
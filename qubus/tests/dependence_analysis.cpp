@@ -0,0 +1,133 @@
+#include <qubus/qubus.hpp>
+
+#include <qubus/IR/qir.hpp>
+#include <qubus/dependence_analysis.hpp>
+
+#include <hpx/hpx_init.hpp>
+
+#include <gtest/gtest.h>
+
+TEST(dependence_analysis, independent_iterations)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+    variable_declaration N("N", types::integer{});
+
+    variable_declaration A("A", types::array(types::double_{}, 1));
+    variable_declaration B("B", types::array(types::double_{}, 1));
+
+    auto root = for_(i, integer_literal(0), variable_ref(N),
+                     assign(subscription(variable_ref(A), variable_ref(i)),
+                            subscription(variable_ref(B), variable_ref(i))));
+
+    pass_resource_manager resource_man;
+    analysis_manager analysis_man(resource_man);
+
+    const auto& result = analysis_man.get_analysis<dependence_analysis_pass>(*root);
+
+    auto dependences = result.get_dependences(*root);
+
+    ASSERT_TRUE(dependences);
+
+    EXPECT_TRUE(dependences->dependences().empty());
+    EXPECT_FALSE(result.carries_dependences(*root));
+}
+
+TEST(dependence_analysis, carried_flow_dependence)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+    variable_declaration N("N", types::integer{});
+
+    variable_declaration A("A", types::array(types::double_{}, 1));
+
+    auto root = for_(i, integer_literal(1), variable_ref(N),
+                     assign(subscription(variable_ref(A), variable_ref(i)),
+                            subscription(variable_ref(A), variable_ref(i) - integer_literal(1))));
+
+    pass_resource_manager resource_man;
+    analysis_manager analysis_man(resource_man);
+
+    const auto& result = analysis_man.get_analysis<dependence_analysis_pass>(*root);
+
+    auto dependences = result.get_dependences(*root);
+
+    ASSERT_TRUE(dependences);
+    ASSERT_EQ(dependences->dependences().size(), 1u);
+
+    const auto& dep = dependences->dependences().front();
+
+    EXPECT_EQ(dep.variable, A);
+    EXPECT_EQ(dep.kind, dependence_kind::flow);
+    EXPECT_TRUE(dep.is_carried);
+    EXPECT_FALSE(dep.is_loop_independent);
+
+    ASSERT_EQ(dep.distance.size(), 1u);
+    ASSERT_TRUE(dep.distance[0]);
+    EXPECT_EQ(*dep.distance[0], 1);
+
+    EXPECT_TRUE(result.carries_dependences(*root));
+}
+
+TEST(dependence_analysis, inner_loop_of_a_reduction)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+    variable_declaration j("j", types::integer{});
+    variable_declaration N("N", types::integer{});
+
+    variable_declaration A("A", types::array(types::double_{}, 2));
+    variable_declaration x("x", types::array(types::double_{}, 1));
+    variable_declaration y("y", types::array(types::double_{}, 1));
+
+    std::vector<std::unique_ptr<expression>> indices;
+    indices.push_back(variable_ref(i));
+    indices.push_back(variable_ref(j));
+
+    auto inner_loop = for_(j, integer_literal(0), variable_ref(N),
+                           plus_assign(subscription(variable_ref(y), variable_ref(i)),
+                                       subscription(variable_ref(A), std::move(indices)) *
+                                           subscription(variable_ref(x), variable_ref(j))));
+
+    const auto& inner_loop_ref = *inner_loop;
+
+    auto root = for_(i, integer_literal(0), variable_ref(N), std::move(inner_loop));
+
+    pass_resource_manager resource_man;
+    analysis_manager analysis_man(resource_man);
+
+    const auto& result = analysis_man.get_analysis<dependence_analysis_pass>(*root);
+
+    // Each iteration of the outer loop updates a different element of y, whereas all
+    // iterations of the inner loop update the same element.
+    EXPECT_FALSE(result.carries_dependences(*root));
+    EXPECT_TRUE(result.carries_dependences(inner_loop_ref));
+}
+
+int hpx_main(int argc, char** argv)
+{
+    qubus::init(argc, argv);
+
+    auto result = RUN_ALL_TESTS();
+
+    qubus::finalize();
+
+    hpx::finalize();
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+
+    hpx::resource::partitioner rp(argc, argv, qubus::get_hpx_config(),
+                                  hpx::resource::partitioner_mode::mode_allow_oversubscription);
+
+    qubus::setup(rp);
+
+    return hpx::init();
+}
@@ -0,0 +1,102 @@
+#include <qubus/IR/expression_arena.hpp>
+#include <qubus/IR/qir.hpp>
+
+#include <gtest/gtest.h>
+
+TEST(expression_arena, expressions_are_allocated_from_the_active_arena)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+
+    expression_arena arena;
+
+    auto heap_expr = variable_ref(i) + integer_literal(1);
+
+    {
+        expression_arena_scope arena_scope(arena);
+
+        auto arena_expr = variable_ref(i) + integer_literal(1);
+
+        EXPECT_EQ(arena.number_of_live_expressions(), 3);
+        EXPECT_EQ(*arena_expr, *heap_expr);
+    }
+
+    EXPECT_EQ(arena.number_of_live_expressions(), 0);
+}
+
+TEST(expression_arena, cloned_expressions_outlive_the_arena)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+
+    std::unique_ptr<expression> expr;
+
+    {
+        expression_arena arena;
+
+        {
+            expression_arena_scope arena_scope(arena);
+
+            expr = for_(i, integer_literal(0), integer_literal(10), variable_ref(i));
+        }
+
+        expr = clone(*expr);
+
+        EXPECT_EQ(arena.number_of_live_expressions(), 0);
+    }
+
+    auto expected_expr = for_(i, integer_literal(0), integer_literal(10), variable_ref(i));
+
+    EXPECT_EQ(*expr, *expected_expr);
+}
+
+TEST(expression_arena, suspended_arenas_are_bypassed)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+
+    std::unique_ptr<expression> expr;
+
+    {
+        expression_arena arena;
+
+        {
+            expression_arena_scope arena_scope(arena);
+
+            auto arena_expr = variable_ref(i) + integer_literal(1);
+
+            {
+                expression_arena_suspension arena_suspension;
+
+                expr = clone(*arena_expr);
+            }
+
+            auto other_arena_expr = integer_literal(2);
+
+            EXPECT_EQ(arena.number_of_live_expressions(), 4);
+        }
+
+        EXPECT_EQ(arena.number_of_live_expressions(), 0);
+    }
+
+    EXPECT_EQ(*expr, *(variable_ref(i) + integer_literal(1)));
+}
+
+TEST(expression_arena_death_test, destroying_an_arena_with_live_expressions_terminates)
+{
+    using namespace qubus;
+
+    EXPECT_DEATH(
+        {
+            expression_arena arena;
+
+            expression_arena_scope arena_scope(arena);
+
+            // Leak the expression on purpose.
+            integer_literal(42).release();
+        },
+        "live expressions");
+}
@@ -0,0 +1,251 @@
+#include <qubus/qubus.hpp>
+
+#include <qubus/IR/parsing.hpp>
+#include <qubus/IR/qir.hpp>
+#include <qubus/index_narrowing.hpp>
+#include <qubus/pattern/core.hpp>
+
+#include <hpx/hpx_init.hpp>
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+std::string read_code(const std::string& filepath)
+{
+    std::ifstream fin(filepath);
+
+    auto first = std::istreambuf_iterator<char>(fin);
+    auto last = std::istreambuf_iterator<char>();
+
+    std::string code(first, last);
+
+    return code;
+}
+
+bool is_annotated(const qubus::expression& expr, const char* annotation_name)
+{
+    auto value = expr.annotations().lookup(annotation_name);
+
+    return value && value.as<bool>();
+}
+
+std::vector<double> execute_ellpack_spmv(const std::string& module_name, bool narrow_indices,
+                                         const std::vector<double>& val,
+                                         const std::vector<qubus::util::index_t>& col,
+                                         const std::vector<double>& x)
+{
+    using namespace qubus;
+
+    auto runtime = get_runtime();
+
+    auto obj_factory = runtime.get_object_factory();
+
+    util::index_t N = x.size();
+    util::index_t nnz = val.size();
+
+    auto val_obj = obj_factory.create_array(types::double_{}, {nnz});
+    auto col_obj = obj_factory.create_array(types::integer{}, {nnz});
+    auto x_obj = obj_factory.create_array(types::double_{}, {N});
+    auto y_obj = obj_factory.create_array(types::double_{}, {N});
+
+    {
+        auto val_view = get_view<array<double, 1>>(val_obj, writable, arch::host).get();
+        auto col_view = get_view<array<util::index_t, 1>>(col_obj, writable, arch::host).get();
+
+        for (util::index_t i = 0; i < nnz; ++i)
+        {
+            val_view(i) = val[i];
+            col_view(i) = col[i];
+        }
+
+        auto x_view = get_view<array<double, 1>>(x_obj, writable, arch::host).get();
+        auto y_view = get_view<array<double, 1>>(y_obj, writable, arch::host).get();
+
+        for (util::index_t i = 0; i < N; ++i)
+        {
+            x_view(i) = x[i];
+            y_view(i) = 0.0;
+        }
+    }
+
+    auto code = read_code("samples/ellpack_spmv");
+
+    code.replace(code.find("ellpack"), 7, module_name);
+
+    auto mod = parse_qir(std::move(code));
+
+    if (!narrow_indices)
+    {
+        mod->set_pragma(narrow_indices_pragma, "false");
+    }
+
+    runtime.get_module_library().add(std::move(mod)).get();
+
+    kernel_arguments args;
+
+    args.push_back_arg(val_obj);
+    args.push_back_arg(col_obj);
+    args.push_back_arg(x_obj);
+    args.push_back_result(y_obj);
+
+    runtime.execute(symbol_id(module_name + ".spmv"), args).get();
+
+    std::vector<double> y(N);
+
+    {
+        auto y_view = get_view<array<double, 1>>(y_obj, immutable, arch::host).get();
+
+        for (util::index_t i = 0; i < N; ++i)
+        {
+            y[i] = y_view(i);
+        }
+    }
+
+    return y;
+}
+}
+
+TEST(index_narrowing, bounded_loops_are_narrowed)
+{
+    using namespace qubus;
+
+    module mod(symbol_id("test"));
+
+    variable_declaration i("i", types::integer{});
+    variable_declaration j("j", types::integer{});
+    variable_declaration N("N", types::integer{});
+
+    variable_declaration A("A", types::array(types::double_{}, 1));
+    variable_declaration B("B", types::array(types::double_{}, 1));
+
+    auto bounded_loop =
+        for_(i, integer_literal(0), integer_literal(1000),
+             assign(subscription(variable_ref(A), variable_ref(i)), double_literal(1)));
+    const auto& bounded_loop_ref = *bounded_loop;
+
+    auto unbounded_loop =
+        for_(j, integer_literal(0), variable_ref(N),
+             assign(subscription(variable_ref(B), variable_ref(j)), double_literal(1)));
+    const auto& unbounded_loop_ref = *unbounded_loop;
+
+    auto body = sequenced_tasks(std::move(bounded_loop), std::move(unbounded_loop));
+
+    variable_declaration result("r", types::double_{});
+
+    mod.add_function("foo", {A, B, N}, std::move(result), std::move(body));
+
+    annotate_narrow_indices(mod.lookup_function("foo"));
+
+    EXPECT_TRUE(is_annotated(bounded_loop_ref, narrow_induction_variable_annotation));
+    EXPECT_FALSE(is_annotated(unbounded_loop_ref, narrow_induction_variable_annotation));
+}
+
+TEST(index_narrowing, gathered_indices_are_narrowed)
+{
+    using namespace qubus;
+
+    auto mod = parse_qir(read_code("samples/ellpack_spmv"));
+
+    const auto& spmv = mod->lookup_function("spmv");
+
+    annotate_narrow_indices(spmv);
+
+    std::vector<std::string> narrowed_arrays;
+
+    pattern::variable<const expression&> e;
+
+    auto m = pattern::make_matcher<expression, void>().case_(e, [&] {
+        if (auto subscription = e.get().try_as<subscription_expr>())
+        {
+            if (is_annotated(subscription->child(1), narrow_index_annotation))
+            {
+                const auto& array = subscription->indexed_expr().as<variable_ref_expr>();
+
+                narrowed_arrays.push_back(array.declaration().name());
+            }
+        }
+    });
+
+    pattern::for_each(spmv.body(), m);
+
+    // Only the column index used to gather from x is loaded from memory. The indices into
+    // val and col are affine and keep their 64-bit width.
+    EXPECT_EQ(narrowed_arrays, std::vector<std::string>({"x"}));
+}
+
+TEST(index_narrowing, narrowed_gathers_compute_the_same_result)
+{
+    using namespace qubus;
+
+    constexpr util::index_t N = 1001;
+    constexpr util::index_t W = 7;
+
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<util::index_t> column_dist(0, N - 1);
+    std::uniform_real_distribution<double> value_dist(-1.0, 1.0);
+
+    std::vector<double> val(N * W);
+    std::vector<util::index_t> col(N * W);
+    std::vector<double> x(N);
+
+    for (util::index_t i = 0; i < N * W; ++i)
+    {
+        val[i] = value_dist(engine);
+        col[i] = column_dist(engine);
+    }
+
+    for (util::index_t i = 0; i < N; ++i)
+    {
+        x[i] = value_dist(engine);
+    }
+
+    std::vector<double> expected_y(N, 0.0);
+
+    for (util::index_t j = 0; j < W; ++j)
+    {
+        for (util::index_t i = 0; i < N; ++i)
+        {
+            expected_y[i] += val[j * N + i] * x[col[j * N + i]];
+        }
+    }
+
+    auto narrow_y = execute_ellpack_spmv("ellpack_narrow", true, val, col, x);
+    auto wide_y = execute_ellpack_spmv("ellpack_wide", false, val, col, x);
+
+    for (util::index_t i = 0; i < N; ++i)
+    {
+        EXPECT_NEAR(narrow_y[i], expected_y[i], 1e-12);
+        EXPECT_NEAR(wide_y[i], expected_y[i], 1e-12);
+    }
+}
+
+int hpx_main(int argc, char** argv)
+{
+    qubus::init(argc, argv);
+
+    auto result = RUN_ALL_TESTS();
+
+    qubus::finalize();
+
+    hpx::finalize();
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+
+    hpx::resource::partitioner rp(argc, argv, qubus::get_hpx_config(),
+                                  hpx::resource::partitioner_mode::mode_allow_oversubscription);
+
+    qubus::setup(rp);
+
+    return hpx::init();
+}
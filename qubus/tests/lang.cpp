@@ -1,12 +1,14 @@
 #include <qubus/qubus.hpp>
 
 #include <qubus/IR/parsing.hpp>
+#include <qubus/loop_optimizer.hpp>
 
 #include <hpx/hpx_init.hpp>
 
 #include <gtest/gtest.h>
 
 #include <fstream>
+#include <vector>
 
 std::string read_code(const std::string& filepath)
 {
@@ -63,6 +65,149 @@ TEST(lang, extent)
     }
 }
 
+TEST(lang, loop_optimized_loops_with_nonzero_lower_bounds)
+{
+    using namespace qubus;
+
+    constexpr long int N = 37;
+    constexpr long int M = 29;
+
+    auto runtime = qubus::get_runtime();
+
+    auto obj_factory = runtime.get_object_factory();
+
+    auto x = obj_factory.create_array(qubus::types::double_{}, {N, M});
+    auto y = obj_factory.create_array(qubus::types::double_{}, {N, M});
+
+    std::vector<double> x2(N * M);
+
+    {
+        auto x_view = qubus::get_view<qubus::array<double, 2>>(x, qubus::writable, qubus::arch::host).get();
+        auto y_view = qubus::get_view<qubus::array<double, 2>>(y, qubus::writable, qubus::arch::host).get();
+
+        for (long int i = 0; i < N; ++i)
+        {
+            for (long int j = 0; j < M; ++j)
+            {
+                x2[i * M + j] = i * M + j;
+                x_view(i, j) = x2[i * M + j];
+                y_view(i, j) = -1.0;
+            }
+        }
+    }
+
+    auto mod = qubus::parse_qir(read_code("samples/shifted_loops"));
+
+    mod->set_pragma(optimize_loops_pragma, "true");
+
+    runtime.get_module_library().add(std::move(mod)).get();
+
+    qubus::kernel_arguments args;
+
+    args.push_back_arg(x);
+    args.push_back_result(y);
+
+    runtime.execute(qubus::symbol_id("shifted_loops.smooth"), args).get();
+
+    {
+        auto y_view = qubus::get_view<qubus::array<double, 2>>(y, qubus::immutable, qubus::arch::host).get();
+
+        for (long int i = 0; i < N; ++i)
+        {
+            for (long int j = 0; j < M; ++j)
+            {
+                // Elements outside of the iteration domain have to remain untouched.
+                double expected = -1.0;
+
+                if (1 <= i && i < N - 1 && 2 <= j)
+                {
+                    expected =
+                        x2[(i - 1) * M + j] + 2.0 * x2[(i + 1) * M + j] - x2[i * M + j - 2];
+                }
+
+                ASSERT_EQ(y_view(i, j), expected) << "at (" << i << ", " << j << ")";
+            }
+        }
+    }
+}
+
+TEST(lang, loop_optimized_heat_equation)
+{
+    using namespace qubus;
+
+    constexpr long int T = 50;
+    constexpr long int N = 73;
+    constexpr double alpha_value = 0.1;
+
+    auto runtime = qubus::get_runtime();
+
+    auto obj_factory = runtime.get_object_factory();
+
+    auto alpha = obj_factory.create_scalar(qubus::types::double_{});
+    auto u = obj_factory.create_array(qubus::types::double_{}, {T, N});
+
+    std::vector<double> u2(T * N);
+
+    for (long int t = 0; t < T; ++t)
+    {
+        for (long int i = 0; i < N; ++i)
+        {
+            u2[t * N + i] = ((t * N + i) % 13) * 0.25;
+        }
+    }
+
+    {
+        qubus::get_view<qubus::scalar<double>>(alpha, qubus::writable, qubus::arch::host)
+            .get()
+            .get() = alpha_value;
+
+        auto u_view = qubus::get_view<qubus::array<double, 2>>(u, qubus::writable, qubus::arch::host).get();
+
+        for (long int t = 0; t < T; ++t)
+        {
+            for (long int i = 0; i < N; ++i)
+            {
+                u_view(t, i) = u2[t * N + i];
+            }
+        }
+    }
+
+    auto mod = qubus::parse_qir(read_code("samples/heat_equation"));
+
+    mod->set_pragma(optimize_loops_pragma, "true");
+
+    runtime.get_module_library().add(std::move(mod)).get();
+
+    qubus::kernel_arguments args;
+
+    args.push_back_arg(alpha);
+    args.push_back_result(u);
+
+    runtime.execute(qubus::symbol_id("test.heat"), args).get();
+
+    for (long int t = 0; t < T - 1; ++t)
+    {
+        for (long int i = 1; i < N - 1; ++i)
+        {
+            u2[(t + 1) * N + i] =
+                u2[t * N + i] +
+                alpha_value * (u2[t * N + i - 1] - 2.0 * u2[t * N + i] + u2[t * N + i + 1]);
+        }
+    }
+
+    {
+        auto u_view = qubus::get_view<qubus::array<double, 2>>(u, qubus::immutable, qubus::arch::host).get();
+
+        for (long int t = 0; t < T; ++t)
+        {
+            for (long int i = 0; i < N; ++i)
+            {
+                ASSERT_NEAR(u_view(t, i), u2[t * N + i], 1e-12) << "at (" << t << ", " << i << ")";
+            }
+        }
+    }
+}
+
 int hpx_main(int argc, char** argv)
 {
     qubus::init(argc, argv);
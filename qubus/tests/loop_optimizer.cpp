@@ -0,0 +1,432 @@
+#include <qubus/qubus.hpp>
+
+#include <qubus/loop_optimizer.hpp>
+
+#include <qubus/IR/parsing.hpp>
+#include <qubus/IR/qir.hpp>
+#include <qubus/pattern/core.hpp>
+
+#include <hpx/hpx_init.hpp>
+#include <hpx/include/async.hpp>
+#include <hpx/include/lcos.hpp>
+#include <hpx/include/threads.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+std::string read_code(const std::string& filepath)
+{
+    std::ifstream fin(filepath);
+
+    auto first = std::istreambuf_iterator<char>(fin);
+    auto last = std::istreambuf_iterator<char>();
+
+    std::string code(first, last);
+
+    return code;
+}
+
+long int count_loops(const qubus::expression& expr, qubus::execution_order order)
+{
+    using namespace qubus;
+
+    pattern::variable<const expression&> e;
+
+    long int number_of_loops = 0;
+
+    auto m = pattern::make_matcher<expression, void>().case_(e, [&] {
+        if (auto loop = e.get().try_as<for_expr>())
+        {
+            if (loop->order() == order)
+            {
+                ++number_of_loops;
+            }
+        }
+    });
+
+    pattern::for_each(expr, m);
+
+    return number_of_loops;
+}
+
+/** \brief Returns the innermost loop enclosing an expression or nullptr if there is none.
+ */
+const qubus::for_expr* get_enclosing_loop(const qubus::expression& expr)
+{
+    for (auto parent = expr.parent(); parent; parent = parent->parent())
+    {
+        if (auto loop = parent->try_as<qubus::for_expr>())
+            return loop;
+    }
+
+    return nullptr;
+}
+
+/** \brief Counts the loops which are not nested inside of another loop.
+ */
+long int count_loop_nests(const qubus::expression& expr)
+{
+    using namespace qubus;
+
+    pattern::variable<const expression&> e;
+
+    long int number_of_loop_nests = 0;
+
+    auto m = pattern::make_matcher<expression, void>().case_(e, [&] {
+        if (e.get().try_as<for_expr>() && !get_enclosing_loop(e.get()))
+        {
+            ++number_of_loop_nests;
+        }
+    });
+
+    pattern::for_each(expr, m);
+
+    return number_of_loop_nests;
+}
+
+/** \brief Collects all assignments to array elements.
+ */
+std::vector<const qubus::expression*> get_array_assignments(const qubus::expression& expr)
+{
+    using namespace qubus;
+
+    pattern::variable<const expression&> e;
+
+    std::vector<const expression*> assignments;
+
+    auto m = pattern::make_matcher<expression, void>().case_(e, [&] {
+        if (auto op = e.get().try_as<binary_operator_expr>())
+        {
+            if ((op->tag() == binary_op_tag::assign || op->tag() == binary_op_tag::plus_assign) &&
+                op->left().try_as<subscription_expr>())
+            {
+                assignments.push_back(op);
+            }
+        }
+    });
+
+    pattern::for_each(expr, m);
+
+    return assignments;
+}
+
+/** \brief Executes the function scale_and_shift of the given module.
+ */
+std::vector<double> execute_scale_and_shift(std::unique_ptr<qubus::module> mod,
+                                            const std::vector<double>& A)
+{
+    using namespace qubus;
+
+    auto runtime = get_runtime();
+
+    auto obj_factory = runtime.get_object_factory();
+
+    util::index_t N = A.size();
+
+    auto A_obj = obj_factory.create_array(types::double_{}, {N});
+    auto C_obj = obj_factory.create_array(types::double_{}, {N});
+
+    {
+        auto A_view = get_view<array<double, 1>>(A_obj, writable, arch::host).get();
+
+        for (util::index_t i = 0; i < N; ++i)
+        {
+            A_view(i) = A[i];
+        }
+    }
+
+    symbol_id entry_point(mod->id().string() + ".scale_and_shift");
+
+    runtime.get_module_library().add(std::move(mod)).get();
+
+    kernel_arguments args;
+
+    args.push_back_arg(A_obj);
+    args.push_back_result(C_obj);
+
+    runtime.execute(entry_point, args).get();
+
+    std::vector<double> C(N);
+
+    {
+        auto C_view = get_view<array<double, 1>>(C_obj, immutable, arch::host).get();
+
+        for (util::index_t i = 0; i < N; ++i)
+        {
+            C[i] = C_view(i);
+        }
+    }
+
+    return C;
+}
+
+qubus::loop_optimizer_options get_test_options()
+{
+    qubus::loop_optimizer_options options;
+    options.cache_sizes = {32 * 1024, 256 * 1024};
+
+    return options;
+}
+
+TEST(loop_optimizer, parallel_loops_are_marked)
+{
+    using namespace qubus;
+
+    // The loop optimizer requires a large stack.
+    hpx::threads::executors::default_executor executor(hpx::threads::thread_stacksize_huge);
+
+    auto mod = parse_qir(read_code("samples/matrix_multiplication"));
+
+    std::vector<loop_optimization_report> reports;
+
+    auto optimized_mod =
+        hpx::async(executor, [&] { return optimize_loops(*mod, get_test_options(), reports); })
+            .get();
+
+    ASSERT_EQ(reports.size(), 1);
+    ASSERT_TRUE(reports[0].is_scop);
+    ASSERT_TRUE(reports[0].has_been_optimized);
+    EXPECT_EQ(reports[0].fallback, loop_optimization_fallback::none);
+
+    const auto& matmul = optimized_mod->lookup_function("matmul");
+
+    EXPECT_GT(count_loops(matmul.body(), execution_order::parallel), 0);
+}
+
+TEST(loop_optimizer, time_stepped_stencils_are_tiled)
+{
+    using namespace qubus;
+
+    hpx::threads::executors::default_executor executor(hpx::threads::thread_stacksize_huge);
+
+    auto mod = parse_qir(read_code("samples/heat_equation"));
+
+    std::vector<loop_optimization_report> reports;
+
+    auto optimized_mod =
+        hpx::async(executor, [&] { return optimize_loops(*mod, get_test_options(), reports); })
+            .get();
+
+    ASSERT_EQ(reports.size(), 1);
+    ASSERT_TRUE(reports[0].is_scop);
+    ASSERT_TRUE(reports[0].has_been_optimized);
+
+    const auto& heat = optimized_mod->lookup_function("heat");
+
+    // The tiles are executed in wavefronts.
+    EXPECT_GT(count_loops(heat.body(), execution_order::parallel), 0);
+}
+
+TEST(loop_optimizer, non_uniform_dependences_prevent_wavefronts)
+{
+    using namespace qubus;
+
+    hpx::threads::executors::default_executor executor(hpx::threads::thread_stacksize_huge);
+
+    auto mod = parse_qir(read_code("samples/non_uniform_recurrence"));
+
+    std::vector<loop_optimization_report> reports;
+
+    auto optimized_mod =
+        hpx::async(executor, [&] { return optimize_loops(*mod, get_test_options(), reports); })
+            .get();
+
+    ASSERT_EQ(reports.size(), 1);
+    ASSERT_TRUE(reports[0].is_scop);
+    ASSERT_TRUE(reports[0].has_been_optimized);
+
+    const auto& recurrence = optimized_mod->lookup_function("recurrence");
+
+    // Every element depends on an element of the previous row at a varying distance. Hence,
+    // the band does not follow a stencil pattern and its tiles are executed sequentially.
+    EXPECT_EQ(count_loops(recurrence.body(), execution_order::parallel), 0);
+}
+
+TEST(loop_optimizer, contractions_use_a_micro_kernel)
+{
+    using namespace qubus;
+
+    hpx::threads::executors::default_executor executor(hpx::threads::thread_stacksize_huge);
+
+    auto mod = parse_qir(read_code("samples/matrix_multiplication"));
+
+    auto options = get_test_options();
+    options.vector_register_size = 32;
+    options.number_of_vector_registers = 16;
+
+    std::vector<loop_optimization_report> reports;
+
+    hpx::async(executor, [&] { return optimize_loops(*mod, options, reports); }).get();
+
+    ASSERT_EQ(reports.size(), 1);
+    ASSERT_TRUE(reports[0].has_been_optimized);
+
+    auto micro_kernel_shape = reports[0].micro_kernel_shape;
+
+    std::sort(micro_kernel_shape.begin(), micro_kernel_shape.end());
+
+    EXPECT_EQ(micro_kernel_shape, std::vector<util::index_t>({1, 6, 8}));
+}
+
+TEST(loop_optimizer, consecutive_loops_form_a_single_scop)
+{
+    using namespace qubus;
+
+    hpx::threads::executors::default_executor executor(hpx::threads::thread_stacksize_huge);
+
+    auto code = read_code("samples/consecutive_loops");
+
+    auto mod = parse_qir(code);
+
+    std::vector<loop_optimization_report> reports;
+
+    auto optimized_mod =
+        hpx::async(executor, [&] { return optimize_loops(*mod, get_test_options(), reports); })
+            .get();
+
+    ASSERT_EQ(reports.size(), 1);
+    ASSERT_TRUE(reports[0].is_scop);
+    EXPECT_EQ(reports[0].number_of_scops, 1);
+    EXPECT_TRUE(reports[0].has_been_optimized);
+
+    const auto& scale_and_shift = optimized_mod->lookup_function("scale_and_shift");
+
+    EXPECT_TRUE(scale_and_shift.body().child(0).try_as<local_variable_def_expr>());
+
+    // Both statements have been fused into a single loop nest.
+    EXPECT_EQ(count_loop_nests(scale_and_shift.body()), 1);
+
+    auto assignments = get_array_assignments(scale_and_shift.body());
+
+    ASSERT_EQ(assignments.size(), 2u);
+    ASSERT_NE(get_enclosing_loop(*assignments[0]), nullptr);
+    EXPECT_EQ(get_enclosing_loop(*assignments[0]), get_enclosing_loop(*assignments[1]));
+
+    // The fused loop computes the same result as the original code.
+    code.replace(code.find("test"), 4, "consecutive_loops_reference");
+
+    auto reference_mod = parse_qir(code);
+
+    code.replace(code.find("consecutive_loops_reference"), 27, "consecutive_loops_optimized");
+
+    mod = parse_qir(code);
+
+    std::vector<loop_optimization_report> optimized_reports;
+
+    optimized_mod = hpx::async(executor, [&] {
+                        return optimize_loops(*mod, get_test_options(), optimized_reports);
+                    }).get();
+
+    std::vector<double> A(1001);
+
+    for (std::size_t i = 0; i < A.size(); ++i)
+    {
+        A[i] = 0.5 * i - 100.0;
+    }
+
+    auto expected_C = execute_scale_and_shift(std::move(reference_mod), A);
+    auto C = execute_scale_and_shift(std::move(optimized_mod), A);
+
+    ASSERT_EQ(C.size(), expected_C.size());
+
+    for (std::size_t i = 0; i < C.size(); ++i)
+    {
+        EXPECT_DOUBLE_EQ(C[i], expected_C[i]);
+    }
+}
+
+TEST(loop_optimizer, exceeded_budget_falls_back_to_original_code)
+{
+    using namespace qubus;
+
+    hpx::threads::executors::default_executor executor(hpx::threads::thread_stacksize_huge);
+
+    auto mod = parse_qir(read_code("samples/matrix_multiplication"));
+
+    auto options = get_test_options();
+    options.max_isl_operations = 1;
+
+    std::vector<loop_optimization_report> reports;
+
+    auto optimized_mod =
+        hpx::async(executor, [&] { return optimize_loops(*mod, options, reports); }).get();
+
+    ASSERT_EQ(reports.size(), 1);
+    ASSERT_TRUE(reports[0].is_scop);
+    EXPECT_FALSE(reports[0].has_been_optimized);
+    EXPECT_EQ(reports[0].fallback, loop_optimization_fallback::original_code);
+
+    const auto& matmul = optimized_mod->lookup_function("matmul");
+
+    EXPECT_EQ(count_loops(matmul.body(), execution_order::parallel), 0);
+}
+
+TEST(loop_optimizer, concurrent_optimization)
+{
+    using namespace qubus;
+
+    constexpr long int number_of_modules = 32;
+
+    hpx::threads::executors::default_executor executor(hpx::threads::thread_stacksize_huge);
+
+    auto code = read_code("samples/matrix_multiplication");
+
+    std::vector<std::unique_ptr<module>> modules;
+
+    for (long int i = 0; i < number_of_modules; ++i)
+    {
+        modules.push_back(parse_qir(code));
+    }
+
+    std::vector<hpx::future<std::vector<loop_optimization_report>>> optimizations;
+
+    for (const auto& mod : modules)
+    {
+        optimizations.push_back(hpx::async(executor, [&mod] {
+            std::vector<loop_optimization_report> reports;
+
+            optimize_loops(*mod, get_test_options(), reports);
+
+            return reports;
+        }));
+    }
+
+    for (auto& optimization : optimizations)
+    {
+        auto reports = optimization.get();
+
+        ASSERT_EQ(reports.size(), 1);
+        EXPECT_TRUE(reports[0].has_been_optimized);
+    }
+}
+
+int hpx_main(int argc, char** argv)
+{
+    qubus::init(argc, argv);
+
+    auto result = RUN_ALL_TESTS();
+
+    qubus::finalize();
+
+    hpx::finalize();
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+
+    hpx::resource::partitioner rp(argc, argv, qubus::get_hpx_config(),
+                                  hpx::resource::partitioner_mode::mode_allow_oversubscription);
+
+    qubus::setup(rp);
+
+    return hpx::init();
+}
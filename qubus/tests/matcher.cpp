@@ -0,0 +1,78 @@
+#include <qubus/IR/qir.hpp>
+#include <qubus/pattern/core.hpp>
+#include <qubus/pattern/IR.hpp>
+
+#include <gtest/gtest.h>
+
+TEST(matcher, first_applicable_case_is_chosen)
+{
+    using namespace qubus;
+
+    auto m = pattern::make_matcher<expression, int>()
+                 .case_(pattern::integer_literal(pattern::value(1)), [] { return 1; })
+                 .case_(pattern::binary_operator(pattern::value(binary_op_tag::plus),
+                                                 pattern::_, pattern::_),
+                        [] { return 2; })
+                 .case_(pattern::_, [] { return 3; })
+                 .case_(pattern::integer_literal(pattern::_), [] { return 4; })
+                 .case_(pattern::binary_operator(pattern::_, pattern::_), [] { return 5; });
+
+    EXPECT_EQ(m.match(*integer_literal(1)), 1);
+    EXPECT_EQ(m.match(*integer_literal(2)), 3);
+    EXPECT_EQ(m.match(*(integer_literal(1) + integer_literal(2))), 2);
+    EXPECT_EQ(m.match(*(integer_literal(1) * integer_literal(2))), 3);
+    EXPECT_EQ(m.match(*double_literal(1.0)), 3);
+}
+
+TEST(matcher, cases_are_selected_by_operator)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+
+    auto m = pattern::make_matcher<expression, int>()
+                 .case_(pattern::binary_operator(pattern::value(binary_op_tag::multiplies),
+                                                 pattern::_, pattern::_),
+                        [] { return 1; })
+                 .case_(pattern::binary_operator(pattern::_, pattern::integer_literal(pattern::_),
+                                                 pattern::_),
+                        [] { return 2; })
+                 .case_(pattern::binary_operator(pattern::value(binary_op_tag::plus),
+                                                 pattern::_, pattern::_),
+                        [] { return 3; })
+                 .case_(pattern::integer_literal(pattern::_) ||
+                            pattern::unary_operator(pattern::value(unary_op_tag::negate),
+                                                    pattern::_),
+                        [] { return 4; });
+
+    EXPECT_EQ(m.match(*(variable_ref(i) * integer_literal(2))), 1);
+    EXPECT_EQ(m.match(*(integer_literal(1) + variable_ref(i))), 2);
+    EXPECT_EQ(m.match(*(variable_ref(i) + integer_literal(2))), 3);
+    EXPECT_EQ(m.match(*integer_literal(42)), 4);
+    EXPECT_EQ(m.match(*unary_operator(unary_op_tag::negate, variable_ref(i))), 4);
+
+    EXPECT_FALSE(m.try_match(*(variable_ref(i) - integer_literal(2))));
+    EXPECT_FALSE(m.try_match(*unary_operator(unary_op_tag::plus, variable_ref(i))));
+    EXPECT_FALSE(m.try_match(*variable_ref(i)));
+}
+
+TEST(matcher, variables_are_bound_by_the_selected_case)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+
+    pattern::variable<util::index_t> value;
+
+    auto m = pattern::make_matcher<expression, util::index_t>()
+                 .case_(pattern::binary_operator(pattern::value(binary_op_tag::plus),
+                                                 pattern::integer_literal(value), pattern::_),
+                        [&] { return value.get(); })
+                 .case_(pattern::binary_operator(pattern::_, pattern::_,
+                                                 pattern::integer_literal(value)),
+                        [&] { return -value.get(); });
+
+    EXPECT_EQ(m.match(*(integer_literal(2) + variable_ref(i))), 2);
+    EXPECT_EQ(m.match(*(variable_ref(i) + integer_literal(3))), -3);
+    EXPECT_EQ(m.match(*(variable_ref(i) * integer_literal(4))), -4);
+}
@@ -1,11 +1,15 @@
+#include <qubus/IR/binary_format.hpp>
 #include <qubus/IR/parsing.hpp>
 #include <qubus/IR/module.hpp>
+#include <qubus/IR/qir.hpp>
 
 #include <hpx/include/serialization.hpp>
 #include <hpx/hpx_init.hpp>
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <sstream>
 #include <string>
 #include <fstream>
 #include <streambuf>
@@ -59,6 +63,161 @@ TEST(module, serialization)
     }
 }
 
+TEST(module, pragmas_survive_serialization)
+{
+    std::vector<char> buffer;
+
+    {
+        hpx::serialization::output_archive oar(buffer);
+
+        auto mod = qubus::parse_qir(read_code("samples/empty_function"));
+
+        mod->set_pragma("qubus.optimize_loops", "true");
+
+        oar << mod;
+    }
+
+    {
+        hpx::serialization::input_archive iar(buffer);
+
+        std::unique_ptr<qubus::module> mod;
+
+        iar >> mod;
+
+        auto value = mod->lookup_pragma("qubus.optimize_loops");
+
+        ASSERT_TRUE(static_cast<bool>(value));
+        EXPECT_EQ(*value, "true");
+        EXPECT_FALSE(static_cast<bool>(mod->lookup_pragma("qubus.unknown")));
+    }
+}
+
+std::string dump_module(const qubus::module& mod)
+{
+    std::stringstream out;
+
+    mod.dump(out);
+
+    return out.str();
+}
+
+TEST(module, binary_format_round_trip)
+{
+    auto mod = qubus::parse_qir(read_code("samples/heat_equation"));
+
+    mod->set_pragma("qubus.optimize_loops", "true");
+
+    auto buffer = qubus::encode_binary_qir(*mod);
+
+    auto decoded_mod = qubus::decode_binary_qir(buffer);
+
+    EXPECT_EQ(decoded_mod->id(), mod->id());
+    EXPECT_EQ(dump_module(*decoded_mod), dump_module(*mod));
+
+    auto value = decoded_mod->lookup_pragma("qubus.optimize_loops");
+
+    ASSERT_TRUE(static_cast<bool>(value));
+    EXPECT_EQ(*value, "true");
+}
+
+TEST(module, binary_format_load_from_file)
+{
+    auto mod = qubus::parse_qir(read_code("samples/matrix_multiplication"));
+
+    qubus::save_binary_qir(*mod, "matrix_multiplication.qirb");
+
+    auto loaded_mod = qubus::load_binary_qir("matrix_multiplication.qirb");
+
+    EXPECT_EQ(dump_module(*loaded_mod), dump_module(*mod));
+}
+
+TEST(module, binary_format_rejects_invalid_data)
+{
+    auto mod = qubus::parse_qir(read_code("samples/empty_function"));
+
+    auto buffer = qubus::encode_binary_qir(*mod);
+
+    auto truncated_buffer = std::vector<char>(buffer.begin(), buffer.end() - 1);
+
+    EXPECT_THROW(qubus::decode_binary_qir(truncated_buffer), qubus::binary_format_error);
+
+    // The version directly follows the four byte header.
+    auto future_buffer = buffer;
+    future_buffer[4] = static_cast<char>(qubus::binary_qir_version + 1);
+
+    EXPECT_THROW(qubus::decode_binary_qir(future_buffer), qubus::binary_format_error);
+}
+
+namespace
+{
+std::vector<char> encode_function(std::unique_ptr<qubus::expression> body,
+                                  const qubus::variable_declaration& param,
+                                  const qubus::variable_declaration& result)
+{
+    qubus::module mod(qubus::symbol_id("enumerators"));
+
+    mod.add_function("f", {param}, result, std::move(body));
+
+    return qubus::encode_binary_qir(mod);
+}
+
+/** \brief Replaces the only byte in which the encodings differ by an out-of-range enumerator.
+ */
+std::vector<char> corrupt_enumerator(std::vector<char> buffer, const std::vector<char>& other)
+{
+    EXPECT_EQ(buffer.size(), other.size());
+
+    auto mismatch = std::mismatch(buffer.begin(), buffer.end(), other.begin());
+
+    EXPECT_NE(mismatch.first, buffer.end());
+
+    *mismatch.first = 0x7F;
+
+    return buffer;
+}
+}
+
+TEST(module, binary_format_rejects_invalid_enumerators)
+{
+    using namespace qubus;
+
+    variable_declaration a("a", types::double_{});
+    variable_declaration b("b", types::double_{});
+    variable_declaration i("i", types::integer{});
+
+    auto plus_buffer = encode_function(assign(var(a), var(b) + var(b)), b, a);
+    auto minus_buffer = encode_function(assign(var(a), var(b) - var(b)), b, a);
+
+    EXPECT_THROW(decode_binary_qir(corrupt_enumerator(plus_buffer, minus_buffer)),
+                 binary_format_error);
+
+    auto negate_buffer = encode_function(assign(var(a), -var(b)), b, a);
+    auto unary_plus_buffer =
+        encode_function(assign(var(a), unary_operator(unary_op_tag::plus, var(b))), b, a);
+
+    EXPECT_THROW(decode_binary_qir(corrupt_enumerator(negate_buffer, unary_plus_buffer)),
+                 binary_format_error);
+
+    auto make_loop = [&](execution_order order) {
+        return std::make_unique<for_expr>(order, i, integer_literal(0), integer_literal(10),
+                                          integer_literal(1), assign(var(a), var(b)));
+    };
+
+    auto sequential_buffer = encode_function(make_loop(execution_order::sequential), b, a);
+    auto parallel_buffer = encode_function(make_loop(execution_order::parallel), b, a);
+
+    EXPECT_THROW(decode_binary_qir(corrupt_enumerator(sequential_buffer, parallel_buffer)),
+                 binary_format_error);
+}
+
+TEST(module, saving_binary_qir_reports_io_errors)
+{
+    auto mod = qubus::parse_qir(read_code("samples/empty_function"));
+
+    EXPECT_THROW(qubus::save_binary_qir(*mod, "missing_directory/empty_function.qirb"),
+                 qubus::binary_qir_io_error);
+}
+
 int hpx_main(int argc, char** argv)
 {
     auto result = RUN_ALL_TESTS();
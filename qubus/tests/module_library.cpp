@@ -0,0 +1,71 @@
+#include <qubus/qubus.hpp>
+
+#include <qubus/IR/qir.hpp>
+#include <qubus/module_library.hpp>
+
+#include <hpx/hpx_init.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+namespace
+{
+std::unique_ptr<qubus::module> make_copy_module(qubus::util::index_t extent)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+    variable_declaration A("A", types::array(types::double_{}, 1));
+    variable_declaration B("B", types::array(types::double_{}, 1));
+
+    auto body = for_(i, integer_literal(0), integer_literal(extent),
+                     assign(subscription(variable_ref(A), variable_ref(i)),
+                            subscription(variable_ref(B), variable_ref(i))));
+
+    auto mod = std::make_unique<module>(symbol_id("content_addressed"));
+
+    mod->add_function("entry", {B}, A, std::move(body));
+
+    return mod;
+}
+}
+
+TEST(module_library, equivalent_modules_share_their_id)
+{
+    auto library = qubus::get_runtime().get_module_library();
+
+    library.add_if_absent(make_copy_module(10)).get();
+
+    EXPECT_NO_THROW(library.add_if_absent(make_copy_module(10)).get());
+
+    EXPECT_THROW(library.add_if_absent(make_copy_module(11)).get(),
+                 qubus::conflicting_module_error);
+
+    EXPECT_THROW(library.add(make_copy_module(10)).get(), qubus::duplicate_module_error);
+}
+
+int hpx_main(int argc, char** argv)
+{
+    qubus::init(argc, argv);
+
+    auto result = RUN_ALL_TESTS();
+
+    qubus::finalize();
+
+    hpx::finalize();
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+
+    hpx::resource::partitioner rp(argc, argv, qubus::get_hpx_config(),
+                                  hpx::resource::partitioner_mode::mode_allow_oversubscription);
+
+    qubus::setup(rp);
+
+    return hpx::init();
+}
@@ -1,11 +1,14 @@
 #include <qubus/IR/parsing.hpp>
 #include <qubus/IR/module.hpp>
+#include <qubus/IR/qir.hpp>
 
 #include <gtest/gtest.h>
 
+#include <sstream>
 #include <string>
 #include <iostream>
 #include <streambuf>
+#include <vector>
 
 std::string read_code(const std::string& filepath)
 {
@@ -119,6 +122,96 @@ TEST(parsing, slicing)
     qubus::parse_qir(code);
 }
 
+TEST(parsing, deeply_nested_expression)
+{
+    const int depth = 200;
+
+    std::string code = "module test\n\nfunction calc(x :: Double) -> r :: Double\n    r = ";
+
+    for (int i = 0; i < depth; ++i)
+    {
+        code += "(";
+    }
+
+    code += "x";
+
+    for (int i = 0; i < depth; ++i)
+    {
+        code += " + 1.0)";
+    }
+
+    code += "\nend\n";
+
+    qubus::parse_qir(code);
+}
+
+TEST(parsing, operator_precedence_and_associativity)
+{
+    using namespace qubus;
+
+    auto code = std::string("module test\n\n"
+                            "function calc(x :: Double) -> r :: Double\n"
+                            "    r = x - 2.0 - 1.0 * x\n"
+                            "end\n");
+
+    auto mod = parse_qir(code);
+
+    const auto& body = mod->lookup_function("calc").body();
+
+    const auto& assignment = body.child(0).as<binary_operator_expr>();
+
+    // (x - 2.0) - (1.0 * x)
+    const auto& outer_minus = assignment.right().as<binary_operator_expr>();
+
+    ASSERT_EQ(outer_minus.tag(), binary_op_tag::minus);
+
+    const auto& inner_minus = outer_minus.left().as<binary_operator_expr>();
+    const auto& multiplication = outer_minus.right().as<binary_operator_expr>();
+
+    EXPECT_EQ(inner_minus.tag(), binary_op_tag::minus);
+    EXPECT_EQ(multiplication.tag(), binary_op_tag::multiplies);
+}
+
+TEST(parsing, printed_code_preserves_the_operator_structure)
+{
+    using namespace qubus;
+
+    auto code = std::string("module test\n\n"
+                            "function calc(x :: Double) -> r :: Double\n"
+                            "    r = x - (x - 2.0) - x / (x / 4.0) + (x - 1.0) * (x + 3.0)\n"
+                            "end\n");
+
+    auto mod = parse_qir(code);
+
+    std::stringstream printed_code;
+    mod->dump(printed_code);
+
+    auto reparsed_mod = parse_qir(printed_code.str());
+
+    const auto& func = mod->lookup_function("calc");
+    const auto& reparsed_func = reparsed_mod->lookup_function("calc");
+
+    std::vector<variable_declaration> free_variables = func.params();
+    free_variables.push_back(func.result());
+
+    std::vector<variable_declaration> reparsed_free_variables = reparsed_func.params();
+    reparsed_free_variables.push_back(reparsed_func.result());
+
+    EXPECT_TRUE(alpha_equivalent(func.body(), free_variables, reparsed_func.body(),
+                                 reparsed_free_variables))
+        << printed_code.str();
+}
+
+TEST(parsing, identifiers_starting_with_keywords)
+{
+    auto code = std::string("module test\n\n"
+                            "function calc(format :: Double, endpoint :: Double) -> r :: Bool\n"
+                            "    r = format <= endpoint\n"
+                            "end\n");
+
+    qubus::parse_qir(code);
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,351 @@
+#include <qubus/qubus.hpp>
+
+#include <qubus/IR/qir.hpp>
+#include <qubus/dependence_analysis.hpp>
+#include <qubus/pass_manager.hpp>
+
+#include <qubus/util/unused.hpp>
+
+#include <hpx/hpx_init.hpp>
+
+#include <gtest/gtest.h>
+
+namespace qubus
+{
+namespace
+{
+long int number_of_runs = 0;
+long int number_of_relocatable_runs = 0;
+}
+
+class counting_analysis_pass
+{
+public:
+    using result_type = long int;
+
+    long int run(const expression& QUBUS_UNUSED(root), analysis_manager& QUBUS_UNUSED(manager),
+                 pass_resource_manager& QUBUS_UNUSED(resource_manager)) const
+    {
+        return ++number_of_runs;
+    }
+
+    std::vector<analysis_id> required_analyses() const
+    {
+        return {};
+    }
+};
+
+QUBUS_REGISTER_ANALYSIS_PASS(counting_analysis_pass);
+
+struct counted_variables
+{
+    long int run;
+    std::vector<variable_declaration> variables;
+};
+
+class counting_relocatable_analysis_pass
+{
+public:
+    using result_type = counted_variables;
+
+    counted_variables run(const expression& root, analysis_manager& QUBUS_UNUSED(manager),
+                          pass_resource_manager& QUBUS_UNUSED(resource_manager)) const
+    {
+        return counted_variables{++number_of_relocatable_runs, canonical_variables(root)};
+    }
+
+    counted_variables relocate(const counted_variables& result,
+                               const expression_relocation& relocation,
+                               const expression& QUBUS_UNUSED(root),
+                               analysis_manager& QUBUS_UNUSED(manager),
+                               pass_resource_manager& QUBUS_UNUSED(resource_manager)) const
+    {
+        counted_variables relocated_result{result.run, {}};
+
+        for (const auto& var : result.variables)
+        {
+            relocated_result.variables.push_back(relocation.map(var));
+        }
+
+        return relocated_result;
+    }
+
+    std::vector<analysis_id> required_analyses() const
+    {
+        return {};
+    }
+};
+
+QUBUS_REGISTER_ANALYSIS_PASS(counting_relocatable_analysis_pass);
+
+namespace
+{
+/** \brief Builds a loop with a carried flow dependence, using fresh variables.
+ */
+std::unique_ptr<expression> make_recurrence(const variable_declaration& A)
+{
+    variable_declaration i("i", types::integer{});
+    variable_declaration N("N", types::integer{});
+
+    return for_(i, integer_literal(1), variable_ref(N),
+                assign(subscription(variable_ref(A), variable_ref(i)),
+                       subscription(variable_ref(A), variable_ref(i) - integer_literal(1))));
+}
+
+bool is_part_of(const expression& node, const expression& root)
+{
+    for (auto current = &node; current; current = current->parent())
+    {
+        if (current == &root)
+            return true;
+    }
+
+    return false;
+}
+}
+}
+
+TEST(pass_manager, results_are_cached_per_root)
+{
+    using namespace qubus;
+
+    variable_declaration a("a", types::double_{});
+    variable_declaration b("b", types::double_{});
+
+    auto root = sequenced_tasks(assign(variable_ref(a), lit(42)), assign(variable_ref(b), lit(1)));
+
+    pass_resource_manager resource_man;
+    analysis_manager analysis_man(resource_man);
+
+    auto root_result = analysis_man.get_analysis<counting_analysis_pass>(*root);
+    auto child_result = analysis_man.get_analysis<counting_analysis_pass>(root->child(0));
+
+    EXPECT_NE(root_result, child_result);
+    EXPECT_EQ(analysis_man.get_analysis<counting_analysis_pass>(*root), root_result);
+}
+
+TEST(pass_manager, disjoint_subtrees_are_not_invalidated)
+{
+    using namespace qubus;
+
+    variable_declaration a("a", types::double_{});
+    variable_declaration b("b", types::double_{});
+
+    auto root = sequenced_tasks(assign(variable_ref(a), lit(42)), assign(variable_ref(b), lit(1)));
+
+    pass_resource_manager resource_man;
+    analysis_manager analysis_man(resource_man);
+
+    analysis_man.get_analysis<counting_analysis_pass>(*root);
+    analysis_man.get_analysis<counting_analysis_pass>(root->child(0));
+    analysis_man.get_analysis<counting_analysis_pass>(root->child(1));
+
+    preserved_analyses_info preserved_analyses;
+    preserved_analyses.mark_modified(root->child(0));
+
+    analysis_man.invalidate(preserved_analyses);
+
+    EXPECT_FALSE(analysis_man.get_analysis_cached<counting_analysis_pass>(*root));
+    EXPECT_FALSE(analysis_man.get_analysis_cached<counting_analysis_pass>(root->child(0)));
+    EXPECT_TRUE(analysis_man.get_analysis_cached<counting_analysis_pass>(root->child(1)));
+}
+
+TEST(pass_manager, preserved_analyses_are_not_invalidated)
+{
+    using namespace qubus;
+
+    variable_declaration a("a", types::double_{});
+
+    auto root = assign(variable_ref(a), lit(42));
+
+    pass_resource_manager resource_man;
+    analysis_manager analysis_man(resource_man);
+
+    analysis_man.get_analysis<counting_analysis_pass>(*root);
+
+    preserved_analyses_info preserved_analyses;
+    preserved_analyses.preserve<counting_analysis_pass>();
+
+    analysis_man.invalidate(preserved_analyses);
+
+    EXPECT_TRUE(analysis_man.get_analysis_cached<counting_analysis_pass>(*root));
+
+    analysis_man.invalidate(preserved_analyses_info());
+
+    EXPECT_FALSE(analysis_man.get_analysis_cached<counting_analysis_pass>(*root));
+}
+
+TEST(pass_manager, alpha_equivalent_expressions_share_cached_results)
+{
+    using namespace qubus;
+
+    analysis_cache::get_instance().clear();
+
+    variable_declaration a("a", types::double_{});
+    variable_declaration b("b", types::double_{});
+
+    auto first_root = assign(variable_ref(a), lit(42));
+    auto second_root = assign(variable_ref(b), lit(42));
+    auto other_root = assign(variable_ref(a), lit(43));
+
+    pass_resource_manager resource_man;
+    analysis_manager first_analysis_man(resource_man);
+    analysis_manager second_analysis_man(resource_man);
+
+    auto runs_before = number_of_relocatable_runs;
+
+    const auto& first_result =
+        first_analysis_man.get_analysis<counting_relocatable_analysis_pass>(*first_root);
+    const auto& second_result =
+        second_analysis_man.get_analysis<counting_relocatable_analysis_pass>(*second_root);
+
+    EXPECT_EQ(first_result.run, second_result.run);
+    EXPECT_EQ(number_of_relocatable_runs, runs_before + 1);
+
+    EXPECT_EQ(first_result.variables, std::vector<variable_declaration>({a}));
+    EXPECT_EQ(second_result.variables, std::vector<variable_declaration>({b}));
+
+    const auto& other_result =
+        first_analysis_man.get_analysis<counting_relocatable_analysis_pass>(*other_root);
+
+    EXPECT_NE(other_result.run, first_result.run);
+    EXPECT_EQ(number_of_relocatable_runs, runs_before + 2);
+}
+
+TEST(pass_manager, dependences_are_shared_between_separately_built_kernels)
+{
+    using namespace qubus;
+
+    analysis_cache::get_instance().clear();
+
+    variable_declaration A("A", types::array(types::double_{}, 1));
+    variable_declaration B("B", types::array(types::double_{}, 1));
+
+    auto first_root = make_recurrence(A);
+    auto second_root = make_recurrence(B);
+
+    pass_resource_manager first_resource_man;
+    analysis_manager first_analysis_man(first_resource_man);
+
+    const auto& first_result =
+        first_analysis_man.get_analysis<dependence_analysis_pass>(*first_root);
+
+    ASSERT_TRUE(first_result.get_dependences(first_root->as<for_expr>()));
+
+    auto number_of_entries = analysis_cache::get_instance().size();
+
+    pass_resource_manager second_resource_man;
+    analysis_manager second_analysis_man(second_resource_man);
+
+    const auto& second_result =
+        second_analysis_man.get_analysis<dependence_analysis_pass>(*second_root);
+
+    // A miss would have added the dependences of the second kernel to the cache.
+    EXPECT_EQ(analysis_cache::get_instance().size(), number_of_entries);
+
+    const auto& second_loop = second_root->as<for_expr>();
+
+    auto dependences = second_result.get_dependences(second_loop);
+
+    ASSERT_TRUE(dependences);
+    ASSERT_EQ(dependences->dependences().size(), 1u);
+
+    const auto& dep = dependences->dependences().front();
+
+    EXPECT_EQ(dep.variable, B);
+    EXPECT_TRUE(is_part_of(dep.source, second_loop));
+    EXPECT_TRUE(is_part_of(dep.target, second_loop));
+    EXPECT_TRUE(dep.is_carried);
+    EXPECT_TRUE(second_result.carries_dependences(second_loop));
+}
+
+TEST(pass_manager, colliding_cache_entries_are_distinguished)
+{
+    using namespace qubus;
+
+    analysis_cache cache;
+
+    variable_declaration a("a", types::double_{});
+
+    auto root = assign(variable_ref(a), lit(42));
+    auto other_root = assign(variable_ref(a), lit(43));
+
+    const std::size_t colliding_hash = 0;
+
+    analysis_pass pass = counting_relocatable_analysis_pass();
+
+    auto id = pass.id();
+
+    cache.insert(pass, *root, colliding_hash, counted_variables{1, {}});
+
+    ASSERT_TRUE(cache.lookup(id, *root, colliding_hash));
+    EXPECT_EQ(cache.lookup(id, *root, colliding_hash)->result().as<counted_variables>().run, 1);
+
+    EXPECT_FALSE(cache.lookup(id, *other_root, colliding_hash));
+    EXPECT_FALSE(cache.lookup(get_analysis_id<counting_analysis_pass>(), *root, colliding_hash));
+
+    cache.insert(pass, *other_root, colliding_hash, counted_variables{2, {}});
+
+    EXPECT_EQ(cache.lookup(id, *root, colliding_hash)->result().as<counted_variables>().run, 1);
+    EXPECT_EQ(cache.lookup(id, *other_root, colliding_hash)->result().as<counted_variables>().run,
+              2);
+}
+
+TEST(pass_manager, least_recently_used_entry_is_evicted)
+{
+    using namespace qubus;
+
+    analysis_cache cache;
+
+    analysis_pass pass = counting_relocatable_analysis_pass();
+
+    auto id = pass.id();
+
+    const auto number_of_entries =
+        static_cast<util::index_t>(analysis_cache::max_number_of_entries);
+
+    for (util::index_t i = 0; i < number_of_entries; ++i)
+    {
+        cache.insert(pass, *lit(i), counted_variables{i, {}});
+    }
+
+    EXPECT_EQ(cache.size(), analysis_cache::max_number_of_entries);
+
+    // Touch the oldest entry such that the second oldest one is evicted instead.
+    ASSERT_TRUE(cache.lookup(id, *lit(0)));
+
+    auto newest = number_of_entries;
+
+    cache.insert(pass, *lit(newest), counted_variables{newest, {}});
+
+    EXPECT_EQ(cache.size(), analysis_cache::max_number_of_entries);
+    EXPECT_TRUE(cache.lookup(id, *lit(0)));
+    EXPECT_FALSE(cache.lookup(id, *lit(1)));
+    ASSERT_TRUE(cache.lookup(id, *lit(newest)));
+    EXPECT_EQ(cache.lookup(id, *lit(newest))->result().as<counted_variables>().run, newest);
+}
+
+int hpx_main(int argc, char** argv)
+{
+    qubus::init(argc, argv);
+
+    auto result = RUN_ALL_TESTS();
+
+    qubus::finalize();
+
+    hpx::finalize();
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+
+    hpx::resource::partitioner rp(argc, argv, qubus::get_hpx_config(),
+                                  hpx::resource::partitioner_mode::mode_allow_oversubscription);
+
+    qubus::setup(rp);
+
+    return hpx::init();
+}
@@ -0,0 +1,102 @@
+#include <qubus/qubus.hpp>
+
+#include <qubus/qtl/IR/all.hpp>
+
+#include <qubus/IR/qir.hpp>
+#include <qubus/pattern/substitute.hpp>
+
+#include <hpx/hpx_init.hpp>
+
+#include <gtest/gtest.h>
+
+TEST(qtl_substitute, consuming_substitution_rebuilds_qtl_expressions)
+{
+    using namespace qubus;
+    using namespace qtl;
+
+    variable_declaration i("i", types::index{});
+    variable_declaration j("j", types::index{});
+    variable_declaration B("B", types::array(types::double_{}, 1));
+    variable_declaration C("C", types::array(types::double_{}, 1));
+
+    auto unchanged = subscription(var(B), var(j));
+    const auto* unchanged_ptr = unchanged.get();
+
+    std::unique_ptr<expression> expr = for_all(
+        i, assign(subscription(var(C), var(i)),
+                  sum(j, kronecker_delta(10, var(i), var(j) + integer_literal(1)) *
+                             std::move(unchanged))));
+
+    auto m = pattern::make_matcher<expression, std::unique_ptr<expression>>().case_(
+        pattern::integer_literal(pattern::value(1)), [&] { return integer_literal(2); });
+
+    auto expected_result = pattern::substitute(*expr, m);
+
+    auto result = pattern::substitute(std::move(expr), m);
+
+    ASSERT_TRUE(result);
+    EXPECT_EQ(*result, *expected_result);
+
+    const auto& contraction = result->as<for_all_expr>().body().child(1).as<sum_expr>();
+    const auto& product = contraction.body();
+
+    EXPECT_EQ(&product.child(1), unchanged_ptr);
+    EXPECT_EQ(product.child(1).parent(), &product);
+
+    const auto& delta = product.child(0).as<kronecker_delta_expr>();
+
+    EXPECT_EQ(delta.extent(), 10);
+    EXPECT_EQ(delta.second_index(), *(var(j) + integer_literal(2)));
+}
+
+TEST(qtl_substitute, released_children_rebuild_an_equal_expression)
+{
+    using namespace qubus;
+    using namespace qtl;
+
+    variable_declaration i("i", types::index{});
+    variable_declaration j("j", types::index{});
+
+    std::vector<std::unique_ptr<expression>> exprs;
+    exprs.push_back(for_all(i, var(i) + integer_literal(1)));
+    exprs.push_back(sum(std::vector<variable_declaration>{i, j}, var(i) * var(j)));
+    exprs.push_back(kronecker_delta(4, var(i), var(j)));
+
+    for (auto& expr : exprs)
+    {
+        auto expected_result = clone(*expr);
+
+        auto children = expr->release_children();
+
+        EXPECT_EQ(children.size(), expected_result->arity());
+
+        auto result = expr->substitute_subexpressions(std::move(children));
+
+        EXPECT_EQ(*result, *expected_result);
+    }
+}
+
+int hpx_main(int argc, char** argv)
+{
+    qubus::init(argc, argv);
+
+    auto result = RUN_ALL_TESTS();
+
+    qubus::finalize();
+
+    hpx::finalize();
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+
+    hpx::resource::partitioner rp(argc, argv, qubus::get_hpx_config(),
+                                  hpx::resource::partitioner_mode::mode_allow_oversubscription);
+
+    qubus::setup(rp);
+
+    return hpx::init();
+}
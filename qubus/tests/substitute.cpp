@@ -0,0 +1,51 @@
+#include <qubus/IR/qir.hpp>
+#include <qubus/pattern/substitute.hpp>
+
+#include <gtest/gtest.h>
+
+TEST(substitute, consuming_substitution_reuses_unchanged_subexpressions)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+    variable_declaration A("A", types::array(types::double_{}, 1));
+    variable_declaration B("B", types::array(types::double_{}, 1));
+
+    auto unchanged = subscription(variable_ref(B), variable_ref(i));
+    const auto* unchanged_ptr = unchanged.get();
+
+    std::unique_ptr<expression> expr =
+        for_(i, integer_literal(0), integer_literal(10),
+             assign(subscription(variable_ref(A), variable_ref(i)), std::move(unchanged)));
+
+    auto m = pattern::make_matcher<expression, std::unique_ptr<expression>>().case_(
+        pattern::integer_literal(pattern::value(10)), [&] { return integer_literal(42); });
+
+    auto expected_result = pattern::substitute(*expr, m);
+
+    auto result = pattern::substitute(std::move(expr), m);
+
+    EXPECT_EQ(*result, *expected_result);
+
+    const auto& body = result->as<for_expr>().body();
+
+    EXPECT_EQ(&body.child(1), unchanged_ptr);
+    EXPECT_EQ(body.child(1).parent(), &body);
+}
+
+TEST(substitute, consuming_substitution_without_matches_returns_the_expression)
+{
+    using namespace qubus;
+
+    variable_declaration i("i", types::integer{});
+
+    std::unique_ptr<expression> expr = variable_ref(i) + integer_literal(1);
+    const auto* expr_ptr = expr.get();
+
+    auto m = pattern::make_matcher<expression, std::unique_ptr<expression>>().case_(
+        pattern::integer_literal(pattern::value(2)), [&] { return integer_literal(3); });
+
+    auto result = pattern::substitute(std::move(expr), m);
+
+    EXPECT_EQ(result.get(), expr_ptr);
+}
@@ -33,6 +33,20 @@ TEST(symbol_id, nested_symbol_construction)
     EXPECT_EQ(s.string(), "bar.foo");
 }
 
+TEST(symbol_id, interned_symbols)
+{
+    qubus::symbol_id s("baz.bar.foo");
+    qubus::symbol_id t(std::vector<std::string>{"baz", "bar", "foo"});
+
+    EXPECT_EQ(s, t);
+    EXPECT_EQ(std::hash<qubus::symbol_id>()(s), std::hash<qubus::symbol_id>()(t));
+    EXPECT_EQ(&s.string(), &t.string());
+
+    EXPECT_EQ(s.get_prefix(), qubus::symbol_id("baz.bar"));
+    EXPECT_EQ(s.get_prefix().get_prefix(), qubus::symbol_id("baz"));
+    EXPECT_NE(s, qubus::symbol_id("baz.bar.fo"));
+}
+
 TEST(symbol_id, parsing_error)
 {
     EXPECT_THROW(qubus::symbol_id s("bar:foo");, qubus::symbol_id_parsing_error);
@@ -0,0 +1,40 @@
+#include <qubus/IR/type.hpp>
+
+#include <gtest/gtest.h>
+
+#include <functional>
+
+TEST(type_interning, equal_types_share_their_representation)
+{
+    using namespace qubus;
+
+    type lhs = types::array(types::complex(types::double_{}), 2);
+    type rhs = types::array(types::complex(types::double_{}), 2);
+
+    EXPECT_EQ(lhs, rhs);
+    EXPECT_EQ(&lhs.as<types::array>(), &rhs.as<types::array>());
+    EXPECT_EQ(std::hash<type>()(lhs), std::hash<type>()(rhs));
+
+    EXPECT_NE(lhs, type(types::array(types::complex(types::float_{}), 2)));
+    EXPECT_NE(lhs, type(types::array(types::complex(types::double_{}), 1)));
+    EXPECT_NE(lhs, type(types::array_slice(types::complex(types::double_{}), 2)));
+}
+
+TEST(type_interning, struct_types_are_compared_by_their_members)
+{
+    using namespace qubus;
+
+    EXPECT_EQ(types::sparse_tensor(types::double_{}), types::sparse_tensor(types::double_{}));
+    EXPECT_NE(types::sparse_tensor(types::double_{}), types::sparse_tensor(types::float_{}));
+}
+
+TEST(type_interning, default_constructed_types_are_unknown)
+{
+    using namespace qubus;
+
+    type unknown_type;
+
+    EXPECT_TRUE(unknown_type.try_as<types::unknown>());
+    EXPECT_EQ(unknown_type, type());
+    EXPECT_NE(unknown_type, type(types::integer{}));
+}
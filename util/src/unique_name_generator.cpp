@@ -13,9 +13,26 @@ std::string unique_name_generator::get() const
 {
     std::string result = next_name_;
 
-    ++next_name_.back();
+    // Count in the sequence A, B, ..., Z, AA, AB, ... to ensure that all names are valid identifiers.
+    auto pos = next_name_.rbegin();
+
+    for (; pos != next_name_.rend(); ++pos)
+    {
+        if (*pos != 'Z')
+        {
+            ++*pos;
+            break;
+        }
+
+        *pos = 'A';
+    }
+
+    if (pos == next_name_.rend())
+    {
+        next_name_.insert(next_name_.begin(), 'A');
+    }
 
     return result;
 }
 }
-}
\ No newline at end of file
+}